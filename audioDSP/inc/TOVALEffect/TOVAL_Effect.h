@@ -1,29 +1,104 @@
 #ifndef TOVAL_EFFECT_H
 #define TOVAL_EFFECT_H
 
+#include "AudioBuffer.h"
 #include "TOVALaudio.h"
+#include "TOVALparams.h"
+
+// Memory an instance needs for TOVAL_Effect_init_in
+struct TOVAL_MemoryRequirements {
+    size_t size;
+    size_t alignment;
+};
+
+// config_data for set_config, get_config, query_memory and init_in. The channel counts are the chain's,
+// get_config reports them and set_config recomputes them whatever is passed in.
+struct TOVAL_Config {
+    float sample_rate = 48000.0f;
+    uint16_t In_num_channels = 0;
+    uint16_t Out_num_channels = 0;
+    float internal_sample_rate = 0.0f;      // 0 (or equal to sample_rate) runs the chain at the host rate
+    uint16_t src_quality = TOVAL_SrcQuality::SRC_QUALITY_MEDIUM;
+};
 
 class TOVAL_Effect {
 public:
     TOVAL_Effect();
     ~TOVAL_Effect();
 
+    /*
+        Zero heap instances. query_memory reports the size and alignment for a config (it runs one heap
+        backed init to measure, so call it at setup time). init_in then builds the instance, all of its
+        state and buffers contiguously inside the caller's block, applies the config and inits, without
+        touching the heap. Returns nullptr with *error set when the block is too small or misaligned.
+        Release with destroy_in, the memory itself stays the caller's. Async mode still allocates its
+        rings in TOVAL_Effect_async_start.
+    */
+    static TOVAL_ERROR TOVAL_Effect_query_memory(size_t data_length, const void* config_data, TOVAL_MemoryRequirements* requirements);
+    static TOVAL_Effect* TOVAL_Effect_init_in(void* memory, size_t size, size_t data_length, const void* config_data, TOVAL_ERROR* error);
+    static void TOVAL_Effect_destroy_in(TOVAL_Effect* effect);
+
     // Public methods
     TOVAL_ERROR TOVAL_Effect_init();
     TOVAL_ERROR TOVAL_Effect_set(uint16_t moduleID, uint16_t paramID, uint16_t datalength, void* data);
     TOVAL_ERROR TOVAL_Effect_get(uint16_t moduleID, uint16_t paramID, uint16_t datalength, void* data);
+
+    // Applies count values in one call: all are validated first (nothing is applied if any fails), then
+    // published together so the audio thread sees them in the same block.
+    TOVAL_ERROR TOVAL_Effect_set_batch(const TOVAL_ParamSet* params, size_t count);
+    TOVAL_ERROR TOVAL_Effect_get_batch(TOVAL_ParamSet* params, size_t count);
     TOVAL_ERROR TOVAL_Effect_process(float **ppIn, float **ppOut, size_t nspc);
+
+    // Same block as a planar view, frames and offset come from the view. Pass AudioBuffers (or aligned
+    // slices of them) to keep the chain on aligned memory. Out must have at least in's frame count.
+    TOVAL_ERROR TOVAL_Effect_process(const AudioBlockView& in, const AudioBlockView& out);
+
+    // As above with an external key for the compressor (COMPRESSOR.SIDECHAIN), at the host rate and at
+    // least in's frame count. One channel keys every channel, two key left and right.
+    TOVAL_ERROR TOVAL_Effect_process(const AudioBlockView& in, const AudioBlockView& out, const AudioBlockView& sidechain);
+
+    // Applies each event at its sample offset by splitting the block there. Events must be sorted by
+    // sample_offset and lie inside the block. They go to the modules directly: sets published before the
+    // call land first, sets made while it runs land at the next block, and a get keeps reporting the last
+    // TOVAL_Effect_set rather than the event value.
+    TOVAL_ERROR TOVAL_Effect_process_events(float **ppIn, float **ppOut, size_t nspc, const TOVAL_ParamEvent* events, size_t num_events);
+    TOVAL_ERROR TOVAL_Effect_process_events(const AudioBlockView& in, const AudioBlockView& out, const TOVAL_ParamEvent* events, size_t num_events);
+
+    // Fixed point host buffers, converted around TOVAL_Effect_process a block at a time. Planar passes one
+    // buffer per channel, interleaved ppIn[0] / ppOut[0] holding frames of In / Out channels. The output is
+    // requantised as GLOBAL_DITHER says (plain rounding by default).
+    TOVAL_ERROR TOVAL_Effect_process_pcm(const void* const* ppIn, void* const* ppOut, size_t nspc, TOVAL_PcmFormat format, TOVAL_PcmLayout layout);
+
+    // Async mode: the host callback only moves audio through lock-free rings, a worker thread runs
+    // TOVAL_Effect_process on worker_block frames at a time. Adds host_block + worker_block frames of latency.
+    TOVAL_ERROR TOVAL_Effect_async_start(size_t host_block, size_t worker_block);
+    TOVAL_ERROR TOVAL_Effect_async_process(float **ppIn, float **ppOut, size_t nspc);
+    TOVAL_ERROR TOVAL_Effect_async_stop();
+
+    // Channel parallel mode for wide buses: the channel independent stages (headroom, crossover, delay)
+    // split their channels across num_workers threads plus the processing thread, with a barrier after
+    // each stage. Blocks under min_work frames x channels stay on the processing thread. Output is
+    // identical to serial processing. Start and stop from a control thread while no block is running.
+    TOVAL_ERROR TOVAL_Effect_parallel_start(size_t num_workers, size_t min_work);
+    TOVAL_ERROR TOVAL_Effect_parallel_stop();
+
+    // Analyzer: turns frames tapped on the audio thread into the next ANALYZER.SPECTRUM when one is due
+    // (ANALYZER.RATE). Call it from an analysis thread or a UI timer, never the audio thread, and from one
+    // thread at a time. Returns NO_ERROR whether or not a new spectrum was published.
+    TOVAL_ERROR TOVAL_Effect_analyze();
     
     TOVAL_ERROR get_config(size_t data_length, void *config_data);
-    TOVAL_ERROR set_config(size_t data_length, const void *config_data);
+    TOVAL_ERROR set_config(size_t data_length, const void *config_data);    // takes effect at the next init
 
 private:
     struct Impl;
     Impl* pImpl;  // Pointer to the private implementation
+
+    explicit TOVAL_Effect(Impl* impl);      // init_in, Impl already placed in the arena
     
     // Maybe remove
     struct Variables;
-    Variables* pVariables;
+    Variables* pVariables = nullptr;
 
     //Test
 };
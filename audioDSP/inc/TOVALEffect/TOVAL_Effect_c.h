@@ -0,0 +1,83 @@
+#ifndef TOVAL_EFFECT_C_H
+#define TOVAL_EFFECT_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    Flat C ABI over TOVAL_Effect, exported by the TOVAL_Effect_c shared library for callers that can't
+    use the C++ class, mainly scripts/unit Tests/toval_effect.py through ctypes.
+
+    Every call returns a TOVAL_ERROR value as uint32_t (0 = NO_ERROR, same numbering as TOVALaudio.h).
+    Buffers stay the caller's: process reads and writes the planar channel pointers it is given, so a
+    NumPy array goes through without a copy. Same threading rules as the class, set / get from any
+    thread, process from one.
+
+    Typical use:
+        h = TOVAL_effect_create()
+        TOVAL_effect_set_config(h, &config), TOVAL_effect_init(h)
+        TOVAL_effect_set(h, HEADROOM, HR_GAIN, &gain, 4) ...
+        TOVAL_effect_process(h, in, out, frames) ...
+        TOVAL_effect_destroy(h)
+*/
+
+#if defined(_WIN32) && defined(TOVAL_C_API_BUILD)
+    #define TOVAL_C_API __declspec(dllexport)
+#elif defined(__GNUC__)
+    #define TOVAL_C_API __attribute__((visibility("default")))
+#else
+    #define TOVAL_C_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct TOVAL_EffectHandle TOVAL_EffectHandle;      // a TOVAL_Effect
+
+// What set_config takes from the caller, channel counts are fixed by the chain
+typedef struct TOVAL_EffectConfig {
+    float sample_rate;
+    float internal_sample_rate;     // 0 runs the chain at sample_rate
+    uint32_t src_quality;           // TOVAL_SrcQuality
+} TOVAL_EffectConfig;
+
+// One TOVAL_PARAM_TABLE row
+typedef struct TOVAL_EffectParamInfo {
+    uint16_t module_id;
+    uint16_t param_id;
+    const char* module_name;        // static strings, as in the JSON test cases
+    const char* param_name;
+    uint32_t type;                  // TOVAL_ParamType: 0 U32, 1 F32, 2 BLOB
+    uint32_t read_only;
+    uint32_t size;                  // bytes get / set expect
+    float min;
+    float max;
+    float def;
+} TOVAL_EffectParamInfo;
+
+TOVAL_C_API uint32_t TOVAL_effect_version(void);       // major << 16 | minor << 8 | patch
+
+TOVAL_C_API TOVAL_EffectHandle* TOVAL_effect_create(void);     // NULL when out of memory
+TOVAL_C_API void TOVAL_effect_destroy(TOVAL_EffectHandle* effect);
+
+TOVAL_C_API uint32_t TOVAL_effect_set_config(TOVAL_EffectHandle* effect, const TOVAL_EffectConfig* config);    // takes effect at init
+TOVAL_C_API uint32_t TOVAL_effect_init(TOVAL_EffectHandle* effect);
+TOVAL_C_API uint32_t TOVAL_effect_num_channels(TOVAL_EffectHandle* effect, uint32_t* in_channels, uint32_t* out_channels);
+
+TOVAL_C_API uint32_t TOVAL_effect_set(TOVAL_EffectHandle* effect, uint16_t module_id, uint16_t param_id, const void* data, uint32_t data_length);
+TOVAL_C_API uint32_t TOVAL_effect_get(TOVAL_EffectHandle* effect, uint16_t module_id, uint16_t param_id, void* data, uint32_t data_length);
+
+// in / out hold in_channels / out_channels pointers to frames floats each, in may equal out
+TOVAL_C_API uint32_t TOVAL_effect_process(TOVAL_EffectHandle* effect, const float* const* in, float* const* out, size_t frames);
+
+TOVAL_C_API uint32_t TOVAL_effect_analyze(TOVAL_EffectHandle* effect);
+
+TOVAL_C_API uint32_t TOVAL_effect_param_count(void);
+TOVAL_C_API uint32_t TOVAL_effect_param_info(uint32_t index, TOVAL_EffectParamInfo* info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TOVAL_EFFECT_C_H
@@ -1,15 +1,46 @@
 #ifndef TOVAL_EFFECT_P_H
 #define TOVAL_EFFECT_P_H
 
+#include <array>
+#include <atomic>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "Analyzer.h"
+#include "AudioBuffer.h"
+#include "Compressor.h"
+#include "Crossover.h"
+#include "Delay.h"
+#include "Fir.h"
 #include "Headroom.h"
+#include "Kernels.h"
+#include "PcmConverter.h"
+#include "Resampler.h"
+#include "Reverb.h"
+#include "SpscRing.h"
+#include "TOVALarena.h"
 #include "TOVAL_Effect.h"  // Include the public header
 #include "TOVALaudio.h"
+#include "TOVALparams.h"
+#include "WorkerGroup.h"
 
 
 // Define the struct that holds the private implementation
 struct TOVAL_Effect::Impl {
+    // Every buffer below is carved from here at init. Heap backed for `new TOVAL_Effect`, the caller's
+    // block for TOVAL_Effect_init_in (which also holds the TOVAL_Effect and this Impl ahead of init_mark).
+    TOVAL_Arena arena;
+    size_t init_mark = 0;
+
     // Private member variables
     Headroom headroom;
+    Fir fir;
+    Compressor compressor;
+    Crossover crossover;
+    Delay delay;
+    Reverb reverb;
+    Analyzer analyzer;
 
     // Define Variables inside Impl
     struct Variables {
@@ -17,21 +48,111 @@ struct TOVAL_Effect::Impl {
         uint32_t repeat_counter;
     } variables;  // Declare a member instance of Variables
 
-    struct Config {
-        float sample_rate;
-        uint16_t In_num_channels;
-        uint16_t Out_num_channels;
+    TOVAL_Config config;
+
+    // Sample rate conversion around the chain, active when config.internal_sample_rate differs from config.sample_rate
+    struct SrcStage {
+        bool enabled = false;
+        Resampler in;           // host rate -> internal rate
+        Resampler out;          // internal rate -> host rate
+        AudioBuffer internal_in;
+        AudioBuffer internal_out;
+        AudioBuffer fifo;                       // host rate output waiting to be handed back
+        Resampler sidechain;                    // compressor key, host rate -> internal rate
+        AudioBuffer internal_sidechain;
+        bool sidechain_live = false;            // fed last block, so still in step with in
+        size_t fifo_count = 0;
+        size_t prime = 0;                       // zeros pre-loaded into fifo so a block never runs dry
+    } src;
+
+    // Fixed point I/O for TOVAL_Effect_process_pcm, float staging for one block
+    struct PcmStage {
+        static constexpr size_t BLOCK = 512;
+        PcmConverter converter;
+        AudioBuffer in;
+        AudioBuffer out;
+    } pcm;
+
+    // Worker thread mode, see TOVAL_Effect_async_start
+    struct AsyncStage {
+        std::atomic<bool> running{false};
+        std::thread worker;
+        SpscRing to_worker;
+        SpscRing from_worker;
+        size_t host_block = 0;
+        size_t worker_block = 0;
+        uint32_t latency = 0;
+        std::atomic<uint32_t> underruns{0};
+        std::atomic<uint32_t> wake{0};          // bumped by the host after each push, the worker waits on it
+        std::vector<std::vector<float>> work_in;
+        std::vector<std::vector<float>> work_out;
+    } async;
+
+    // Channel parallel mode, see TOVAL_Effect_parallel_start. Parameters are applied on the processing
+    // thread before a stage fans out, so every worker sees the same values for the whole block.
+    struct ParallelStage {
+        WorkerGroup workers;
+        size_t min_work = 0;                    // frames x channels below which a stage runs inline
+    } parallel;
+
+    // Parameter snapshot. A set from any thread is validated against TOVAL_PARAM_TABLE, its raw value
+    // stored and its row marked dirty, then generation is bumped once per call (once per batch). The
+    // audio thread applies the dirty rows to the modules at the start of the next block.
+    struct ParamState {
+        static constexpr uint64_t BATCH_STARTED = 1;                            // in flight + 1
+        static constexpr uint64_t BATCH_FINISHED = (uint64_t{1} << 32) - 1;     // in flight - 1, finished + 1
+        static constexpr uint64_t BATCH_IN_FLIGHT = 0xFFFFFFFFu;
 
-        // more to be added
-    } config;   // potentially make public
+        std::array<std::atomic<uint32_t>, TOVAL_PARAM_COUNT> values{};
+        std::array<std::atomic<uint64_t>, (TOVAL_PARAM_COUNT + 63) / 64> dirty{};
+        std::atomic<uint32_t> generation{0};
+        std::atomic<uint64_t> batches{0};       // low half batches being published, high half batches finished
+        uint32_t applied_generation = 0;
+        std::array<uint32_t, TOVAL_PARAM_COUNT> applied{};     // audio thread, the last value each module took
+    } params;
+
+    // Compressor key for the block being processed, nullptr outside TOVAL_Effect_process(in, out, sidechain)
+    const AudioBlockView* sidechain = nullptr;
+
+    // DSP kernel variant every module runs, rebound by GLOBAL_KERNEL_ISA. Atomic so KERNEL_ACTIVE reads from any thread.
+    std::atomic<uint32_t> kernel_isa{KERNEL_ISA_GENERIC};
 
     // Private methods
-    TOVAL_ERROR TOVAL_Effect_do_set(uint32_t moduleID, uint16_t paramID, uint16_t data_length, void* data);
-    TOVAL_ERROR TOVAL_Effect_do_get(uint32_t moduleID, uint16_t paramID, uint16_t data_length, void* data);
+    TOVAL_ERROR validate_param(uint16_t moduleID, uint16_t paramID, uint16_t data_length, const void* data, int& index) const;
+    void publish_param(int index, uint32_t bits);
+    void apply_pending_params();
+    void apply_published(int index, uint32_t bits);
+    void apply_event(int index, uint32_t bits);
+    TOVAL_ERROR apply_param(int index, uint32_t bits);
+    uint32_t read_param(int index) const;
+    TOVAL_ERROR read_blob(int index, size_t data_length, void* data);
+    uint32_t settling_samples() const;
+    void reset_params();
 
+    void bind_kernels(TOVAL_KernelIsa requested);
     void update_channel_config();
+    TOVAL_ERROR update_resampler_config();
+    float processing_rate() const;
+
+    // fn(ch) for every channel of a stage, across the worker group when the block is big enough
+    template <typename Fn>
+    void for_each_channel(uint16_t num_channels, size_t nspc, Fn& fn)
+    {
+        if (!parallel.workers.running() || nspc * num_channels < parallel.min_work)
+        {
+            for (uint16_t ch = 0; ch < num_channels; ch++)
+            {
+                fn(ch);
+            }
+            return;
+        }
+        parallel.workers.run(num_channels, [](void* context, size_t ch) { (*static_cast<Fn*>(context))(static_cast<uint16_t>(ch)); }, &fn);
+    }
+
+    TOVAL_ERROR process_block(const AudioBlockView& in, const AudioBlockView& out);
+    TOVAL_ERROR process_chain(const AudioBlockView& in, const AudioBlockView& out, const AudioBlockView* key);
+    TOVAL_ERROR process_resampled(const AudioBlockView& in, const AudioBlockView& out, const AudioBlockView* key);
 
-    TOVAL_ERROR global_set(uint16_t paramID, uint16_t data_length, void* data);
     
 /*
     enum Modules {
@@ -48,6 +169,12 @@ struct TOVAL_Effect::Impl {
     int get_num_channels_for_module(TOVAL_Module module) {
     switch (module) {
         case HEADROOM: return headroom.num_channels;
+        case DELAY:    return delay.num_channels;
+        case CROSSOVER: return crossover.num_channels;
+        case COMPRESSOR: return compressor.num_channels;
+        case ANALYZER: return analyzer.num_channels;
+        case REVERB:   return reverb.num_channels;
+        case FIR:      return fir.num_channels;
         default:       return 0;
         }
     }
@@ -0,0 +1,108 @@
+#ifndef ANALYZER_H
+#define ANALYZER_H
+
+#include <atomic>
+#include <cstdint>
+#include <span>
+
+#include "AudioBuffer.h"
+#include "FFT.h"
+#include "SpscRing.h"
+#include "TOVALarena.h"
+#include "TOVALaudio.h"
+#include "TripleBuffer.h"
+
+/*
+    Spectrum analyzer tap. Three threads, none waiting on another:
+
+        audio      analyzer_tap at every tap point in the chain. Copies the block into a lock-free
+                   ring when enabled at that point, returns straight away otherwise.
+        analysis   analyzer_update, from an analysis thread or a UI timer. Drains the ring into a
+                   mono history and, once per 1 / AN_RATE seconds, Hann windows the newest AN_FFT_SIZE
+                   frames, runs the FFT and publishes dB magnitudes through a triple buffer.
+        reader     read_spectrum (TOVAL_Effect_get AN_SPECTRUM), always the newest complete spectrum.
+                   Copies out of the triple buffer's reader slot, so it never sees a half written one.
+                   That slot is single reader, so readers on several threads take turns on a flag;
+                   they only ever wait for each other, never for the audio or analysis side.
+
+    A full sine at 0 dBFS reads 0 dB at its bin. When the analysis side falls behind, the ring fills and
+    further frames are dropped, the audio thread never blocks. Everything is carved from the arena at init.
+*/
+
+enum AnalyzerChannels
+    {
+        AN_LEFT,
+        AN_RIGHT,
+        AN_NUM_CHANNELS
+    };
+
+class Analyzer {
+
+    public:
+
+    static constexpr size_t MAX_FFT_SIZE = 4096;
+    static constexpr size_t MAX_BINS = MAX_FFT_SIZE / 2 + 1;
+    static_assert(MAX_BINS == TOVAL_SPECTRUM_MAX_BINS, "TOVAL_Spectrum must hold a MAX_FFT_SIZE spectrum");
+
+    TOVAL_ERROR analyzer_init(float sample_rate, TOVAL_Arena& arena);
+
+    // Per parameter setters, called from the effect's descriptor table
+    TOVAL_ERROR set_enable(size_t data_length, void* data);
+    TOVAL_ERROR set_tap_point(size_t data_length, void* data);
+    TOVAL_ERROR set_fft_size(size_t data_length, void* data);
+    TOVAL_ERROR set_rate(size_t data_length, void* data);
+
+    // Audio thread
+    void analyzer_tap(uint32_t point, const AudioBlockView& block)
+    {
+        if (enable && point == tap_point)
+        {
+            ring.push(block);
+        }
+    }
+
+    // Analysis side, one thread at a time. True when a new spectrum was published.
+    bool analyzer_update();
+
+    // Reader side, any thread. data is a TOVAL_Spectrum, bins and sequence are 0 before the first one.
+    TOVAL_ERROR read_spectrum(size_t data_length, void* data);
+    uint32_t published() const { return sequence_published.load(std::memory_order_relaxed); }
+
+    uint16_t num_channels = AnalyzerChannels::AN_NUM_CHANNELS;
+
+    private:
+
+    void build_window(size_t size);
+
+    static constexpr size_t POP_CHUNK = 512;
+
+    // Audio thread
+    uint32_t enable;
+    uint32_t tap_point;
+
+    // Applied on the audio thread, read on the analysis side
+    std::atomic<uint32_t> fft_size{2048};
+    std::atomic<float> rate{20.0f};
+
+    // Analysis side
+    float sample_rate;
+    size_t history_write = 0;
+    size_t history_filled = 0;
+    size_t since_last = 0;
+    uint32_t sequence = 0;
+    float window_scale = 1.0f;      // 2 / sum(window), full scale sine -> 1
+    FFT fft;
+    std::span<float> history;       // MAX_FFT_SIZE mono frames, circular
+    std::span<float> incoming;      // AN_NUM_CHANNELS x POP_CHUNK
+    std::span<float> window;
+    std::span<float> frame;
+    std::span<float> re;
+    std::span<float> im;
+
+    SpscRing ring;
+    TripleBuffer<TOVAL_Spectrum> spectra;
+    std::atomic_flag reading;       // held by the read_spectrum copying out of the reader slot
+    std::atomic<uint32_t> sequence_published{0};
+};
+
+#endif // ANALYZER_H
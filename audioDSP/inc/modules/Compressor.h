@@ -0,0 +1,102 @@
+#ifndef COMPRESSOR_H
+#define COMPRESSOR_H
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "AudioBuffer.h"
+#include "TOVALarena.h"
+#include "TOVALaudio.h"
+
+/*
+    Feed forward compressor / expander. Detection is on the instantaneous peak, the static curve and
+    the attack / release smoothing both work on the gain in the log domain (log2 units, 1 = 6.02 dB):
+
+        level   = log2(max(|x|))                          over all channels when linked
+        over    = dir * (level - threshold)               dir = +1 compress, -1 expand
+        reduce  = slope * knee(over), at least -range     slope = 1/ratio - 1 or 1 - ratio
+        gain    = smooth(reduce) + makeup, applied as 2^gain
+
+    knee() is the usual quadratic soft knee written with min / max only, and the smoother picks attack
+    or release with a min of the two candidates rather than a branch, so nothing in the loop depends
+    on the signal. log2 and 2^x are the fast polynomial versions in TOVALsimd.h, run 4 frames at a time.
+*/
+
+enum CompressorChannels
+    {
+        CP_LEFT,
+        CP_RIGHT,
+        CP_NUM_CHANNELS
+    };
+
+class Compressor {
+
+    public:
+
+    TOVAL_ERROR compressor_init(float sample_rate, TOVAL_Arena& arena);
+    TOVAL_ERROR compressor_process(float **ppIn, float **ppOut, size_t nspc);     // ppIn may equal ppOut
+
+    // sidechain is only read when CP_SIDECHAIN is on, nullptr (or too short) detects on in instead.
+    // Channel ch keys from sidechain channel ch, or the last one if there are fewer.
+    TOVAL_ERROR compressor_process(const AudioBlockView& in, const AudioBlockView& out, const AudioBlockView* sidechain = nullptr);
+
+    // Per parameter setters, called from the effect's descriptor table
+    TOVAL_ERROR set_enable(size_t data_length, void* data);
+    TOVAL_ERROR set_mode(size_t data_length, void* data);
+    TOVAL_ERROR set_threshold(size_t data_length, void* data);
+    TOVAL_ERROR set_ratio(size_t data_length, void* data);
+    TOVAL_ERROR set_knee(size_t data_length, void* data);
+    TOVAL_ERROR set_attack(size_t data_length, void* data);
+    TOVAL_ERROR set_release(size_t data_length, void* data);
+    TOVAL_ERROR set_makeup(size_t data_length, void* data);
+    TOVAL_ERROR set_range(size_t data_length, void* data);
+    TOVAL_ERROR set_link(size_t data_length, void* data);
+    TOVAL_ERROR set_sidechain(size_t data_length, void* data);
+
+    // Samples for the gain smoother to come back from full range reduction
+    uint32_t settling_samples(uint32_t enable, float attack_ms, float release_ms, float range_db) const;
+
+    uint16_t num_channels = CompressorChannels::CP_NUM_CHANNELS;
+
+    static constexpr size_t CHUNK = 256;
+
+    private:
+
+    void update_curve();
+    float time_coefficient(float ms) const;
+
+    // Static curve into pGain for n frames keyed from channels [first, first + count) of key
+    void gain_computer(const AudioBlockView& key, uint16_t first, uint16_t count, size_t start, size_t n, float* pGain) const;
+
+    uint32_t enable;
+    uint32_t mode;
+    uint32_t link;
+    uint32_t sidechain;
+    float sample_rate;
+
+    // As set, dB and ms
+    float threshold_db;
+    float ratio;
+    float knee_db;
+    float attack_ms;
+    float release_ms;
+    float makeup_db;
+    float range_db;
+
+    // Derived by update_curve, log2 units
+    float threshold;
+    float direction;
+    float slope;
+    float half_knee;
+    float knee;
+    float inv_twice_knee;
+    float floor_gain;
+    float makeup;
+    float coefficients[2];          // [0] release, [1] attack
+
+    std::span<float> envelope;      // smoothed reduction per channel, log2 units
+    std::span<float> gain;          // CP_NUM_CHANNELS x CHUNK scratch
+};
+
+#endif // COMPRESSOR_H
@@ -0,0 +1,77 @@
+#ifndef CROSSOVER_H
+#define CROSSOVER_H
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "AudioBuffer.h"
+#include "Kernels.h"
+#include "LRCrossover.h"
+#include "TOVALarena.h"
+#include "TOVALaudio.h"
+
+/*
+    Multiband split and recombine. Each channel goes through an LRCrossover into 2 - 5 bands, each band
+    gets its own gain and the bands are summed back. With every gain at 0 dB the output is the input
+    through an allpass, so the module is transparent in magnitude. Per band processing (dynamics) slots
+    in between the split and the sum.
+
+    Blocks are run CHUNK frames at a time so the interleaved band scratch stays in L1.
+*/
+
+enum CrossoverChannels
+    {
+        XO_LEFT,
+        XO_RIGHT,
+        XO_NUM_CHANNELS
+    };
+
+class Crossover {
+
+    public:
+
+    TOVAL_ERROR crossover_init(float sample_rate, TOVAL_Arena& arena);
+    TOVAL_ERROR crossover_process(float **ppIn, float **ppOut, size_t nspc);   // ppIn may equal ppOut
+    TOVAL_ERROR crossover_process(const AudioBlockView& in, const AudioBlockView& out);
+
+    // crossover_process in pieces for channel parallel callers, same contract as Headroom's
+    TOVAL_ERROR crossover_check(const AudioBlockView& in, const AudioBlockView& out) const;
+    void crossover_process_channel(const AudioBlockView& in, const AudioBlockView& out, uint16_t ch);
+    void crossover_end_block(size_t nspc);
+
+    // Per parameter setters, called from the effect's descriptor table
+    TOVAL_ERROR set_enable(size_t data_length, void* data);
+    TOVAL_ERROR set_num_bands(size_t data_length, void* data);
+    TOVAL_ERROR set_frequency(uint32_t index, size_t data_length, void* data);     // index 0 .. MAX_BANDS - 2
+    TOVAL_ERROR set_band_gain(uint32_t band, size_t data_length, void* data);      // dB
+
+    // Samples until the band filters have rung out, set by the lowest active crossover
+    uint32_t settling_samples(uint32_t enable, uint32_t num_bands, const float* frequencies) const;
+
+    void set_kernels(const TOVAL_Kernels& table);     // init picks the best for this CPU
+
+    uint16_t num_channels = CrossoverChannels::XO_NUM_CHANNELS;
+
+    static constexpr uint32_t MAX_BANDS = LRCrossover::MAX_BANDS;
+    static constexpr size_t CHUNK = 256;
+
+    private:
+
+    void update_bands();
+
+    uint32_t enable;
+    uint32_t num_bands;
+    float sample_rate;
+    float frequency[MAX_BANDS - 1];     // as set, sorted into the splitter by update_bands
+    float gain_db[MAX_BANDS];
+
+    // Linear band gains. A change ramps from current to target over one chunk.
+    float gain_target[MAX_BANDS];
+    float gain_current[MAX_BANDS];
+
+    LRCrossover splitter;
+    std::span<float> bands;             // per channel CHUNK x LANES interleaved band scratch
+};
+
+#endif // CROSSOVER_H
@@ -0,0 +1,86 @@
+#ifndef DELAY_H
+#define DELAY_H
+
+#include <cstdint>
+#include <cstring>
+#include <math.h>
+#include <span>
+
+#include "AudioBuffer.h"
+#include "TOVALarena.h"
+#include "TOVALaudio.h"
+#include "TOVALparams.h"
+#include "DelayLine.h"
+#include "Kernels.h"
+
+
+enum DelayChannels
+    {
+        DL_LEFT,
+        DL_RIGHT,
+        DL_NUM_CHANNELS
+    };
+
+class Delay {
+
+    public:
+
+    TOVAL_ERROR delay_init(float sample_rate, TOVAL_Arena& arena);
+    TOVAL_ERROR delay_process(float **ppIn, float **ppOut, size_t nspc);   // ppIn may equal ppOut
+    TOVAL_ERROR delay_process(const AudioBlockView& in, const AudioBlockView& out);
+
+    // delay_process in pieces for channel parallel callers: check, then per block of at most
+    // TOVAL_MAX_BLOCK_SIZE frames begin_block on the calling thread and every channel once (any thread)
+    TOVAL_ERROR delay_check(const AudioBlockView& in, const AudioBlockView& out) const;
+    void delay_begin_block(size_t block);
+    void delay_process_channel(const AudioBlockView& in, const AudioBlockView& out, uint16_t ch);
+
+    // Per parameter setters, called from the effect's descriptor table
+    TOVAL_ERROR set_enable(size_t data_length, void* data);
+    TOVAL_ERROR set_time(size_t data_length, void* data);
+    TOVAL_ERROR set_feedback(size_t data_length, void* data);
+    TOVAL_ERROR set_mix(size_t data_length, void* data);
+    TOVAL_ERROR set_mod_depth(size_t data_length, void* data);
+    TOVAL_ERROR set_mod_rate(size_t data_length, void* data);
+    TOVAL_ERROR set_interpolation(size_t data_length, void* data);
+
+    // Samples until the feedback tail has decayed for these settings, TOVAL_SETTLE_NEVER while the LFO runs
+    uint32_t settling_samples(uint32_t enable, float time_ms, float feedback, float mod_depth_ms) const;
+
+    void set_kernels(const TOVAL_Kernels& table);     // init picks the best for this CPU
+
+    uint16_t num_channels = DelayChannels::DL_NUM_CHANNELS;
+
+    // The lines are sized for the longest time and depth the table allows
+    static constexpr float MAX_TIME_MS = TOVAL_param_descriptor(DELAY, DL_TIME).max;
+    static constexpr float MAX_MOD_DEPTH_MS = TOVAL_param_descriptor(DELAY, DL_MOD_DEPTH).max;
+
+    private:
+
+    void update_lfo_increment();
+
+    uint32_t enable;
+    uint32_t interpolation;     // TOVAL_DelayInterp
+    float sample_rate;
+    const TOVAL_Kernels* kernels = nullptr;
+
+    float time_ms;
+    float feedback;
+    float mix;
+    float mod_depth_ms;
+    float mod_rate_hz;
+
+    // Quadrature LFO, rotated once per sample, shared by both channels
+    float lfo_sin;
+    float lfo_cos;
+    float lfo_rot_sin;
+    float lfo_rot_cos;
+
+    std::span<DelayLine> lines;
+    std::span<float> delay_curve;       // per sample delay in samples for the current block
+    size_t chunk_limit = 1;             // frames readable before any has to be written, for the current block
+    std::span<float> wet;               // per channel delayed signal, one chunk
+    std::span<float> feed;              // per channel input + feedback written back into the line
+};
+
+#endif // DELAY_H
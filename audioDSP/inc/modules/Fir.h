@@ -0,0 +1,68 @@
+#ifndef FIR_H
+#define FIR_H
+
+#include <cstdint>
+#include <cstring>
+
+#include "AudioBuffer.h"
+#include "FirDesign.h"
+#include "FirFilter.h"
+#include "TOVALarena.h"
+#include "TOVALaudio.h"
+
+/*
+    Short FIR stage after the headroom: a linear phase lowpass / highpass, half band, DC blocker or
+    fractional delay designed from FR_TYPE, FR_TAPS, FR_CUTOFF and FR_FRACTION, run by FirFilter.
+
+    Every type but the fractional delay is symmetric and delays the signal by (FR_TAPS - 1) / 2 frames.
+    The taps are redesigned on each set; a change that keeps the rounded length keeps the history too.
+    Both channels go through FirFilter's stereo kernel together, so the stage runs whole rather than
+    per channel.
+*/
+
+enum FirChannels
+    {
+        FR_LEFT,
+        FR_RIGHT,
+        FR_NUM_CHANNELS
+    };
+
+class Fir {
+
+    public:
+
+    TOVAL_ERROR fir_init(float sample_rate, TOVAL_Arena& arena);
+    TOVAL_ERROR fir_process(float **ppIn, float **ppOut, size_t nspc);     // ppIn may equal ppOut
+    TOVAL_ERROR fir_process(const AudioBlockView& in, const AudioBlockView& out);
+
+    // Per parameter setters, called from the effect's descriptor table
+    TOVAL_ERROR set_enable(size_t data_length, void* data);
+    TOVAL_ERROR set_type(size_t data_length, void* data);
+    TOVAL_ERROR set_taps(size_t data_length, void* data);
+    TOVAL_ERROR set_cutoff(size_t data_length, void* data);
+    TOVAL_ERROR set_fraction(size_t data_length, void* data);
+
+    // Samples for an input to leave the history
+    uint32_t settling_samples(uint32_t enable, uint32_t taps) const;
+
+    uint16_t num_channels = FirChannels::FR_NUM_CHANNELS;
+
+    static constexpr uint32_t MAX_TAPS = FirFilter::MAX_TAPS;
+    static constexpr float MAX_CUTOFF = 0.49f;      // of the sample rate, FR_CUTOFF above it is clamped
+
+    private:
+
+    void update_taps();
+
+    uint32_t enable;
+    uint32_t type;          // TOVAL_FirType
+    uint32_t taps;
+    float cutoff_hz;
+    float fraction;
+    float sample_rate;
+
+    float designed[MAX_TAPS] = {};      // update_taps scratch, kept off the stack of the audio thread
+    FirFilter filter;
+};
+
+#endif // FIR_H
@@ -1,12 +1,20 @@
 #ifndef HEADROOM_H
 #define HEADROOM_H
 
+#include <atomic>
 #include <cstdint>
+#include <cstring>
 #include <math.h>
-#include <vector>
+#include <span>
 
+#include "AudioBuffer.h"
+#include "TOVALarena.h"
 #include "TOVALaudio.h"
 #include "conversionFN.h"
+#include "ControlRate.h"
+#include "Kernels.h"
+#include "SmoothedValue.h"
+#include "TripleBuffer.h"
 
 
 enum HeadroomChannels
@@ -20,42 +28,50 @@ class Headroom {
 
     public:
  
-    TOVAL_ERROR headroom_init();
-    TOVAL_ERROR headroom_set(uint16_t ParamID, size_t data_length, void* data);
-    TOVAL_ERROR headroom_get(uint16_t ParamID, size_t data_length, void* data);
+    TOVAL_ERROR headroom_init(float sample_rate, TOVAL_Arena& arena);
     TOVAL_ERROR headroom_process(float **ppIn, float **ppOut, size_t nspc);
+    TOVAL_ERROR headroom_process(const AudioBlockView& in, const AudioBlockView& out);     // in may equal out
 
-    uint16_t num_channels = HeadroomChannels::NUM_CHANNELS;
-    /*
-        Don't need the module ID for inside here. For loop itterating through each module ID is done in Delay effect do_set,
-        therefor if module ID is soft clip, EQ_do_set just needs to itterate through param ID's
+    // headroom_process in pieces for channel parallel callers: check once, every channel once (any thread,
+    // channels are independent), then end_block on the calling thread after all channels are done
+    TOVAL_ERROR headroom_check(const AudioBlockView& in, const AudioBlockView& out) const;
+    void headroom_process_channel(const AudioBlockView& in, const AudioBlockView& out, uint16_t ch);
+    void headroom_end_block(size_t nspc);
 
-        Look into whether I need to include set to do_set function call.
-    */
+    // Per parameter setters, called from the effect's descriptor table
+    TOVAL_ERROR set_enable(size_t data_length, void* data); 
+    TOVAL_ERROR set_gain(size_t data_length, void* data);
+    TOVAL_ERROR set_alpha(size_t data_length, void* data);
+    TOVAL_ERROR set_ramp_time(size_t data_length, void* data);
 
+    // Samples until the smoothing filter state and a gain ramp of ramp_ms (plus its control lag) have died out
+    uint32_t settling_samples(float ramp_ms) const;
 
-    private:
+    void set_kernels(const TOVAL_Kernels& table);     // init picks the best for this CPU
 
-    TOVAL_ERROR headroom_do_set(uint16_t ParamID, size_t data_length, void* data);
+    // Output meters, gathered in the same kernel pass that writes the output and published once per block.
+    // Any thread, readers take turns on a flag since the triple buffer has a single reader slot.
+    TOVAL_ERROR read_meter(size_t data_length, void* data);
 
-    TOVAL_ERROR set_enable(size_t data_length, void* data); 
-    TOVAL_ERROR set_gain(size_t data_length, void* data);
-    TOVAL_ERROR set_alpha(size_t data_length, void* data);
-    
+    uint16_t num_channels = HeadroomChannels::NUM_CHANNELS;
 
-    TOVAL_ERROR headroom_do_get(uint16_t ParamID, size_t data_length, void* data);
-    // Gets need adapting
-    TOVAL_ERROR get_enable(size_t data_length, void* data);
-    TOVAL_ERROR get_gain(size_t data_length, void* data);
-    TOVAL_ERROR get_stepResponse(size_t data_length, void* data);
+    static constexpr uint32_t CONTROL_INTERVAL = 32;     // frames between gain updates (dB to linear)
+
+
+    private:
+
+    void publish_meters(size_t nspc);
 
 
     uint32_t enable;       // Check where ref code stores enable variable, and how it passes data
 
     //std::array<float, HeadroomChannels::NUM_CHANNELS> y_1 = {};
-    std::vector<float> y_1;
+    std::span<float> y_1;
     float gain;
     float alpha;
+    float sample_rate;
+    bool started = false;       // a block has been processed, gain sets ramp from here on
+    const TOVAL_Kernels* kernels = nullptr;
 
     struct Headroom_gain
     {
@@ -63,7 +79,26 @@ class Headroom {
         float gain;
     };  // structure must be same order as elements passed in Json file for testing purposes
 
-    std::vector<Headroom_gain> headroom_features;
+    std::span<Headroom_gain> headroom_features;     // gain holds the target in dB
+
+    // The gain ramps in dB at control rate, converted to linear once per tick and interpolated in between
+    std::span<SmoothedValue> gain_smoothers;        // dB, towards headroom_features[ch].gain
+    std::span<ControlRate<1>> gain_control;         // linear, per channel so channels stay independent
+
+    // Metering. meter_block is this block, the rest builds up until the reader takes a snapshot.
+    struct MeterPending
+    {
+        double sum_squares;
+        float peak;
+        uint32_t clips;         // since init
+    };
+
+    std::span<TOVAL_MeterAccum> meter_block;
+    std::span<MeterPending> meter_pending;
+    uint64_t meter_frames = 0;
+    uint32_t meter_sequence = 0;
+    TripleBuffer<TOVAL_Meter> meters;
+    std::atomic_flag reading;       // held by the read_meter copying out of the reader slot
 
 
 /*
@@ -0,0 +1,96 @@
+#ifndef REVERB_H
+#define REVERB_H
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "AudioBuffer.h"
+#include "TOVALarena.h"
+#include "TOVALaudio.h"
+
+/*
+    Feedback delay network reverb, 8 or 16 lines, stereo in and out. Per frame:
+
+        x       = the line outputs, one aligned row of the ring (2 or 4 registers)
+        z       = x + damp * (z - x)            one pole lowpass per line
+        y       = z * gain                      per line decay for RV_DECAY, 1/sqrt(N) folded in
+        h       = hadamard(y)                   fast transform: add / sub across registers, then
+                                                two butterflies inside each register
+        wet     = h[0], h[1]                    left, right
+        line l  = h[l] +- input, written d_l frames ahead
+
+    The ring is skewed: row t holds what every line outputs at time t, so the read side is N contiguous
+    floats and the whole network stays in registers. The price is that each line's write lands in a
+    different row, N scalar stores per frame. Line lengths are spread exponentially and kept prime so
+    the echoes of different lines never pile up on the same frame.
+
+    Lines are shared by both channels, so the reverb runs as one stage rather than per channel.
+*/
+
+enum ReverbChannels
+    {
+        RV_LEFT,
+        RV_RIGHT,
+        RV_NUM_CHANNELS
+    };
+
+class Reverb {
+
+    public:
+
+    TOVAL_ERROR reverb_init(float sample_rate, TOVAL_Arena& arena);
+    TOVAL_ERROR reverb_process(float **ppIn, float **ppOut, size_t nspc);     // ppIn may equal ppOut
+    TOVAL_ERROR reverb_process(const AudioBlockView& in, const AudioBlockView& out);
+
+    // Per parameter setters, called from the effect's descriptor table
+    TOVAL_ERROR set_enable(size_t data_length, void* data);
+    TOVAL_ERROR set_decay(size_t data_length, void* data);
+    TOVAL_ERROR set_size(size_t data_length, void* data);
+    TOVAL_ERROR set_damping(size_t data_length, void* data);
+    TOVAL_ERROR set_wet(size_t data_length, void* data);
+    TOVAL_ERROR set_density(size_t data_length, void* data);
+
+    // Samples for the tail to fall below TOVAL_SETTLE_LEVEL
+    uint32_t settling_samples(uint32_t enable, float decay_s, float size) const;
+
+    uint16_t num_channels = ReverbChannels::RV_NUM_CHANNELS;
+
+    static constexpr size_t MAX_LINES = 16;
+    static constexpr float MIN_LONGEST_MS = 15.0f;      // longest line at size 0
+    static constexpr float MAX_LONGEST_MS = 80.0f;      // and at size 1
+    static constexpr float SHORTEST_RATIO = 0.3f;       // shortest line over the longest
+
+    private:
+
+    float longest_line(float size) const;       // samples
+    void update_lines();
+    void update_gains();
+    void reset();
+
+    template <size_t Registers>
+    void run(const float* pInL, const float* pInR, float* pOutL, float* pOutR, size_t n);
+
+    uint32_t enable;
+    uint32_t density;           // TOVAL_ReverbDensity
+    float sample_rate;
+
+    float decay_s;
+    float size;
+    float damping;
+    float wet;
+
+    size_t lines = 8;           // N, also the ring's row stride
+    size_t ring_mask = 0;       // ring frames - 1
+    size_t position = 0;        // row read next
+
+    uint32_t delay[MAX_LINES] = {};                 // per line, frames
+    alignas(16) float state[MAX_LINES] = {};        // damping lowpass per line
+    alignas(16) float damp[MAX_LINES] = {};
+    alignas(16) float gain[MAX_LINES] = {};
+    alignas(16) float input_sign[MAX_LINES] = {};   // +-input scale, even lanes take left and odd lanes right
+
+    std::span<float> ring;      // ring frames x N, row t is what each line outputs at time t
+};
+
+#endif // REVERB_H
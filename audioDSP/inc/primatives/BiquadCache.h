@@ -0,0 +1,68 @@
+#ifndef BIQUADCACHE_H
+#define BIQUADCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "BiquadDesign.h"
+
+/*
+    Process wide cache of biquad designs, shared by every instance in the host.
+
+    SETS x WAYS entries in static storage, set associative on a hash of the key, keys compared bit for
+    bit (a preset reloaded from the same floats always hits). The cache is copy-out only: lookup copies
+    the coefficients into the caller's BiquadCoeffs under the entry's version (a seqlock read), callers
+    re-lay them for their kernel anyway. No atomic read-modify-write at all on a hit.
+
+    Hits are lock-free and stamp the entry with the insert clock. No shared counter is touched; the
+    clock only ticks on inserts, which is all the recency eviction needs. Misses design the filter into
+    the caller's copy, then take the insert flag with a try, never a wait, and overwrite the least
+    recently used way of the set. If another thread is inserting the result is just not cached. Nothing
+    allocates or blocks, so parameter changes on the audio thread can use it.
+*/
+class BiquadCache {
+
+    static constexpr size_t KEY_WORDS = sizeof(BiquadKey) / sizeof(uint32_t);
+
+    struct Entry {
+        std::atomic<uint32_t> version{0};       // odd while being written, 0 = never written
+        std::atomic<uint64_t> last_used{0};
+        uint32_t key[KEY_WORDS] = {};           // written and compared word wise through atomic_ref
+        BiquadCoeffs coeffs{};
+    };
+
+    public:
+
+    static constexpr size_t SETS = 256;
+    static constexpr size_t WAYS = 4;
+
+    // Miss side only, so hits stay free of shared counters
+    struct Stats {
+        uint64_t misses;
+        uint64_t evictions;
+    };
+
+    void lookup(const BiquadKey& key, BiquadCoeffs& out);
+    Stats stats() const;
+
+    private:
+
+    static size_t set_of(const uint32_t (&words)[KEY_WORDS]);
+    static bool key_matches(Entry& entry, const uint32_t (&words)[KEY_WORDS]);
+    bool try_copy(Entry& entry, const uint32_t (&words)[KEY_WORDS], BiquadCoeffs& out);
+    void insert(size_t set, const uint32_t (&words)[KEY_WORDS], const BiquadCoeffs& coeffs);
+
+    Entry entries[SETS * WAYS];
+    std::atomic_flag inserting;
+    std::atomic<uint64_t> clock{0};       // ticks once per insert
+
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+};
+
+// The one instance per process
+BiquadCache& biquad_cache();
+
+#endif // BIQUADCACHE_H
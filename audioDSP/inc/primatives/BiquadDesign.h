@@ -0,0 +1,40 @@
+#ifndef BIQUADDESIGN_H
+#define BIQUADDESIGN_H
+
+#include <cstdint>
+
+/*
+    RBJ cookbook biquads, the C++ side of biquad_coefficients in scripts/unit Tests/adaptiveEQ_*.py.
+
+    Coefficients are normalised to a0 = 1 and kept in double (b0 b1 b2 a1 a2); callers round to float
+    when they lay them out for a kernel. gain_db only matters for PEAKING and the shelves, q must be
+    positive and frequency inside (0, sample_rate / 2).
+*/
+
+enum class BiquadType : uint32_t {
+    LOWPASS,
+    HIGHPASS,
+    BANDPASS,
+    NOTCH,
+    PEAKING,
+    LOWSHELF,
+    HIGHSHELF,
+    ALLPASS
+};
+
+struct BiquadKey {
+    BiquadType type;
+    float frequency;
+    float q;
+    float gain_db;
+    float sample_rate;
+};
+static_assert(sizeof(BiquadKey) == 5 * sizeof(uint32_t), "no padding, BiquadCache compares and hashes raw words");
+
+struct BiquadCoeffs {
+    double c[5];        // b0 b1 b2 a1 a2
+};
+
+void biquad_design(const BiquadKey& key, BiquadCoeffs& out);
+
+#endif // BIQUADDESIGN_H
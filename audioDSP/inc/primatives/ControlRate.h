@@ -0,0 +1,102 @@
+#ifndef CONTROLRATE_H
+#define CONTROLRATE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+/*
+    Control rate driver for values that only need to move slowly: gains in dB, filter coefficients,
+    detector outputs.
+
+    A module declares its interval (frames between control ticks) and a control callback. run splits
+    each block at the ticks, which carry on across blocks, and at every tick asks the callback for the
+    Outputs values to reach by the next tick. The audio callback then gets the block in segments that
+    never cross a tick, each output going in a straight line from its value at the segment start. So
+    dB conversion, coefficient design and similar run once per interval rather than once per sample,
+    and the audio still sees a continuous ramp rather than steps.
+
+    Values lag the control side by up to one interval. The class holds no buffers, one per channel
+    keeps channels independent for channel parallel callers.
+*/
+
+template <size_t Outputs>
+class ControlRate {
+
+    public:
+
+    void control_init(uint32_t interval, float initial)
+    {
+        this->interval = std::max<uint32_t>(interval, 1);
+        inv_interval = 1.0f / static_cast<float>(this->interval);
+        set_immediate(initial);
+    }
+
+    // Every output to value with no ramp, the next frame is a tick
+    void set_immediate(float value)
+    {
+        std::fill(current, current + Outputs, value);
+        std::fill(target, target + Outputs, value);
+        std::fill(step, step + Outputs, 0.0f);
+        countdown = 0;
+    }
+
+    uint32_t get_interval() const { return interval; }
+    const float* get_current() const { return current; }
+
+    // Still ramping towards the last tick's targets
+    bool is_ramping() const
+    {
+        return std::any_of(step, step + Outputs, [](float s) { return s != 0.0f; });
+    }
+
+    /*
+        Runs n frames.
+            control(float* target)      at each tick, writes the Outputs values for the end of the interval
+            audio(size_t start, size_t count, const float* from, const float* step)
+                                        frames [start, start + count), output k at frame start + i is
+                                        from[k] + i * step[k]
+    */
+    template <typename Control, typename Audio>
+    void run(size_t n, Control&& control, Audio&& audio)
+    {
+        size_t done = 0;
+        while (done < n)
+        {
+            if (countdown == 0)
+            {
+                std::copy(target, target + Outputs, current);     // land exactly on the last targets
+                control(target);
+                for (size_t k = 0; k < Outputs; k++)
+                {
+                    step[k] = (target[k] - current[k]) * inv_interval;
+                }
+                countdown = interval;
+            }
+
+            const size_t count = std::min<size_t>(n - done, countdown);
+            audio(done, count, static_cast<const float*>(current), static_cast<const float*>(step));
+            for (size_t k = 0; k < Outputs; k++)
+            {
+                current[k] += step[k] * static_cast<float>(count);
+            }
+            countdown -= static_cast<uint32_t>(count);
+            done += count;
+        }
+    }
+
+    private:
+
+    uint32_t interval = 1;
+    uint32_t countdown = 0;         // frames to the next tick
+    float inv_interval = 1.0f;
+
+    float current[Outputs] = {};
+    float target[Outputs] = {};
+    float step[Outputs] = {};
+};
+
+// pOut[i] = pIn[i] * (from + i * step), in place is fine. The usual audio side of a ControlRate gain.
+void control_ramp_gain(const float* pIn, float* pOut, size_t n, float from, float step);
+
+#endif // CONTROLRATE_H
@@ -0,0 +1,49 @@
+#ifndef DELAYLINE_H
+#define DELAYLINE_H
+
+#include <cstdint>
+#include <span>
+
+#include "TOVALarena.h"
+#include "TOVALaudio.h"
+
+/*
+    Single channel ring buffer delay line.
+
+    Capacity is a power of two so positions wrap with a mask instead of a compare. Block reads and
+    writes are done as at most two contiguous spans (memcpy), and the first GUARD samples are mirrored
+    past the end of the buffer so a 4 point interpolation window never has to wrap.
+
+    Reads are relative to the current write position and are expected to happen before the block at
+    that position is written: output i of a read corresponds to the input sample that write_block will
+    store at write_pos + i. So a block of n samples can be read with any delay >= n (+ 2 for cubic).
+
+    All memory is carved from the arena in delayline_init.
+*/
+
+class DelayLine {
+
+    public:
+
+    static constexpr size_t GUARD = 4;
+
+    TOVAL_ERROR delayline_init(size_t max_delay, TOVAL_Arena& arena);
+    void delayline_reset();
+
+    void write_block(const float* pIn, size_t n);
+    void read_block(float* pOut, size_t n, size_t delay) const;
+
+    // Per sample fractional delays, pDelay[i] in samples
+    void read_block_linear(float* pOut, const float* pDelay, size_t n) const;
+    void read_block_cubic(float* pOut, const float* pDelay, size_t n) const;
+
+    size_t capacity() const { return mask + 1; }
+
+    private:
+
+    std::span<float> buffer;    // capacity + GUARD, the tail mirrors buffer[0 .. GUARD)
+    size_t mask = 0;
+    size_t write_pos = 0;
+};
+
+#endif // DELAYLINE_H
@@ -0,0 +1,49 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <cstdint>
+#include <span>
+
+#include "TOVALarena.h"
+#include "TOVALaudio.h"
+
+/*
+    Real input FFT for power of two sizes up to the max_size given at init.
+
+    The N real samples are packed as N/2 complex values (even samples real, odd imaginary), run through
+    an iterative radix-2 complex FFT and split back into the N/2 + 1 bins of the real transform, so a
+    real transform costs a half size complex one. Twiddles are computed once for max_size and strided
+    for smaller sizes. Everything is carved from the arena in fft_init, set_size and forward never allocate.
+
+    Not meant for the audio thread: the analyzer runs it on the analysis side.
+*/
+
+class FFT {
+
+    public:
+
+    static constexpr size_t MIN_SIZE = 16;
+
+    TOVAL_ERROR fft_init(size_t max_size, TOVAL_Arena& arena);
+    TOVAL_ERROR set_size(size_t size);      // power of two, MIN_SIZE .. max_size
+
+    // size() real samples in, bins() = size() / 2 + 1 complex bins out (DC .. Nyquist), unscaled
+    void forward(const float* pIn, float* pRe, float* pIm);
+
+    size_t size() const { return n; }
+    size_t bins() const { return n / 2 + 1; }
+
+    private:
+
+    void complex_fft(size_t m);
+
+    size_t max_n = 0;
+    size_t n = 0;
+    std::span<float> cos_table;     // cos / sin(2 pi k / max_n), k < max_n / 2
+    std::span<float> sin_table;
+    std::span<uint32_t> bit_reverse;    // for the current n / 2 point complex transform
+    std::span<float> work_re;
+    std::span<float> work_im;
+};
+
+#endif // FFT_H
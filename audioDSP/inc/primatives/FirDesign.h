@@ -0,0 +1,30 @@
+#ifndef FIRDESIGN_H
+#define FIRDESIGN_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+    Linear phase FIR kernels for FirFilter, windowed sinc with a Blackman window.
+
+    All but FRACTIONAL_DELAY are symmetric about (num_taps - 1) / 2 and delay the signal by that much.
+    HIGHPASS, HALFBAND and DC_BLOCK need an odd length: for an even num_taps they are designed one tap
+    shorter and the last tap is left at zero. Gains are normalised to exactly 1 in the passband centre
+    (DC, or Nyquist for HIGHPASS).
+*/
+
+enum class FirType : uint32_t {
+    LOWPASS,
+    HIGHPASS,
+    HALFBAND,           // lowpass at a quarter of the sample rate, every other tap exactly zero
+    FRACTIONAL_DELAY,   // (num_taps - 1) / 2 rounded down plus fraction samples, rolls off towards Nyquist (about -0.3 dB at 0.4 fs for 16 taps)
+    DC_BLOCK            // centre tap minus a moving average, notches at multiples of fs / num_taps
+};
+
+constexpr size_t FIR_DESIGN_MAX_TAPS = 256;
+
+// cutoff is a fraction of the sample rate in (0, 0.5), fraction is in [0, 1). h gets num_taps taps,
+// at most FIR_DESIGN_MAX_TAPS.
+void fir_design(FirType type, size_t num_taps, double cutoff, double fraction, float* h);
+
+#endif // FIRDESIGN_H
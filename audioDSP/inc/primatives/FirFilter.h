@@ -0,0 +1,72 @@
+#ifndef FIRFILTER_H
+#define FIRFILTER_H
+
+#include <cstdint>
+#include <span>
+
+#include "AudioBuffer.h"
+#include "TOVALarena.h"
+#include "TOVALaudio.h"
+
+/*
+    Direct form FIR for short kernels, 8 to MAX_TAPS taps (DC blockers, linear phase trims, fractional
+    delays, half band filters), where FFT convolution costs more than it saves.
+
+    Each channel keeps a doubled history: a ring of 2L samples stored twice over, every input written at
+    position p and p + 2L. The last L inputs are then always one contiguous run, so an output is a single
+    straight dot product against the taps (stored reversed) with no wrap in the loop. The ring is twice
+    the window so a whole chunk of L inputs can be written before any of its outputs are computed, which
+    keeps the vector loads clear of the scalar stores that just fed them.
+
+    L is the tap count rounded up to TAP_GROUP, the extra taps are zeros on the oldest side. Every L up
+    to MAX_TAPS has its own compile time kernel, so the dot product is fully unrolled over SIMD
+    registers. firfilter_process runs channels two at a time through a stereo kernel that loads each
+    group of taps once for both channels.
+
+    All memory is carved from the arena in firfilter_init.
+*/
+
+class FirFilter {
+
+    public:
+
+    static constexpr size_t MAX_TAPS = 256;
+    static constexpr size_t TAP_GROUP = 8;
+    static constexpr size_t HISTORY_PER_LENGTH = 4;     // ring of 2L, doubled
+
+    TOVAL_ERROR firfilter_init(uint16_t num_channels, size_t max_taps, TOVAL_Arena& arena);
+    void firfilter_reset();     // clears every channel's history
+
+    // taps[0] weighs the newest input. The history is kept when the rounded length stays the same, so a
+    // redesign of the same length does not click. PARAMETER_ERROR for 0, or more than max_taps rounded up to TAP_GROUP.
+    TOVAL_ERROR set_taps(const float* taps, size_t num_taps);
+    size_t get_num_taps() const { return num_taps; }
+
+    // One channel, pIn may equal pOut
+    void process_channel(const float* pIn, float* pOut, size_t n, uint16_t ch);
+
+    // Every channel of the filter, in may equal out
+    TOVAL_ERROR firfilter_process(const AudioBlockView& in, const AudioBlockView& out);
+
+    uint16_t get_num_channels() const { return num_channels; }
+
+    private:
+
+    using MonoKernel = void (*)(float* history, uint32_t& position, const float* coeffs, const float* pIn, float* pOut, size_t n);
+    using StereoKernel = void (*)(float* history0, float* history1, uint32_t& position, const float* coeffs,
+                                  const float* pIn0, const float* pIn1, float* pOut0, float* pOut1, size_t n);
+
+    uint16_t num_channels = 0;
+    size_t max_length = 0;          // history stride is HISTORY_PER_LENGTH * max_length
+    size_t length = TAP_GROUP;      // L
+    size_t num_taps = 0;
+
+    MonoKernel mono = nullptr;
+    StereoKernel stereo = nullptr;
+
+    std::span<float> coeffs;        // L taps, reversed: coeffs[L - 1] weighs the newest input
+    std::span<float> history;       // per channel HISTORY_PER_LENGTH * max_length, the first 4L in use
+    std::span<uint32_t> position;   // per channel ring position of the newest input
+};
+
+#endif // FIRFILTER_H
@@ -0,0 +1,80 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "TOVALaudio.h"
+
+/*
+    Hot DSP loops, built once per instruction set and picked at runtime.
+
+    Each variant lives in its own translation unit compiled with that ISA's flags (Kernels_avx2.cpp with
+    -mavx2 -mfma, Kernels_avx512.cpp with -mavx512f) and fills in a table of function pointers. Variant
+    files use intrinsics and plain loops only, no shared inline helpers, so nothing built for a wider ISA
+    can be picked up by the linker for baseline code. kernels_select checks CPUID once per process and
+    returns the best table at or below the requested ISA. Modules hold a pointer to the table, and each
+    entry does a block (or for dot, a whole filter) of work per call so the indirect call stays out of
+    the inner loops.
+
+    Variants agree to rounding, not bit for bit: FMA and wider accumulators change the last bits.
+*/
+
+// Lane count of the lane parallel kernels (one filter per lane, e.g. a crossover band per lane)
+constexpr size_t TOVAL_KERNEL_LANES = 8;
+
+// Output statistics gathered by the metering kernels. Kernels fold a block into it, callers reset it.
+struct TOVAL_MeterAccum {
+    float peak;             // largest |x|
+    float sum_squares;
+    uint32_t clips;         // samples with |x| >= 1 (full scale)
+};
+
+struct TOVAL_Kernels {
+    TOVAL_KernelIsa isa;
+    const char* name;
+
+    // Sum of a[i] * b[i]
+    float (*dot)(const float* a, const float* b, size_t n);
+
+    // One pole smoother y = (1 - alpha) * x + alpha * y[-1], then gain. *state is y[-1] in and out.
+    void (*onepole_gain)(const float* pIn, float* pOut, size_t n, float alpha, float gain, float* state);
+
+    // Delay feedback and mix: feed = x + feedback * wet, out = x + mix * (wet - x).
+    // pWet and pFeed must be 64 byte aligned (arena scratch), pIn and pOut may be anything.
+    void (*delay_mix)(const float* pIn, const float* pWet, float* pFeed, float* pOut, size_t n, float feedback, float mix);
+
+    // num_stages transposed direct form II biquads in series, one independent cascade per lane, every lane
+    // fed the same input. Per stage, coeffs holds b0 b1 b2 a1 a2 and state holds z1 z2, each
+    // TOVAL_KERNEL_LANES floats wide. Output is interleaved, pOut[i * TOVAL_KERNEL_LANES + lane].
+    // coeffs, state and pOut must be 64 byte aligned. Lanes at or above num_lanes may be skipped.
+    void (*biquad_lanes)(const float* pIn, float* pOut, size_t n, const float* coeffs, float* state, size_t num_stages, size_t num_lanes);
+
+    // onepole_gain that also folds every output sample into *meter, writing exactly what onepole_gain writes.
+    // Meters each short stretch while it is still in L1, so the output is never read back from memory.
+    void (*onepole_gain_meter)(const float* pIn, float* pOut, size_t n, float alpha, float gain, float* state, TOVAL_MeterAccum* meter);
+
+    // Folds pIn into *meter, for paths with no kernel of their own to fuse into
+    void (*meter)(const float* pIn, size_t n, TOVAL_MeterAccum* meter);
+
+    // Fixed point to float, sample / full scale. pIn is this channel's first sample and stride the distance
+    // to its next one, in samples (1 planar, the channel count interleaved).
+    void (*pcm_to_float)(const void* pIn, size_t stride, float* pOut, size_t n, TOVAL_PcmFormat format);
+
+    // Float to fixed point: x * full scale plus pDither[i] (in LSBs, nullptr for none), rounded to nearest
+    // and saturated to the format's range. pOut and stride as for pcm_to_float.
+    void (*float_to_pcm)(const float* pIn, const float* pDither, void* pOut, size_t stride, size_t n, TOVAL_PcmFormat format);
+};
+
+// Best table at or below requested that this CPU runs, AUTO means the best overall
+const TOVAL_Kernels& kernels_select(TOVAL_KernelIsa requested);
+
+// Highest ISA kernels_select can hand out on this machine
+TOVAL_KernelIsa kernels_best_supported();
+
+// Variant tables, nullptr when the variant is not compiled into this build. Use kernels_select.
+const TOVAL_Kernels* kernels_generic();
+const TOVAL_Kernels* kernels_avx2();
+const TOVAL_Kernels* kernels_avx512();
+
+#endif // KERNELS_H
@@ -0,0 +1,65 @@
+#ifndef LRCROSSOVER_H
+#define LRCROSSOVER_H
+
+#include <cstdint>
+#include <span>
+
+#include "BiquadDesign.h"
+#include "Kernels.h"
+#include "TOVALarena.h"
+#include "TOVALaudio.h"
+
+/*
+    Linkwitz-Riley 4th order crossover, 2 to MAX_BANDS phase coherent bands per channel.
+
+    Rather than a tree of splits, every band is its own cascade fed straight from the input. With
+    crossovers f0 < f1 < ... band k runs, for each crossover j:
+        j < k   highpass  (LR4 = Butterworth biquad twice)
+        j == k  lowpass
+        j > k   allpass   (LP4 + HP4 of that crossover, one 2nd order allpass)
+    which is the textbook tree with allpass compensation on the lower bands, so the bands still sum to
+    an allpass. Every band then has the same number of biquads and the bands are independent, so
+    biquad_lanes runs them side by side in SIMD lanes: one register per stage covers all the bands
+    (two SSE/NEON passes or one AVX pass for five bands) instead of one cascade after another.
+
+    Coefficients and state are carved from the arena in lrcrossover_init, split never allocates. The
+    section designs come from the process wide BiquadCache, so instances on the same preset share them.
+*/
+
+class LRCrossover {
+
+    public:
+
+    static constexpr uint32_t MAX_BANDS = 5;
+    static constexpr size_t LANES = TOVAL_KERNEL_LANES;
+    static constexpr size_t MAX_STAGES = 2 * (MAX_BANDS - 1);      // two biquads per crossover
+    static_assert(MAX_BANDS <= LANES, "one lane per band");
+
+    TOVAL_ERROR lrcrossover_init(float sample_rate, uint16_t num_channels, TOVAL_Arena& arena);
+    void lrcrossover_reset();
+
+    // num_bands - 1 ascending crossover frequencies in Hz. Recomputes coefficients, filter state is kept.
+    TOVAL_ERROR set_bands(uint32_t num_bands, const float* frequencies);
+
+    // n frames of channel ch into pBands, interleaved pBands[i * LANES + band], 64 byte aligned.
+    // Lanes at or above bands() are zero.
+    void split(uint16_t ch, const float* pIn, float* pBands, size_t n);
+
+    uint32_t bands() const { return num_bands; }
+    void set_kernels(const TOVAL_Kernels& table);
+
+    private:
+
+    void set_stage(size_t stage, size_t lane, const BiquadCoeffs& design);
+
+    float sample_rate = 48000.0f;
+    uint16_t num_channels = 0;
+    uint32_t num_bands = 0;
+    size_t num_stages = 0;
+    const TOVAL_Kernels* kernels = nullptr;
+
+    std::span<float> coeffs;    // MAX_STAGES x (b0 b1 b2 a1 a2) x LANES
+    std::span<float> state;     // num_channels x MAX_STAGES x (z1 z2) x LANES
+};
+
+#endif // LRCROSSOVER_H
@@ -0,0 +1,65 @@
+#ifndef PCMCONVERTER_H
+#define PCMCONVERTER_H
+
+#include <cstdint>
+#include <span>
+
+#include "AudioBuffer.h"
+#include "Kernels.h"
+#include "TOVALarena.h"
+#include "TOVALaudio.h"
+
+/*
+    Fixed point host buffers to and from planar float.
+
+    Reading is one pcm_to_float kernel call per channel. Writing requantises per TOVAL_Dither: NONE goes
+    straight to float_to_pcm, TPDF fills CHUNK frames of triangular noise (two uniform 16 bit draws per
+    sample) and hands it to the kernel while it is still in L1, TPDF_SHAPED runs the error feedback
+    recursion per sample into scratch, then lets the kernel saturate and pack. The shaping filter is
+    (1 - z^-1)^2: no noise at DC, +12 dB at Nyquist, about 7 dB more noise overall than plain TPDF but
+    far less where the ear is most sensitive. Dither and shaping history are per instance and reseeded
+    by pcm_reset, so a render is repeatable.
+
+    Planar hosts pass one pointer per channel, interleaved hosts pass a single pointer whose frames hold
+    the view's channel count. first_frame indexes into the host buffers. Scratch comes from the arena.
+*/
+
+class PcmConverter {
+
+    public:
+
+    static constexpr size_t CHUNK = 256;
+
+    TOVAL_ERROR pcm_init(uint16_t num_channels, TOVAL_Arena& arena);
+    void pcm_reset();
+
+    void set_kernels(const TOVAL_Kernels& table);     // init picks the best for this CPU
+    void set_dither(TOVAL_Dither mode) { dither = mode; }
+    TOVAL_Dither get_dither() const { return dither; }
+
+    // ppIn frames [first_frame, first_frame + out frames) into out
+    TOVAL_ERROR to_float(const void* const* ppIn, size_t first_frame, TOVAL_PcmFormat format, TOVAL_PcmLayout layout, const AudioBlockView& out);
+
+    // in into ppOut frames [first_frame, first_frame + in frames), in's channel count must not exceed init's
+    TOVAL_ERROR from_float(const AudioBlockView& in, TOVAL_PcmFormat format, TOVAL_PcmLayout layout, void* const* ppOut, size_t first_frame);
+
+    static size_t sample_bytes(TOVAL_PcmFormat format);
+
+    private:
+
+    TOVAL_ERROR check(const void* const* pp, TOVAL_PcmFormat format, TOVAL_PcmLayout layout, uint16_t channels_used) const;
+
+    void fill_tpdf(float* pOut, size_t n);
+    void shape(const float* pIn, const float* pDither, float* pOut, size_t n, float full_scale, float* error);
+
+    const TOVAL_Kernels* kernels = nullptr;
+    TOVAL_Dither dither = TOVAL_Dither::DITHER_NONE;
+    uint16_t num_channels = 0;
+    uint64_t rng = 0;
+
+    std::span<float> noise;         // CHUNK frames of dither, LSBs
+    std::span<float> shaped;        // CHUNK frames of shaped, already rounded output
+    std::span<float> error;         // 2 per channel, the last two requantisation errors
+};
+
+#endif // PCMCONVERTER_H
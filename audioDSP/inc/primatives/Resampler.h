@@ -0,0 +1,63 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <cstdint>
+#include <span>
+
+#include "AudioBuffer.h"
+#include "Kernels.h"
+#include "TOVALarena.h"
+#include "TOVALaudio.h"
+
+/*
+    Streaming polyphase sample rate converter for rational ratios L/M (e.g. 44.1k -> 48k is 160/147).
+
+    The prototype lowpass is a Kaiser windowed sinc, split into L phases of taps_per_phase coefficients.
+    Each phase is stored reversed so every output is one contiguous dot product over the input history,
+    which is where the SIMD goes. Buffers are carved from the arena in resampler_init for max_block
+    input frames, resampler_process never allocates.
+*/
+
+class Resampler {
+
+    public:
+
+    TOVAL_ERROR resampler_init(uint32_t in_rate, uint32_t out_rate, uint16_t num_channels, size_t max_block, TOVAL_SrcQuality quality, TOVAL_Arena& arena);
+    void resampler_reset();
+
+    // Clears the history and takes leader's position, so from here on both produce the same frame count
+    // per block. For a stream that joins part way, e.g. a sidechain next to the main input.
+    void resampler_follow(const Resampler& leader);
+
+    // Streams nIn frames through the filter, returns the number of frames written to ppOut
+    size_t resampler_process(float **ppIn, size_t nIn, float **ppOut);
+    size_t resampler_process(const AudioBlockView& in, const AudioBlockView& out);     // out must hold max_output(in frames)
+
+    size_t max_output(size_t nIn) const;    // upper bound on frames produced for nIn input frames
+    uint32_t latency() const;                // filter group delay in output samples
+    uint32_t history_length() const { return taps_per_phase; }     // input samples each output depends on
+
+    uint32_t up_factor() const   { return L; }
+    uint32_t down_factor() const { return M; }
+
+    void set_kernels(const TOVAL_Kernels& table);     // init picks the best for this CPU
+
+    private:
+
+    uint32_t L = 1;             // interpolation factor
+    uint32_t M = 1;             // decimation factor
+    uint32_t taps_per_phase = 0;
+    uint16_t num_channels = 0;
+    size_t max_block = 0;
+    const TOVAL_Kernels* kernels = nullptr;
+
+    std::span<float> coeffs;    // L phases * taps_per_phase, each phase reversed
+
+    // Per channel history: (taps_per_phase - 1) samples from the previous block followed by the new block
+    std::span<std::span<float>> history;
+
+    uint32_t phase = 0;         // sub-sample position of the next output, in 1/L input samples
+    size_t index = 0;           // history index of the newest input sample used by the next output
+};
+
+#endif // RESAMPLER_H
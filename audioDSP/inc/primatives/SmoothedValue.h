@@ -0,0 +1,47 @@
+#ifndef SMOOTHEDVALUE_H
+#define SMOOTHEDVALUE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+    Linear parameter ramp, the control side of a ControlRate.
+
+    set_target starts a ramp of ramp_ms from the current value, stepping by a constant amount. The ramp
+    has a fixed length and lands exactly on the target, after which is_smoothing() is false and callers
+    take their constant value path. It produces no audio rate values itself: the owner advances it with
+    skip() once per control tick and hands get_current() to ControlRate, which interpolates in between.
+*/
+
+class SmoothedValue {
+
+    public:
+
+    void smoothed_init(float sample_rate, float ramp_ms, float initial);
+    void set_ramp_time(float ramp_ms);
+
+    void set_target(float new_target);
+    void set_immediate(float value);     // jump without a ramp
+
+    bool is_smoothing() const { return remaining > 0; }
+    float get_current() const { return current; }
+    float get_target() const { return target; }
+    float get_ramp_ms() const { return ramp_ms; }
+    uint32_t get_remaining() const { return remaining; }
+
+    // Advances the ramp by n samples
+    void skip(size_t n);
+
+    private:
+
+    float sample_rate = 48000.0f;
+    float ramp_ms = 0.0f;
+    uint32_t ramp_samples = 0;
+
+    float current = 0.0f;
+    float target = 0.0f;
+    float step = 0.0f;              // increment per sample
+    uint32_t remaining = 0;
+};
+
+#endif // SMOOTHEDVALUE_H
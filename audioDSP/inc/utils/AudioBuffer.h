@@ -0,0 +1,105 @@
+#ifndef AUDIOBUFFER_H
+#define AUDIOBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "TOVALarena.h"
+#include "TOVALaudio.h"
+
+/*
+    Planar audio containers.
+
+    AudioBlockView is a non-owning window: a channel pointer table, a frame offset into every channel
+    and a frame count. Slicing only moves the offset, so sub-blocks (event splits, chunked renders)
+    never rebuild pointer arrays. It wraps host float** as well as AudioBuffer storage.
+
+    AudioBuffer owns aligned planar storage. Every channel starts on a 64 byte boundary and the channel
+    stride is padded to a whole number of cache lines (plus one more when it would land on a 4 KiB
+    multiple, so channels do not alias in the cache). Views of an AudioBuffer, and slices of them taken at
+    multiples of ALIGN_FRAMES, report is_aligned() and kernels may use aligned SIMD loads on them.
+*/
+
+class AudioBlockView {
+
+    public:
+
+    static constexpr size_t ALIGN_FRAMES = TOVAL_Arena::ALIGNMENT / sizeof(float);    // 16
+
+    AudioBlockView() = default;
+    AudioBlockView(float* const* channels, uint16_t num_channels, size_t num_frames, size_t offset = 0, bool aligned = false)
+        : channels(channels), offset(offset), frames(num_frames), num_ch(num_channels), aligned(aligned) {}
+
+    float* channel(uint16_t ch) const { return channels[ch] + offset; }
+    float* operator[](uint16_t ch) const { return channel(ch); }
+
+    uint16_t num_channels() const { return num_ch; }
+    size_t num_frames() const { return frames; }
+    bool empty() const { return frames == 0 || num_ch == 0; }
+    bool is_aligned() const { return aligned; }
+
+    // Frames [start, start + count) of every channel
+    AudioBlockView slice(size_t start, size_t count) const
+    {
+        return AudioBlockView(channels, num_ch, count, offset + start, aligned && (start % ALIGN_FRAMES) == 0);
+    }
+    AudioBlockView first(size_t count) const { return slice(0, count); }
+
+    // Channels [first_channel, first_channel + count), same frames
+    AudioBlockView channel_range(uint16_t first_channel, uint16_t count) const
+    {
+        return AudioBlockView(channels + first_channel, count, frames, offset, aligned);
+    }
+
+    // Pointer table for the float** entry points, only valid when offset is 0
+    float* const* raw() const { return channels; }
+    size_t frame_offset() const { return offset; }
+
+    private:
+
+    float* const* channels = nullptr;
+    size_t offset = 0;
+    size_t frames = 0;
+    uint16_t num_ch = 0;
+    bool aligned = false;
+};
+
+class AudioBuffer {
+
+    public:
+
+    AudioBuffer() = default;
+    AudioBuffer(const AudioBuffer&) = delete;
+    AudioBuffer& operator=(const AudioBuffer&) = delete;
+
+    // Storage from arena, or from the buffer's own heap arena when none is given. Zeroed.
+    TOVAL_ERROR audiobuffer_init(uint16_t num_channels, size_t num_frames, TOVAL_Arena& arena);
+    TOVAL_ERROR audiobuffer_init(uint16_t num_channels, size_t num_frames);
+
+    void clear();
+
+    AudioBlockView view() const { return AudioBlockView(pointers.data(), num_ch, frames, 0, true); }
+    operator AudioBlockView() const { return view(); }
+
+    float* channel(uint16_t ch) const { return pointers[ch]; }
+    float* operator[](uint16_t ch) const { return pointers[ch]; }
+    float* const* data() const { return pointers.data(); }
+
+    uint16_t num_channels() const { return num_ch; }
+    size_t num_frames() const { return frames; }
+    size_t stride() const { return channel_stride; }
+
+    static size_t padded_stride(size_t num_frames);
+
+    private:
+
+    TOVAL_Arena own;
+    std::span<float> storage;
+    std::span<float*> pointers;
+    size_t frames = 0;
+    size_t channel_stride = 0;
+    uint16_t num_ch = 0;
+};
+
+#endif // AUDIOBUFFER_H
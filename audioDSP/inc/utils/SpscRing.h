@@ -0,0 +1,57 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstdint>
+#include <span>
+
+#include "AudioBuffer.h"
+#include "TOVALarena.h"
+#include "TOVALaudio.h"
+
+/*
+    Lock-free single producer / single consumer ring of planar audio frames.
+
+    One thread writes, one thread reads. Positions are free running counters, the capacity is a power of
+    two so the storage index is a mask. Each side only stores its own counter (release) and loads the
+    other side's (acquire), so no locks or compare-exchange are needed. The counters sit on separate
+    cache lines so producer and consumer do not false share.
+
+    Storage is allocated in spsc_init (from the given arena, or the ring's own heap arena), push and pop
+    never allocate.
+*/
+
+class SpscRing {
+
+    public:
+
+    TOVAL_ERROR spsc_init(uint16_t num_channels, size_t min_capacity, TOVAL_Arena& arena);
+    TOVAL_ERROR spsc_init(uint16_t num_channels, size_t min_capacity);
+    void spsc_reset();      // only when neither side is running
+
+    // Producer side. Returns frames actually written (less than n when full).
+    size_t push(const float* const* ppIn, size_t n, size_t offset = 0);
+    size_t push(const AudioBlockView& block);
+    size_t push_silence(size_t n);
+
+    // Consumer side. Returns frames actually read (less than n when empty).
+    size_t pop(float **ppOut, size_t n, size_t offset = 0);
+
+    size_t readable() const;
+    size_t writable() const;
+    size_t capacity() const { return mask + 1; }
+
+    private:
+
+    size_t push_channels(const float* const* ppIn, uint16_t channels, size_t n, size_t offset);
+
+    alignas(64) std::atomic<size_t> write_count{0};
+    alignas(64) std::atomic<size_t> read_count{0};
+
+    alignas(64) size_t mask = 0;
+    uint16_t num_channels = 0;
+    TOVAL_Arena own;
+    std::span<float> storage;       // num_channels x capacity
+};
+
+#endif // SPSCRING_H
@@ -0,0 +1,93 @@
+#ifndef TOVALARENA_H
+#define TOVALARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <type_traits>
+
+/*
+    Bump allocator for everything an effect instance owns.
+
+    FIXED carves allocations out of one caller provided block and never touches the heap.
+    HEAP gives every allocation its own aligned heap block (freed by arena_release / rewind), which is
+    what a plain `new TOVAL_Effect` uses. Both modes count required() the same way, so running an init in
+    HEAP mode tells you exactly how big a FIXED block has to be.
+
+    Init code allocates everything first, checks failed(), then fills the memory. A FIXED arena that
+    runs out hands back empty spans and latches failed() rather than throwing.
+
+    Allocations are ALIGNMENT aligned (a cache line, enough for any SIMD load) and value initialised.
+    Only trivially destructible types go in spans, nothing is destroyed on release.
+*/
+
+class TOVAL_Arena {
+
+    public:
+
+    static constexpr size_t ALIGNMENT = 64;
+
+    TOVAL_Arena() = default;
+    ~TOVAL_Arena() { arena_release(); }
+
+    TOVAL_Arena(const TOVAL_Arena&) = delete;
+    TOVAL_Arena& operator=(const TOVAL_Arena&) = delete;
+
+    void arena_init_heap();
+    bool arena_init_fixed(void* base, size_t size);     // false when base is not ALIGNMENT aligned
+    void arena_release();
+
+    void* alloc_bytes(size_t bytes);
+
+    template <typename T>
+    std::span<T> alloc(size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "arena memory is never destroyed");
+        static_assert(alignof(T) <= ALIGNMENT, "over aligned type");
+        if (count == 0)
+        {
+            return {};
+        }
+        void* p = alloc_bytes(count * sizeof(T));
+        if (p == nullptr)
+        {
+            return {};
+        }
+        T* data = new (p) T[count]();
+        return { data, count };
+    }
+
+    // Everything allocated after mark() is handed back by rewind(mark), so an init can be run again
+    size_t mark() const { return used; }
+    void rewind(size_t mark);
+
+    size_t required() const { return used; }    // bytes a FIXED arena needs for what was allocated so far
+    bool failed() const { return out_of_memory; }
+    bool is_fixed() const { return mode == Mode::FIXED; }
+
+    static constexpr size_t align_up(size_t bytes) { return (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+    private:
+
+    enum class Mode : uint8_t {
+        NONE,
+        HEAP,
+        FIXED
+    };
+
+    // HEAP blocks form a stack, newest first
+    struct HeapBlock {
+        HeapBlock* next;
+        size_t offset;      // used before this allocation
+    };
+
+    Mode mode = Mode::NONE;
+    uint8_t* base = nullptr;
+    size_t size = 0;
+    size_t used = 0;
+    bool out_of_memory = false;
+    HeapBlock* blocks = nullptr;
+};
+
+#endif // TOVALARENA_H
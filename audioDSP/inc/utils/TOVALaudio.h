@@ -9,6 +9,14 @@
 #define TOVAL_VERSION_MINOR 0
 #define TOVAL_VERSION_PATCH 0
 
+// Limits used to size internal buffers at init, so nothing is allocated in the process call
+#define TOVAL_MAX_BLOCK_SIZE 8192
+#define TOVAL_MAX_CHANNELS   128
+
+// State counts as settled once its contribution is below this (-100 dB, under the 16 bit output LSB)
+#define TOVAL_SETTLE_LEVEL   1.0e-5f
+#define TOVAL_SETTLE_NEVER   0xFFFFFFFFu     // free running state (e.g. an LFO) that never converges
+
 enum class TOVAL_ERROR : std::uint32_t {
     NO_ERROR = 0,
     SIZE_ERROR,
@@ -18,7 +26,19 @@ enum class TOVAL_ERROR : std::uint32_t {
     PARAMETER_ERROR,
     NULL_POINTER_ERROR,
     INPUT_WAV_ERROR,
-    OUTPUT_WAV_ERROR
+    OUTPUT_WAV_ERROR,
+    MEMORY_ERROR            // caller provided arena too small or misaligned
+};
+
+// Timestamped parameter change for TOVAL_Effect_process_events. Every parameter value is 4 bytes.
+struct TOVAL_ParamEvent {
+    uint32_t sample_offset;     // frame within the block where the new value takes effect
+    uint16_t moduleID;
+    uint16_t paramID;
+    union {
+        float f32;
+        uint32_t u32;
+    } value;
 };
 
 // ----------- Modules ------------
@@ -26,18 +46,188 @@ enum TOVAL_Module : uint16_t {
     GLOBAL = 0,
     MODULE_FIRST = 1,
     HEADROOM = MODULE_FIRST,
+    DELAY,
+    CROSSOVER,
+    COMPRESSOR,
+    ANALYZER,
+    REVERB,
+    FIR,
     MODULE_COUNT  // always last
 };
 
 // ---------- Global Params ---------
 enum TOVAL_GlobalParam : uint16_t {
-    GLOBAL_ENABLE = 0
+    GLOBAL_ENABLE = 0,
+    GLOBAL_ASYNC_LATENCY,       // get only, uint32_t frames added by async mode
+    GLOBAL_ASYNC_UNDERRUNS,     // get only, uint32_t blocks the worker could not deliver in time
+    GLOBAL_SETTLING_TIME,       // get only, uint32_t host rate frames until a fresh instance matches a running one
+    GLOBAL_KERNEL_ISA,          // uint32_t, TOVAL_KernelIsa. AUTO picks the best the CPU supports, others force a variant
+    GLOBAL_KERNEL_ACTIVE,       // get only, uint32_t TOVAL_KernelIsa the DSP kernels are running
+    GLOBAL_DITHER               // uint32_t, TOVAL_Dither applied by TOVAL_Effect_process_pcm on the way out
 };
 
 // ---------- Headroom Params -------
 enum TOVAL_HeadroomParam : uint16_t {
     HR_ENABLE = 0,
-    HR_GAIN
+    HR_GAIN,            // float, dB. Ramped over HR_RAMP_TIME
+    HR_RAMP_TIME,       // float, ms
+    HR_METER            // get only, TOVAL_Meter of the headroom output
+};
+
+// ---------- Delay Params ----------
+enum TOVAL_DelayParam : uint16_t {
+    DL_ENABLE = 0,
+    DL_TIME,            // float, ms
+    DL_FEEDBACK,        // float, 0 .. <1
+    DL_MIX,             // float, 0 dry .. 1 wet
+    DL_MOD_DEPTH,       // float, ms
+    DL_MOD_RATE,        // float, Hz
+    DL_INTERPOLATION    // uint32_t, TOVAL_DelayInterp
+};
+
+enum TOVAL_DelayInterp : uint32_t {
+    DL_INTERP_LINEAR = 0,
+    DL_INTERP_CUBIC
+};
+
+// ---------- Crossover Params ------
+enum TOVAL_CrossoverParam : uint16_t {
+    XO_ENABLE = 0,
+    XO_NUM_BANDS,       // uint32_t, 2 .. 5
+    XO_FREQ_1,          // float, Hz. Crossover points, sorted before use so any order works
+    XO_FREQ_2,
+    XO_FREQ_3,
+    XO_FREQ_4,
+    XO_GAIN_1,          // float, dB per band, lowest band first
+    XO_GAIN_2,
+    XO_GAIN_3,
+    XO_GAIN_4,
+    XO_GAIN_5
+};
+
+// ---------- Compressor Params -----
+enum TOVAL_CompressorParam : uint16_t {
+    CP_ENABLE = 0,
+    CP_MODE,            // uint32_t, TOVAL_CompressorMode
+    CP_THRESHOLD,       // float, dB
+    CP_RATIO,           // float, 1 .. 20 (compressor 1:ratio above threshold, expander ratio:1 below)
+    CP_KNEE,            // float, dB width, centred on the threshold
+    CP_ATTACK,          // float, ms
+    CP_RELEASE,         // float, ms
+    CP_MAKEUP,          // float, dB
+    CP_RANGE,           // float, dB. Most gain reduction applied
+    CP_LINK,            // uint32_t, 1 = one gain for all channels from the loudest
+    CP_SIDECHAIN        // uint32_t, 1 = detect on the sidechain passed to TOVAL_Effect_process
+};
+
+enum TOVAL_CompressorMode : uint32_t {
+    CP_MODE_COMPRESS = 0,   // downward compression above threshold
+    CP_MODE_EXPAND          // downward expansion below threshold
+};
+
+// ---------- Analyzer Params -------
+enum TOVAL_AnalyzerParam : uint16_t {
+    AN_ENABLE = 0,
+    AN_TAP_POINT,       // uint32_t, TOVAL_AnalyzerTap
+    AN_FFT_SIZE,        // uint32_t, power of two 256 .. 4096
+    AN_RATE,            // float, spectra per second
+    AN_SPECTRUM,        // get only, TOVAL_Spectrum. Needs TOVAL_Effect_analyze running somewhere
+    AN_SEQUENCE         // get only, uint32_t sequence of the newest spectrum, 0 before the first
+};
+
+enum TOVAL_AnalyzerTap : uint32_t {
+    AN_TAP_INPUT = 0,
+    AN_TAP_POST_HEADROOM,
+    AN_TAP_POST_COMPRESSOR,
+    AN_TAP_POST_CROSSOVER,
+    AN_TAP_OUTPUT
+};
+
+// ---------- Reverb Params ---------
+enum TOVAL_ReverbParam : uint16_t {
+    RV_ENABLE = 0,
+    RV_DECAY,           // float, seconds to -60 dB at low frequencies
+    RV_SIZE,            // float, 0 .. 1, scales the delay line lengths
+    RV_DAMPING,         // float, 0 .. 1, how much faster the highs decay
+    RV_WET,             // float, 0 .. 1, reverb added on top of the dry signal
+    RV_DENSITY          // uint32_t, TOVAL_ReverbDensity
+};
+
+enum TOVAL_ReverbDensity : uint32_t {
+    RV_DENSITY_8 = 0,       // 8 delay lines
+    RV_DENSITY_16           // 16 delay lines, smoother tail for about twice the cost
+};
+
+// ---------- FIR Params ---------
+enum TOVAL_FirParam : uint16_t {
+    FR_ENABLE = 0,
+    FR_TYPE,            // uint32_t, TOVAL_FirType
+    FR_TAPS,            // uint32_t, 8 .. 256, filter length
+    FR_CUTOFF,          // float, Hz, LOWPASS and HIGHPASS corner, clamped below Nyquist
+    FR_FRACTION         // float, 0 .. 1, FRACTIONAL_DELAY sub sample delay on top of (FR_TAPS - 1) / 2
+};
+
+enum TOVAL_FirType : uint32_t {
+    FR_TYPE_LOWPASS = 0,
+    FR_TYPE_HIGHPASS,
+    FR_TYPE_HALFBAND,           // lowpass at a quarter of the sample rate, FR_CUTOFF unused
+    FR_TYPE_FRACTIONAL_DELAY,
+    FR_TYPE_DC_BLOCK            // notches DC and multiples of fs / FR_TAPS
+};
+
+// HR_METER value, refreshed every block. Peak and rms cover every frame since the previous read, so a
+// slow reader still sees the loudest sample.
+inline constexpr uint32_t TOVAL_METER_CHANNELS = 2;
+
+struct TOVAL_Meter {
+    uint32_t sequence;                          // blocks metered, 0 before the first
+    uint32_t frames;                            // frames peak and rms cover
+    float peak[TOVAL_METER_CHANNELS];           // linear, largest |x|
+    float rms[TOVAL_METER_CHANNELS];            // linear
+    uint32_t clips[TOVAL_METER_CHANNELS];       // samples at or above full scale since init
+};
+
+// AN_SPECTRUM value. Left and right are summed to mono, a full scale sine reads 0 dB at its bin.
+inline constexpr uint32_t TOVAL_SPECTRUM_MAX_BINS = 2049;
+
+struct TOVAL_Spectrum {
+    uint32_t bins;                                  // fft size / 2 + 1, DC .. Nyquist. Later entries are unused
+    uint32_t sequence;                              // 0 until the first spectrum is published
+    float magnitude_db[TOVAL_SPECTRUM_MAX_BINS];
+};
+
+// ---------- Sample rate converter quality (Config.src_quality) -------
+enum TOVAL_SrcQuality : uint16_t {
+    SRC_QUALITY_LOW = 0,    // 16 taps per phase
+    SRC_QUALITY_MEDIUM,     // 32 taps per phase
+    SRC_QUALITY_HIGH        // 64 taps per phase
+};
+
+// ---------- DSP kernel instruction set (GLOBAL_KERNEL_ISA) -------
+enum TOVAL_KernelIsa : uint32_t {
+    KERNEL_ISA_AUTO = 0,    // best variant this CPU runs
+    KERNEL_ISA_GENERIC,     // build baseline (SSE2 / NEON / scalar)
+    KERNEL_ISA_AVX2,        // AVX2 + FMA
+    KERNEL_ISA_AVX512       // AVX-512F
+};
+
+// ---------- Fixed point sample formats (TOVAL_Effect_process_pcm, PcmConverter) -------
+enum TOVAL_PcmFormat : uint32_t {
+    PCM_INT16 = 0,          // int16_t, full scale 2^15
+    PCM_INT24,              // 3 byte little endian, packed, full scale 2^23
+    PCM_INT32               // int32_t, full scale 2^31
+};
+
+enum TOVAL_PcmLayout : uint32_t {
+    PCM_PLANAR = 0,         // one buffer per channel
+    PCM_INTERLEAVED         // one buffer, frames of all channels
+};
+
+// Float to fixed point requantisation (GLOBAL_DITHER)
+enum TOVAL_Dither : uint32_t {
+    DITHER_NONE = 0,        // round to nearest, the error follows the signal
+    DITHER_TPDF,            // +-1 LSB triangular dither, error is flat noise
+    DITHER_TPDF_SHAPED      // TPDF through second order error feedback, noise moved up towards Nyquist
 };
 
 #endif // TOVALAUDIO_H
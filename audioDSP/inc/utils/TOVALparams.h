@@ -0,0 +1,256 @@
+#ifndef TOVALPARAMS_H
+#define TOVALPARAMS_H
+
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+#include "TOVALaudio.h"
+
+/*
+    Parameter descriptor table.
+
+    One row per (module, param). The effect validates and dispatches sets from it, module setters read
+    their value through TOVAL_param_read against the same row, the test harness resolves JSON names from
+    it, so IDs, types and ranges are only written down here. Rows are grouped
+    by module in TOVAL_Module order with paramIDs running 0, 1, 2... inside each module, which is what
+    makes TOVAL_param_index a two array lookup. The static_asserts below catch a row added out of order.
+
+    Every value is 4 bytes: U32 for enables, counts and enums, F32 for everything else. The one exception
+    is BLOB, a read only struct copied out whole by TOVAL_Effect_get (size is its sizeof). flags add checks
+    a min / max range can't express.
+*/
+
+enum class TOVAL_ParamType : uint8_t {
+    U32,
+    F32,
+    BLOB
+};
+
+enum class TOVAL_ParamAccess : uint8_t {
+    READ_WRITE,
+    READ_ONLY       // status values produced by the effect, set returns PARAMID_ERROR
+};
+
+// TOVAL_ParamDescriptor::flags
+enum TOVAL_ParamFlag : uint8_t {
+    TOVAL_PARAM_NO_FLAGS = 0,
+    TOVAL_PARAM_POW2 = 1 << 0       // U32 only, value must be a power of two
+};
+
+struct TOVAL_ParamDescriptor {
+    uint16_t moduleID;
+    uint16_t paramID;
+    const char* module_name;
+    const char* param_name;
+    TOVAL_ParamType type;
+    TOVAL_ParamAccess access;
+    uint16_t size;
+    float min;
+    float max;
+    float def;
+    uint8_t flags;          // TOVAL_ParamFlag bits
+};
+
+// Value for TOVAL_Effect_set_batch / TOVAL_Effect_get_batch
+struct TOVAL_ParamSet {
+    uint16_t moduleID;
+    uint16_t paramID;
+    union {
+        float f32;
+        uint32_t u32;
+    } value;
+};
+
+#define TOVAL_PARAM_U32(m, p, mn, pn, lo, hi, d)        { m, p, mn, pn, TOVAL_ParamType::U32, TOVAL_ParamAccess::READ_WRITE, 4, lo, hi, d, TOVAL_PARAM_NO_FLAGS }
+#define TOVAL_PARAM_U32_POW2(m, p, mn, pn, lo, hi, d)   { m, p, mn, pn, TOVAL_ParamType::U32, TOVAL_ParamAccess::READ_WRITE, 4, lo, hi, d, TOVAL_PARAM_POW2 }
+#define TOVAL_PARAM_F32(m, p, mn, pn, lo, hi, d)        { m, p, mn, pn, TOVAL_ParamType::F32, TOVAL_ParamAccess::READ_WRITE, 4, lo, hi, d, TOVAL_PARAM_NO_FLAGS }
+#define TOVAL_PARAM_STATUS(m, p, mn, pn)                { m, p, mn, pn, TOVAL_ParamType::U32, TOVAL_ParamAccess::READ_ONLY, 4, 0.0f, 0.0f, 0.0f, TOVAL_PARAM_NO_FLAGS }
+#define TOVAL_PARAM_BLOB(m, p, mn, pn, T)               { m, p, mn, pn, TOVAL_ParamType::BLOB, TOVAL_ParamAccess::READ_ONLY, sizeof(T), 0.0f, 0.0f, 0.0f, TOVAL_PARAM_NO_FLAGS }
+
+inline constexpr TOVAL_ParamDescriptor TOVAL_PARAM_TABLE[] = {
+    // module          param                   module name   param name            min      max      default
+    TOVAL_PARAM_U32   (GLOBAL,   GLOBAL_ENABLE,          "GLOBAL",   "GLOBAL_ENABLE_FLAG", 0.0f,    1.0f,    0.0f),
+    TOVAL_PARAM_STATUS(GLOBAL,   GLOBAL_ASYNC_LATENCY,   "GLOBAL",   "ASYNC_LATENCY"),
+    TOVAL_PARAM_STATUS(GLOBAL,   GLOBAL_ASYNC_UNDERRUNS, "GLOBAL",   "ASYNC_UNDERRUNS"),
+    TOVAL_PARAM_STATUS(GLOBAL,   GLOBAL_SETTLING_TIME,   "GLOBAL",   "SETTLING_TIME"),
+    TOVAL_PARAM_U32   (GLOBAL,   GLOBAL_KERNEL_ISA,      "GLOBAL",   "KERNEL_ISA",         0.0f,    3.0f,    0.0f),
+    TOVAL_PARAM_STATUS(GLOBAL,   GLOBAL_KERNEL_ACTIVE,   "GLOBAL",   "KERNEL_ACTIVE"),
+    TOVAL_PARAM_U32   (GLOBAL,   GLOBAL_DITHER,          "GLOBAL",   "DITHER",             0.0f,    2.0f,    0.0f),
+
+    TOVAL_PARAM_U32   (HEADROOM, HR_ENABLE,              "HEADROOM", "ENABLE",             0.0f,    1.0f,    0.0f),
+    TOVAL_PARAM_F32   (HEADROOM, HR_GAIN,                "HEADROOM", "GAIN",               -96.0f,  24.0f,   0.0f),
+    TOVAL_PARAM_F32   (HEADROOM, HR_RAMP_TIME,           "HEADROOM", "RAMP_TIME",          0.0f,    1000.0f, 20.0f),
+    TOVAL_PARAM_BLOB  (HEADROOM, HR_METER,               "HEADROOM", "METER",              TOVAL_Meter),
+
+    TOVAL_PARAM_U32   (DELAY,    DL_ENABLE,              "DELAY",    "ENABLE",             0.0f,    1.0f,    0.0f),
+    TOVAL_PARAM_F32   (DELAY,    DL_TIME,                "DELAY",    "TIME",               0.0f,    2000.0f, 250.0f),
+    TOVAL_PARAM_F32   (DELAY,    DL_FEEDBACK,            "DELAY",    "FEEDBACK",           0.0f,    0.99f,   0.3f),
+    TOVAL_PARAM_F32   (DELAY,    DL_MIX,                 "DELAY",    "MIX",                0.0f,    1.0f,    0.3f),
+    TOVAL_PARAM_F32   (DELAY,    DL_MOD_DEPTH,           "DELAY",    "MOD_DEPTH",          0.0f,    50.0f,   0.0f),
+    TOVAL_PARAM_F32   (DELAY,    DL_MOD_RATE,            "DELAY",    "MOD_RATE",           0.0f,    20.0f,   0.5f),
+    TOVAL_PARAM_U32   (DELAY,    DL_INTERPOLATION,       "DELAY",    "INTERPOLATION",      0.0f,    1.0f,    0.0f),
+
+    TOVAL_PARAM_U32   (CROSSOVER, XO_ENABLE,             "CROSSOVER", "ENABLE",            0.0f,    1.0f,    0.0f),
+    TOVAL_PARAM_U32   (CROSSOVER, XO_NUM_BANDS,          "CROSSOVER", "NUM_BANDS",         2.0f,    5.0f,    3.0f),
+    TOVAL_PARAM_F32   (CROSSOVER, XO_FREQ_1,             "CROSSOVER", "FREQ_1",            20.0f,   20000.0f, 200.0f),
+    TOVAL_PARAM_F32   (CROSSOVER, XO_FREQ_2,             "CROSSOVER", "FREQ_2",            20.0f,   20000.0f, 2000.0f),
+    TOVAL_PARAM_F32   (CROSSOVER, XO_FREQ_3,             "CROSSOVER", "FREQ_3",            20.0f,   20000.0f, 6000.0f),
+    TOVAL_PARAM_F32   (CROSSOVER, XO_FREQ_4,             "CROSSOVER", "FREQ_4",            20.0f,   20000.0f, 12000.0f),
+    TOVAL_PARAM_F32   (CROSSOVER, XO_GAIN_1,             "CROSSOVER", "GAIN_1",            -24.0f,  24.0f,   0.0f),     // ramped over one 256 frame chunk
+    TOVAL_PARAM_F32   (CROSSOVER, XO_GAIN_2,             "CROSSOVER", "GAIN_2",            -24.0f,  24.0f,   0.0f),
+    TOVAL_PARAM_F32   (CROSSOVER, XO_GAIN_3,             "CROSSOVER", "GAIN_3",            -24.0f,  24.0f,   0.0f),
+    TOVAL_PARAM_F32   (CROSSOVER, XO_GAIN_4,             "CROSSOVER", "GAIN_4",            -24.0f,  24.0f,   0.0f),
+    TOVAL_PARAM_F32   (CROSSOVER, XO_GAIN_5,             "CROSSOVER", "GAIN_5",            -24.0f,  24.0f,   0.0f),
+
+    TOVAL_PARAM_U32   (COMPRESSOR, CP_ENABLE,            "COMPRESSOR", "ENABLE",           0.0f,    1.0f,    0.0f),
+    TOVAL_PARAM_U32   (COMPRESSOR, CP_MODE,              "COMPRESSOR", "MODE",             0.0f,    1.0f,    0.0f),
+    TOVAL_PARAM_F32   (COMPRESSOR, CP_THRESHOLD,         "COMPRESSOR", "THRESHOLD",        -80.0f,  0.0f,    -18.0f),
+    TOVAL_PARAM_F32   (COMPRESSOR, CP_RATIO,             "COMPRESSOR", "RATIO",            1.0f,    20.0f,   4.0f),
+    TOVAL_PARAM_F32   (COMPRESSOR, CP_KNEE,              "COMPRESSOR", "KNEE",             0.0f,    24.0f,   6.0f),
+    TOVAL_PARAM_F32   (COMPRESSOR, CP_ATTACK,            "COMPRESSOR", "ATTACK",           0.05f,   500.0f,  10.0f),
+    TOVAL_PARAM_F32   (COMPRESSOR, CP_RELEASE,           "COMPRESSOR", "RELEASE",          1.0f,    5000.0f, 100.0f),
+    TOVAL_PARAM_F32   (COMPRESSOR, CP_MAKEUP,            "COMPRESSOR", "MAKEUP",           -24.0f,  24.0f,   0.0f),
+    TOVAL_PARAM_F32   (COMPRESSOR, CP_RANGE,             "COMPRESSOR", "RANGE",            0.0f,    96.0f,   60.0f),
+    TOVAL_PARAM_U32   (COMPRESSOR, CP_LINK,              "COMPRESSOR", "LINK",             0.0f,    1.0f,    1.0f),
+    TOVAL_PARAM_U32   (COMPRESSOR, CP_SIDECHAIN,         "COMPRESSOR", "SIDECHAIN",        0.0f,    1.0f,    0.0f),
+
+    TOVAL_PARAM_U32   (ANALYZER, AN_ENABLE,              "ANALYZER",   "ENABLE",           0.0f,    1.0f,    0.0f),
+    TOVAL_PARAM_U32   (ANALYZER, AN_TAP_POINT,           "ANALYZER",   "TAP_POINT",        0.0f,    4.0f,    4.0f),
+    TOVAL_PARAM_U32_POW2(ANALYZER, AN_FFT_SIZE,          "ANALYZER",   "FFT_SIZE",         256.0f,  4096.0f, 2048.0f),
+    TOVAL_PARAM_F32   (ANALYZER, AN_RATE,                "ANALYZER",   "RATE",             1.0f,    60.0f,   20.0f),
+    TOVAL_PARAM_BLOB  (ANALYZER, AN_SPECTRUM,            "ANALYZER",   "SPECTRUM",         TOVAL_Spectrum),
+    TOVAL_PARAM_STATUS(ANALYZER, AN_SEQUENCE,            "ANALYZER",   "SEQUENCE"),
+
+    TOVAL_PARAM_U32   (REVERB,   RV_ENABLE,              "REVERB",     "ENABLE",           0.0f,    1.0f,    0.0f),
+    TOVAL_PARAM_F32   (REVERB,   RV_DECAY,               "REVERB",     "DECAY",            0.1f,    20.0f,   1.5f),
+    TOVAL_PARAM_F32   (REVERB,   RV_SIZE,                "REVERB",     "SIZE",             0.0f,    1.0f,    0.5f),
+    TOVAL_PARAM_F32   (REVERB,   RV_DAMPING,             "REVERB",     "DAMPING",          0.0f,    1.0f,    0.5f),
+    TOVAL_PARAM_F32   (REVERB,   RV_WET,                 "REVERB",     "WET",              0.0f,    1.0f,    0.25f),
+    TOVAL_PARAM_U32   (REVERB,   RV_DENSITY,             "REVERB",     "DENSITY",          0.0f,    1.0f,    0.0f),
+
+    TOVAL_PARAM_U32   (FIR,      FR_ENABLE,              "FIR",        "ENABLE",           0.0f,    1.0f,    0.0f),
+    TOVAL_PARAM_U32   (FIR,      FR_TYPE,                "FIR",        "TYPE",             0.0f,    4.0f,    0.0f),
+    TOVAL_PARAM_U32   (FIR,      FR_TAPS,                "FIR",        "TAPS",             8.0f,    256.0f,  31.0f),
+    TOVAL_PARAM_F32   (FIR,      FR_CUTOFF,              "FIR",        "CUTOFF",           20.0f,   20000.0f, 8000.0f),
+    TOVAL_PARAM_F32   (FIR,      FR_FRACTION,            "FIR",        "FRACTION",         0.0f,    1.0f,    0.0f),
+};
+
+#undef TOVAL_PARAM_U32
+#undef TOVAL_PARAM_U32_POW2
+#undef TOVAL_PARAM_F32
+#undef TOVAL_PARAM_STATUS
+#undef TOVAL_PARAM_BLOB
+
+inline constexpr size_t TOVAL_PARAM_COUNT = std::size(TOVAL_PARAM_TABLE);
+
+// First table row of each module, plus an end marker
+struct TOVAL_ParamModuleIndex {
+    uint16_t first[MODULE_COUNT + 1];
+};
+
+inline constexpr TOVAL_ParamModuleIndex TOVAL_make_param_module_index()
+{
+    TOVAL_ParamModuleIndex index{};
+    size_t row = 0;
+    for (uint16_t module = 0; module < MODULE_COUNT; module++)
+    {
+        index.first[module] = static_cast<uint16_t>(row);
+        while (row < TOVAL_PARAM_COUNT && TOVAL_PARAM_TABLE[row].moduleID == module)
+        {
+            row++;
+        }
+    }
+    index.first[MODULE_COUNT] = static_cast<uint16_t>(row);
+    return index;
+}
+
+inline constexpr TOVAL_ParamModuleIndex TOVAL_PARAM_MODULE_INDEX = TOVAL_make_param_module_index();
+
+// Table row for (moduleID, paramID), or -1 when it does not exist
+inline constexpr int TOVAL_param_index(uint16_t moduleID, uint16_t paramID)
+{
+    if (moduleID >= MODULE_COUNT)
+    {
+        return -1;
+    }
+    const uint16_t first = TOVAL_PARAM_MODULE_INDEX.first[moduleID];
+    const uint16_t count = TOVAL_PARAM_MODULE_INDEX.first[moduleID + 1] - first;
+    return (paramID < count) ? static_cast<int>(first + paramID) : -1;
+}
+
+inline constexpr bool TOVAL_param_table_is_ordered()
+{
+    for (size_t row = 0; row < TOVAL_PARAM_COUNT; row++)
+    {
+        const TOVAL_ParamDescriptor& d = TOVAL_PARAM_TABLE[row];
+        if (TOVAL_param_index(d.moduleID, d.paramID) != static_cast<int>(row) || (d.size != 4 && d.type != TOVAL_ParamType::BLOB)
+            || ((d.flags & TOVAL_PARAM_POW2) && d.type != TOVAL_ParamType::U32))
+        {
+            return false;
+        }
+    }
+    return TOVAL_PARAM_MODULE_INDEX.first[MODULE_COUNT] == TOVAL_PARAM_COUNT;
+}
+
+static_assert(TOVAL_param_table_is_ordered(), "TOVAL_PARAM_TABLE rows must be grouped by module with contiguous paramIDs from 0, POW2 only on U32 rows");
+
+// Row for a (moduleID, paramID) known at compile time, for modules sizing storage from its range
+inline constexpr const TOVAL_ParamDescriptor& TOVAL_param_descriptor(uint16_t moduleID, uint16_t paramID)
+{
+    return TOVAL_PARAM_TABLE[TOVAL_param_index(moduleID, paramID)];
+}
+
+// Size, pointer, range and flags of a value against its row. NaN fails the range.
+inline TOVAL_ERROR TOVAL_param_check(const TOVAL_ParamDescriptor& desc, size_t data_length, const void* data)
+{
+    if (data_length != desc.size)
+    {
+        return TOVAL_ERROR::SIZE_ERROR;
+    }
+    if (data == nullptr)
+    {
+        return TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+
+    uint32_t bits = 0;
+    std::memcpy(&bits, data, sizeof(bits));
+    const float value = (desc.type == TOVAL_ParamType::F32) ? std::bit_cast<float>(bits) : static_cast<float>(bits);
+    if (!(value >= desc.min && value <= desc.max) || ((desc.flags & TOVAL_PARAM_POW2) && !std::has_single_bit(bits)))
+    {
+        return TOVAL_ERROR::PARAMETER_ERROR;
+    }
+    return TOVAL_ERROR::NO_ERROR;
+}
+
+// Module setters read through these, so they refuse exactly what TOVAL_Effect_set refuses. value is only
+// written on NO_ERROR. The row form is for numbered rows picked at run time (XO_FREQ_1 + index).
+template <typename T>
+TOVAL_ERROR TOVAL_param_read(const TOVAL_ParamDescriptor& desc, size_t data_length, const void* data, T& value)
+{
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, uint32_t>, "values are float or uint32_t");
+    if (desc.type != (std::is_same_v<T, float> ? TOVAL_ParamType::F32 : TOVAL_ParamType::U32))
+    {
+        return TOVAL_ERROR::PARAMETER_ERROR;
+    }
+
+    const TOVAL_ERROR ret = TOVAL_param_check(desc, data_length, data);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        std::memcpy(&value, data, sizeof(value));
+    }
+    return ret;
+}
+
+template <uint16_t moduleID, uint16_t paramID, typename T>
+TOVAL_ERROR TOVAL_param_read(size_t data_length, const void* data, T& value)
+{
+    constexpr const TOVAL_ParamDescriptor& desc = TOVAL_param_descriptor(moduleID, paramID);
+    static_assert(desc.type == (std::is_same_v<T, float> ? TOVAL_ParamType::F32 : TOVAL_ParamType::U32), "value must be the row's type");
+    return TOVAL_param_read(desc, data_length, data, value);
+}
+
+#endif // TOVALPARAMS_H
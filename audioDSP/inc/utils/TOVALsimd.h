@@ -0,0 +1,284 @@
+#ifndef TOVALSIMD_H
+#define TOVALSIMD_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/*
+    Thin 4 lane float vector used by the DSP kernels. Maps onto SSE on x86 and NEON on ARM,
+    with a plain scalar fallback so the Arduino toolchain still builds.
+*/
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define TOVAL_SIMD_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define TOVAL_SIMD_NEON 1
+#endif
+
+namespace simd {
+
+constexpr size_t width = 4;
+
+#if defined(TOVAL_SIMD_SSE)
+
+struct f32x4 { __m128 v; };
+
+inline f32x4 load(const float* p)                   { return { _mm_loadu_ps(p) }; }
+inline void  store(float* p, f32x4 a)               { _mm_storeu_ps(p, a.v); }
+inline f32x4 load_aligned(const float* p)           { return { _mm_load_ps(p) }; }     // p on a 16 byte boundary
+inline void  store_aligned(float* p, f32x4 a)       { _mm_store_ps(p, a.v); }
+inline f32x4 set1(float x)                          { return { _mm_set1_ps(x) }; }
+inline f32x4 set(float a, float b, float c, float d){ return { _mm_setr_ps(a, b, c, d) }; }     // lane 0 = a
+inline f32x4 zero()                                 { return { _mm_setzero_ps() }; }
+inline f32x4 add(f32x4 a, f32x4 b)                  { return { _mm_add_ps(a.v, b.v) }; }
+inline f32x4 sub(f32x4 a, f32x4 b)                  { return { _mm_sub_ps(a.v, b.v) }; }
+inline f32x4 mul(f32x4 a, f32x4 b)                  { return { _mm_mul_ps(a.v, b.v) }; }
+inline f32x4 madd(f32x4 a, f32x4 b, f32x4 c)        { return { _mm_add_ps(_mm_mul_ps(a.v, b.v), c.v) }; }   // a * b + c
+
+inline f32x4 min(f32x4 a, f32x4 b)                  { return { _mm_min_ps(a.v, b.v) }; }
+inline f32x4 max(f32x4 a, f32x4 b)                  { return { _mm_max_ps(a.v, b.v) }; }
+inline f32x4 abs(f32x4 a)                           { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+
+inline f32x4 floor(f32x4 a)     // |a| < 2^31
+{
+    const __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+    return { _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a.v), _mm_set1_ps(1.0f))) };
+}
+
+// Bit level pieces of log2 / exp2, for positive normal a and integral n in [-126, 127]
+inline f32x4 exponent(f32x4 a)
+{
+    return { _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(a.v), 23), _mm_set1_epi32(127))) };
+}
+inline f32x4 mantissa(f32x4 a)      // in [1, 2)
+{
+    const __m128i bits = _mm_and_si128(_mm_castps_si128(a.v), _mm_set1_epi32(0x007FFFFF));
+    return { _mm_castsi128_ps(_mm_or_si128(bits, _mm_set1_epi32(0x3F800000))) };
+}
+inline f32x4 pow2i(f32x4 n)
+{
+    return { _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n.v), _mm_set1_epi32(127)), 23)) };
+}
+
+// Butterflies inside one register, the in-register stages of a fast Hadamard transform
+inline f32x4 butterfly_pairs(f32x4 a)      // (a0 + a1, a0 - a1, a2 + a3, a2 - a3)
+{
+    const __m128 swapped = _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(2, 3, 0, 1));
+    return { _mm_add_ps(_mm_xor_ps(a.v, _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f)), swapped) };
+}
+inline f32x4 butterfly_halves(f32x4 a)     // (a0 + a2, a1 + a3, a0 - a2, a1 - a3)
+{
+    const __m128 swapped = _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(1, 0, 3, 2));
+    return { _mm_add_ps(_mm_xor_ps(a.v, _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f)), swapped) };
+}
+
+inline float hsum(f32x4 a)
+{
+    __m128 shuf = _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(a.v, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    return _mm_cvtss_f32(_mm_add_ss(sums, shuf));
+}
+
+inline float hmax(f32x4 a)
+{
+    const __m128 m = _mm_max_ps(a.v, _mm_movehl_ps(a.v, a.v));
+    return _mm_cvtss_f32(_mm_max_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1))));
+}
+
+// 32 bit integer lanes, only what sample format conversion needs
+struct i32x4 { __m128i v; };
+
+inline i32x4 load(const int32_t* p)                 { return { _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)) }; }
+inline void  store(int32_t* p, i32x4 a)             { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), a.v); }
+inline i32x4 to_int(f32x4 a)                        { return { _mm_cvttps_epi32(a.v) }; }     // truncates, |a| < 2^31
+inline f32x4 to_float(i32x4 a)                      { return { _mm_cvtepi32_ps(a.v) }; }
+
+#elif defined(TOVAL_SIMD_NEON)
+
+struct f32x4 { float32x4_t v; };
+
+inline f32x4 load(const float* p)                   { return { vld1q_f32(p) }; }
+inline void  store(float* p, f32x4 a)               { vst1q_f32(p, a.v); }
+inline f32x4 load_aligned(const float* p)           { return load(p); }     // NEON loads do not care
+inline void  store_aligned(float* p, f32x4 a)       { store(p, a); }
+inline f32x4 set1(float x)                          { return { vdupq_n_f32(x) }; }
+inline f32x4 set(float a, float b, float c, float d){ const float v[4] = { a, b, c, d }; return { vld1q_f32(v) }; }
+inline f32x4 zero()                                 { return { vdupq_n_f32(0.0f) }; }
+inline f32x4 add(f32x4 a, f32x4 b)                  { return { vaddq_f32(a.v, b.v) }; }
+inline f32x4 sub(f32x4 a, f32x4 b)                  { return { vsubq_f32(a.v, b.v) }; }
+inline f32x4 mul(f32x4 a, f32x4 b)                  { return { vmulq_f32(a.v, b.v) }; }
+inline f32x4 madd(f32x4 a, f32x4 b, f32x4 c)        { return { vmlaq_f32(c.v, a.v, b.v) }; }
+
+inline f32x4 min(f32x4 a, f32x4 b)                  { return { vminq_f32(a.v, b.v) }; }
+inline f32x4 max(f32x4 a, f32x4 b)                  { return { vmaxq_f32(a.v, b.v) }; }
+inline f32x4 abs(f32x4 a)                           { return { vabsq_f32(a.v) }; }
+
+inline f32x4 floor(f32x4 a)     // |a| < 2^31
+{
+    const float32x4_t t = vcvtq_f32_s32(vcvtq_s32_f32(a.v));
+    const uint32x4_t over = vandq_u32(vcgtq_f32(t, a.v), vreinterpretq_u32_f32(vdupq_n_f32(1.0f)));
+    return { vsubq_f32(t, vreinterpretq_f32_u32(over)) };
+}
+
+inline f32x4 exponent(f32x4 a)
+{
+    const int32x4_t e = vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_f32(a.v), 23));
+    return { vcvtq_f32_s32(vsubq_s32(e, vdupq_n_s32(127))) };
+}
+inline f32x4 mantissa(f32x4 a)
+{
+    const uint32x4_t bits = vandq_u32(vreinterpretq_u32_f32(a.v), vdupq_n_u32(0x007FFFFF));
+    return { vreinterpretq_f32_u32(vorrq_u32(bits, vdupq_n_u32(0x3F800000))) };
+}
+inline f32x4 pow2i(f32x4 n)
+{
+    return { vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n.v), vdupq_n_s32(127)), 23)) };
+}
+
+inline f32x4 butterfly_pairs(f32x4 a)
+{
+    const float32x4_t sums = vaddq_f32(a.v, vrev64q_f32(a.v));
+    const float32x4_t diffs = vsubq_f32(a.v, vrev64q_f32(a.v));
+    return { vtrnq_f32(sums, diffs).val[0] };
+}
+inline f32x4 butterfly_halves(f32x4 a)
+{
+    const float32x2_t lo = vget_low_f32(a.v);
+    const float32x2_t hi = vget_high_f32(a.v);
+    return { vcombine_f32(vadd_f32(lo, hi), vsub_f32(lo, hi)) };
+}
+
+inline float hsum(f32x4 a)
+{
+    float32x2_t r = vadd_f32(vget_low_f32(a.v), vget_high_f32(a.v));
+    return vget_lane_f32(vpadd_f32(r, r), 0);
+}
+
+inline float hmax(f32x4 a)
+{
+    float32x2_t r = vmax_f32(vget_low_f32(a.v), vget_high_f32(a.v));
+    return vget_lane_f32(vpmax_f32(r, r), 0);
+}
+
+struct i32x4 { int32x4_t v; };
+
+inline i32x4 load(const int32_t* p)                 { return { vld1q_s32(p) }; }
+inline void  store(int32_t* p, i32x4 a)             { vst1q_s32(p, a.v); }
+inline i32x4 to_int(f32x4 a)                        { return { vcvtq_s32_f32(a.v) }; }
+inline f32x4 to_float(i32x4 a)                      { return { vcvtq_f32_s32(a.v) }; }
+
+#else
+
+struct f32x4 { float v[4]; };
+
+inline f32x4 load(const float* p)                   { return { { p[0], p[1], p[2], p[3] } }; }
+inline void  store(float* p, f32x4 a)               { for (int i = 0; i < 4; ++i) p[i] = a.v[i]; }
+inline f32x4 load_aligned(const float* p)           { return load(p); }
+inline void  store_aligned(float* p, f32x4 a)       { store(p, a); }
+inline f32x4 set1(float x)                          { return { { x, x, x, x } }; }
+inline f32x4 set(float a, float b, float c, float d){ return { { a, b, c, d } }; }
+inline f32x4 zero()                                 { return set1(0.0f); }
+inline f32x4 add(f32x4 a, f32x4 b)                  { f32x4 r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] + b.v[i]; return r; }
+inline f32x4 sub(f32x4 a, f32x4 b)                  { f32x4 r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] - b.v[i]; return r; }
+inline f32x4 mul(f32x4 a, f32x4 b)                  { f32x4 r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] * b.v[i]; return r; }
+inline f32x4 madd(f32x4 a, f32x4 b, f32x4 c)        { f32x4 r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] * b.v[i] + c.v[i]; return r; }
+inline f32x4 min(f32x4 a, f32x4 b)                  { f32x4 r; for (int i = 0; i < 4; ++i) r.v[i] = b.v[i] < a.v[i] ? b.v[i] : a.v[i]; return r; }
+inline f32x4 max(f32x4 a, f32x4 b)                  { f32x4 r; for (int i = 0; i < 4; ++i) r.v[i] = b.v[i] > a.v[i] ? b.v[i] : a.v[i]; return r; }
+inline f32x4 abs(f32x4 a)                           { f32x4 r; for (int i = 0; i < 4; ++i) r.v[i] = std::fabs(a.v[i]); return r; }
+inline f32x4 floor(f32x4 a)                         { f32x4 r; for (int i = 0; i < 4; ++i) r.v[i] = std::floor(a.v[i]); return r; }
+inline f32x4 exponent(f32x4 a)                      { f32x4 r; for (int i = 0; i < 4; ++i) r.v[i] = static_cast<float>(std::ilogb(a.v[i])); return r; }
+inline f32x4 mantissa(f32x4 a)                      { f32x4 r; for (int i = 0; i < 4; ++i) r.v[i] = std::scalbn(a.v[i], -std::ilogb(a.v[i])); return r; }
+inline f32x4 pow2i(f32x4 n)                         { f32x4 r; for (int i = 0; i < 4; ++i) r.v[i] = std::ldexp(1.0f, static_cast<int>(n.v[i])); return r; }
+inline f32x4 butterfly_pairs(f32x4 a)               { return { { a.v[0] + a.v[1], a.v[0] - a.v[1], a.v[2] + a.v[3], a.v[2] - a.v[3] } }; }
+inline f32x4 butterfly_halves(f32x4 a)              { return { { a.v[0] + a.v[2], a.v[1] + a.v[3], a.v[0] - a.v[2], a.v[1] - a.v[3] } }; }
+inline float hsum(f32x4 a)                          { return (a.v[0] + a.v[1]) + (a.v[2] + a.v[3]); }
+inline float hmax(f32x4 a)                          { return std::fmax(std::fmax(a.v[0], a.v[1]), std::fmax(a.v[2], a.v[3])); }
+
+struct i32x4 { int32_t v[4]; };
+
+inline i32x4 load(const int32_t* p)                 { return { { p[0], p[1], p[2], p[3] } }; }
+inline void  store(int32_t* p, i32x4 a)             { for (int i = 0; i < 4; ++i) p[i] = a.v[i]; }
+inline i32x4 to_int(f32x4 a)                        { i32x4 r; for (int i = 0; i < 4; ++i) r.v[i] = static_cast<int32_t>(a.v[i]); return r; }
+inline f32x4 to_float(i32x4 a)                      { f32x4 r; for (int i = 0; i < 4; ++i) r.v[i] = static_cast<float>(a.v[i]); return r; }
+
+#endif
+
+// Fast log2 for positive normal x, absolute error under 3e-5 (2e-4 dB). Exponent plus a degree 5
+// minimax polynomial for log2 of the mantissa.
+inline f32x4 log2_approx(f32x4 x)
+{
+    const f32x4 t = sub(mantissa(x), set1(1.0f));
+    f32x4 p = set1(0.0413895845f);
+    p = madd(p, t, set1(-0.183840096f));
+    p = madd(p, t, set1(0.406812668f));
+    p = madd(p, t, set1(-0.705899060f));
+    p = madd(p, t, set1(1.44153953f));
+    return madd(p, t, exponent(x));
+}
+
+// Fast 2^x, relative error under 4e-7. Inputs are clamped to [-126, 126] so the result stays normal.
+inline f32x4 exp2_approx(f32x4 x)
+{
+    x = min(max(x, set1(-126.0f)), set1(126.0f));
+    const f32x4 n = floor(x);
+    const f32x4 f = sub(x, n);
+    f32x4 q = set1(0.00185780483f);
+    q = madd(q, f, set1(0.00903264433f));
+    q = madd(q, f, set1(0.0557942614f));
+    q = madd(q, f, set1(0.240162879f));
+    q = madd(q, f, set1(0.693152070f));
+    q = madd(q, f, set1(1.0f));
+    return mul(q, pow2i(n));
+}
+
+// Dot product of two contiguous float arrays. Two accumulators hide the add latency.
+inline float dot(const float* a, const float* b, size_t n)
+{
+    f32x4 acc0 = zero();
+    f32x4 acc1 = zero();
+    size_t i = 0;
+    for (; i + 2 * width <= n; i += 2 * width)
+    {
+        acc0 = madd(load(a + i), load(b + i), acc0);
+        acc1 = madd(load(a + i + width), load(b + i + width), acc1);
+    }
+    for (; i + width <= n; i += width)
+    {
+        acc0 = madd(load(a + i), load(b + i), acc0);
+    }
+    float sum = hsum(add(acc0, acc1));
+    for (; i < n; ++i)
+    {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+// Flush denormals to zero for the lifetime of the scope, restoring the caller's mode after.
+// Recursive filters decaying on silence otherwise run many times slower on x86.
+class FlushDenormals {
+    public:
+#if defined(TOVAL_SIMD_SSE)
+    FlushDenormals() : saved(_mm_getcsr()) { _mm_setcsr(saved | 0x8040); }     // FTZ | DAZ
+    ~FlushDenormals() { _mm_setcsr(saved); }
+    private:
+    unsigned int saved;
+#elif defined(TOVAL_SIMD_NEON) && defined(__aarch64__)
+    FlushDenormals() { __asm__ volatile("mrs %0, fpcr" : "=r"(saved)); __asm__ volatile("msr fpcr, %0" :: "r"(saved | (1ull << 24))); }     // FZ
+    ~FlushDenormals() { __asm__ volatile("msr fpcr, %0" :: "r"(saved)); }
+    private:
+    unsigned long long saved;
+#else
+    FlushDenormals() {}
+#endif
+    FlushDenormals(const FlushDenormals&) = delete;
+    FlushDenormals& operator=(const FlushDenormals&) = delete;
+};
+
+} // namespace simd
+
+#endif // TOVALSIMD_H
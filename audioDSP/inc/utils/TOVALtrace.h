@@ -0,0 +1,87 @@
+#ifndef TOVALTRACE_H
+#define TOVALTRACE_H
+
+#include <cstdint>
+
+/*
+    Scoped timing trace, compiled in with -DTOVAL_ENABLE_TRACE (CMake option TOVAL_ENABLE_TRACE).
+
+        TOVAL_TRACE_SCOPE("headroom");                      // times the enclosing scope
+        TOVAL_TRACE_SCOPE_ARGS("set", moduleID, paramID);   // plus two numbers shown in the viewer
+
+    Each thread writes finished scopes into its own preallocated ring, so recording is two clock reads and
+    a handful of stores with no locks and no allocation (the ring is created the first time a thread
+    traces, or up front with TOVAL_trace_register_thread). A full ring overwrites its oldest events.
+    Every event carries the calling thread's block number, bumped by TOVAL_TRACE_NEXT_BLOCK once per
+    TOVAL_Effect_process, so a slow scope can be tied to the block it happened in.
+
+    TOVAL_trace_write_chrome_json dumps every ring as Chrome Trace Event JSON (chrome://tracing, Perfetto).
+    Call it when the traced threads are idle.
+
+    Without TOVAL_ENABLE_TRACE the macros expand to nothing and no trace code is built.
+*/
+
+#ifdef TOVAL_ENABLE_TRACE
+
+#include <chrono>
+
+struct TOVAL_TraceEvent {
+    const char* name;       // string literal, stored by pointer
+    uint64_t begin_ns;
+    uint64_t end_ns;
+    uint64_t block;
+    uint32_t arg0;
+    uint32_t arg1;
+};
+
+inline uint64_t TOVAL_trace_now_ns()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void TOVAL_trace_record(const TOVAL_TraceEvent& event);
+void TOVAL_trace_next_block();
+uint64_t TOVAL_trace_block();
+void TOVAL_trace_register_thread();
+bool TOVAL_trace_write_chrome_json(const char* path);
+void TOVAL_trace_clear();       // drops every recorded event, traced threads must be idle
+
+class TOVAL_TraceScope {
+
+    public:
+
+    explicit TOVAL_TraceScope(const char* name, uint32_t arg0 = 0, uint32_t arg1 = 0)
+        : name(name), arg0(arg0), arg1(arg1), begin_ns(TOVAL_trace_now_ns()) {}
+
+    ~TOVAL_TraceScope()
+    {
+        TOVAL_trace_record({ name, begin_ns, TOVAL_trace_now_ns(), TOVAL_trace_block(), arg0, arg1 });
+    }
+
+    TOVAL_TraceScope(const TOVAL_TraceScope&) = delete;
+    TOVAL_TraceScope& operator=(const TOVAL_TraceScope&) = delete;
+
+    private:
+
+    const char* name;
+    uint32_t arg0;
+    uint32_t arg1;
+    uint64_t begin_ns;
+};
+
+#define TOVAL_TRACE_CONCAT_(a, b) a##b
+#define TOVAL_TRACE_CONCAT(a, b) TOVAL_TRACE_CONCAT_(a, b)
+#define TOVAL_TRACE_SCOPE(name) TOVAL_TraceScope TOVAL_TRACE_CONCAT(toval_trace_scope_, __LINE__)(name)
+#define TOVAL_TRACE_SCOPE_ARGS(name, a0, a1) TOVAL_TraceScope TOVAL_TRACE_CONCAT(toval_trace_scope_, __LINE__)(name, static_cast<uint32_t>(a0), static_cast<uint32_t>(a1))
+#define TOVAL_TRACE_NEXT_BLOCK() TOVAL_trace_next_block()
+
+#else
+
+#define TOVAL_TRACE_SCOPE(name) do {} while (0)
+#define TOVAL_TRACE_SCOPE_ARGS(name, a0, a1) do {} while (0)
+#define TOVAL_TRACE_NEXT_BLOCK() do {} while (0)
+
+#endif // TOVAL_ENABLE_TRACE
+
+#endif // TOVALTRACE_H
@@ -0,0 +1,70 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include <span>
+
+#include "TOVALarena.h"
+#include "TOVALaudio.h"
+
+/*
+    Lock-free triple buffer: one writer publishes whole values, one reader always gets the newest
+    complete one. Neither side waits for the other.
+
+    Three slots: the writer owns one (back), the reader owns one (front) and the third sits in the
+    shared word together with a fresh bit. publish swaps the back slot into the shared word, read swaps
+    the front slot out for it when the fresh bit is set. Each side only ever touches its own slot, so T
+    can be large and is never copied under contention. Slots come from the arena and start value
+    initialised.
+*/
+
+template <typename T>
+class TripleBuffer {
+
+    public:
+
+    TOVAL_ERROR triplebuffer_init(TOVAL_Arena& arena)
+    {
+        slots = arena.alloc<T>(3);
+        if (arena.failed())
+        {
+            return TOVAL_ERROR::MEMORY_ERROR;
+        }
+        shared.store(0, std::memory_order_relaxed);
+        back = 1;
+        front = 2;
+        return TOVAL_ERROR::NO_ERROR;
+    }
+
+    // Writer side: fill write_slot(), then publish it
+    T& write_slot() { return slots[back]; }
+    void publish()
+    {
+        back = shared.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Reader side: the newest published value, or the last one read again when nothing new arrived
+    const T& read_slot()
+    {
+        if (shared.load(std::memory_order_relaxed) & FRESH)
+        {
+            front = shared.exchange(front, std::memory_order_acq_rel) & INDEX;
+        }
+        return slots[front];
+    }
+
+    bool has_new() const { return (shared.load(std::memory_order_relaxed) & FRESH) != 0; }
+
+    private:
+
+    static constexpr uint32_t INDEX = 3;
+    static constexpr uint32_t FRESH = 4;
+
+    std::span<T> slots;
+    alignas(64) std::atomic<uint32_t> shared{0};
+    alignas(64) uint32_t back = 1;
+    alignas(64) uint32_t front = 2;
+};
+
+#endif // TRIPLEBUFFER_H
@@ -0,0 +1,70 @@
+#ifndef WORKERGROUP_H
+#define WORKERGROUP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "TOVALaudio.h"
+
+/*
+    Small persistent thread group for splitting one block's work (channels of a stage) across cores.
+
+    run(count, task, context) publishes a job by bumping a generation counter, the calling thread and
+    every worker then claim task indices from a shared counter until none are left, and run returns once
+    every worker has checked back in for that generation, which is the per block barrier. Nothing is
+    allocated or locked per call.
+
+    Waiting is spin then park: a worker (or the caller at the barrier) spins on the counter for spin
+    iterations, short enough to stay inside one block, then sleeps in std::atomic::wait. Back to back
+    blocks are picked up while still spinning, a paused stream costs no CPU.
+
+    One caller at a time. Everything the caller wrote before run is visible to the tasks, and everything
+    the tasks wrote is visible to the caller after it (release / acquire on the two counters).
+*/
+
+class WorkerGroup {
+
+    public:
+
+    using Task = void (*)(void* context, size_t index);
+
+    WorkerGroup() = default;
+    ~WorkerGroup() { workers_stop(); }
+
+    WorkerGroup(const WorkerGroup&) = delete;
+    WorkerGroup& operator=(const WorkerGroup&) = delete;
+
+    // num_workers threads besides the caller. Starts the threads, so not from the audio thread.
+    TOVAL_ERROR workers_start(size_t num_workers, uint32_t spin = DEFAULT_SPIN);
+    void workers_stop();
+
+    bool running() const { return !threads.empty(); }
+    size_t num_threads() const { return threads.size() + 1; }     // the caller takes part
+
+    // task(context, i) for every i in [0, count), returns when all are done. Inline when not running.
+    void run(size_t count, Task task, void* context);
+
+    static constexpr uint32_t DEFAULT_SPIN = 4000;      // a few microseconds of pause instructions
+
+    private:
+
+    void worker_loop(uint32_t seen);
+
+    std::vector<std::thread> threads;
+    uint32_t spin = DEFAULT_SPIN;
+
+    // Job, written by the caller before generation is bumped
+    Task task = nullptr;
+    void* context = nullptr;
+    size_t count = 0;
+
+    alignas(64) std::atomic<uint32_t> generation{0};
+    alignas(64) std::atomic<size_t> next{0};            // next unclaimed task index
+    alignas(64) std::atomic<uint32_t> checked_in{0};    // workers done with the current generation
+    std::atomic<bool> stopping{false};
+};
+
+#endif // WORKERGROUP_H
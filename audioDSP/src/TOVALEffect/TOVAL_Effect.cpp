@@ -1,12 +1,112 @@
 #include "TOVAL_Effect_p.h"
+#include "TOVALtrace.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 
 using namespace std;
 
-TOVAL_Effect::TOVAL_Effect() : pImpl(new Impl) {}   // constructor is called when new object of class TOVAL_delay is called. This then initialises a new object of the internal struct 'Impl' named pImpl
+TOVAL_Effect::TOVAL_Effect() : pImpl(new Impl)   // constructor is called when new object of class TOVAL_delay is called. This then initialises a new object of the internal struct 'Impl' named pImpl
+{
+    pImpl->arena.arena_init_heap();
+}
+
+TOVAL_Effect::TOVAL_Effect(Impl* impl) : pImpl(impl) {}
 
 TOVAL_Effect::~TOVAL_Effect() {
-    delete pImpl;
+    TOVAL_Effect_async_stop();
+    TOVAL_Effect_parallel_stop();       // after async, whose worker drives the group
+    if (pImpl->arena.is_fixed())
+    {
+        pImpl->~Impl();     // lives in the caller's block
+    }
+    else
+    {
+        delete pImpl;
+    }
+}
+
+// The instance and its Impl sit at the front of an init_in block, init allocations follow
+static size_t arena_header_size(size_t effect_size, size_t impl_size)
+{
+    return TOVAL_Arena::align_up(effect_size) + TOVAL_Arena::align_up(impl_size);
+}
+
+TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_query_memory(size_t data_length, const void* config_data, TOVAL_MemoryRequirements* requirements)
+{
+  TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+  if (requirements == nullptr)
+  {
+    return TOVAL_ERROR::NULL_POINTER_ERROR;
+  }
+
+  // A heap backed init counts exactly what a fixed arena will be asked for
+  TOVAL_Effect probe;
+  ret = probe.set_config(data_length, config_data);
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    ret = probe.TOVAL_Effect_init();
+  }
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    requirements->size = arena_header_size(sizeof(TOVAL_Effect), sizeof(Impl)) + probe.pImpl->arena.required();
+    requirements->alignment = TOVAL_Arena::ALIGNMENT;
+  }
+  return ret;
+}
+
+TOVAL_Effect* TOVAL_Effect::TOVAL_Effect_init_in(void* memory, size_t size, size_t data_length, const void* config_data, TOVAL_ERROR* error)
+{
+  TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+  TOVAL_Effect* effect = nullptr;
+
+  const size_t header = arena_header_size(sizeof(TOVAL_Effect), sizeof(Impl));
+  uint8_t* base = static_cast<uint8_t*>(memory);
+
+  if (memory == nullptr)
+  {
+    ret = TOVAL_ERROR::NULL_POINTER_ERROR;
+  }
+  else if (size < header || (reinterpret_cast<uintptr_t>(memory) & (TOVAL_Arena::ALIGNMENT - 1)) != 0)
+  {
+    ret = TOVAL_ERROR::MEMORY_ERROR;
+  }
+  else
+  {
+    Impl* impl = new (base + TOVAL_Arena::align_up(sizeof(TOVAL_Effect))) Impl;
+    impl->arena.arena_init_fixed(memory, size);
+    impl->arena.alloc_bytes(header);    // the effect and Impl themselves
+    impl->init_mark = impl->arena.mark();
+    effect = new (base) TOVAL_Effect(impl);
+
+    ret = effect->set_config(data_length, config_data);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+      ret = effect->TOVAL_Effect_init();
+    }
+    if (ret != TOVAL_ERROR::NO_ERROR)
+    {
+      TOVAL_Effect_destroy_in(effect);
+      effect = nullptr;
+    }
+  }
+
+  if (error != nullptr)
+  {
+    *error = ret;
+  }
+  return effect;
+}
+
+void TOVAL_Effect::TOVAL_Effect_destroy_in(TOVAL_Effect* effect)
+{
+  if (effect != nullptr)
+  {
+    effect->~TOVAL_Effect();
+  }
 }
 
 TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_init()
@@ -16,125 +116,443 @@ TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_init()
   // call a set function that sets number samples per channel (chunk size). Can pass buffer.getNumSamples from JUCE processor.cpp
 
   pImpl->variables.global_enable = 0;
-  ret = pImpl->headroom.headroom_init();
+
+  pImpl->arena.rewind(pImpl->init_mark);    // a re-init reuses the same memory
+
+  pImpl->update_channel_config();
+  ret = pImpl->update_resampler_config();   // also clears converter history, decides the processing rate
+
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    ret = pImpl->headroom.headroom_init(pImpl->processing_rate(), pImpl->arena);
+  }
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    ret = pImpl->compressor.compressor_init(pImpl->processing_rate(), pImpl->arena);
+  }
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    ret = pImpl->crossover.crossover_init(pImpl->processing_rate(), pImpl->arena);
+  }
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    ret = pImpl->delay.delay_init(pImpl->processing_rate(), pImpl->arena);
+  }
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    ret = pImpl->reverb.reverb_init(pImpl->processing_rate(), pImpl->arena);
+  }
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    ret = pImpl->fir.fir_init(pImpl->processing_rate(), pImpl->arena);
+  }
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    ret = pImpl->analyzer.analyzer_init(pImpl->processing_rate(), pImpl->arena);
+  }
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    ret = pImpl->pcm.converter.pcm_init(std::max(pImpl->config.In_num_channels, pImpl->config.Out_num_channels), pImpl->arena);
+  }
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    ret = pImpl->pcm.in.audiobuffer_init(pImpl->config.In_num_channels, Impl::PcmStage::BLOCK, pImpl->arena);
+  }
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    ret = pImpl->pcm.out.audiobuffer_init(pImpl->config.Out_num_channels, Impl::PcmStage::BLOCK, pImpl->arena);
+  }
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    pImpl->reset_params();  // every parameter back to its TOVAL_PARAM_TABLE default
+  }
   return ret;  
 }
 
-TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_set(uint16_t moduleID, uint16_t paramID, uint16_t datalength, void* data)
+TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_process(float **ppIn, float **ppOut, size_t nspc)
 {
-  TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+  if (ppIn == nullptr || ppOut == nullptr)
+  {
+    return TOVAL_ERROR::NULL_POINTER_ERROR;
+  }
+  return TOVAL_Effect_process(AudioBlockView(ppIn, pImpl->config.In_num_channels, nspc),
+                              AudioBlockView(ppOut, pImpl->config.Out_num_channels, nspc));
+}
 
-  /*
-    Potential preset idea. Where the instance of pImpl is defined, you could have several Impl objects, one for each preset.
-    This way you can pass Preset ID as an argument to the public functions, and then a switch case where you then call the do set,
-    but it will be setting the private structure variables for that specific preset impl.
+TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_process(const AudioBlockView& in, const AudioBlockView& out)
+{
+  const size_t nspc = in.num_frames();
 
-    Only try this addition of preset IDs to the public functions once library is working on 1 instance.
-  */
+  TOVAL_TRACE_NEXT_BLOCK();
+  TOVAL_TRACE_SCOPE_ARGS("TOVAL_Effect_process", nspc, 0);
 
+  if (in.raw() == nullptr || out.raw() == nullptr)
+  {
+    return TOVAL_ERROR::NULL_POINTER_ERROR;
+  }
+  if (in.num_channels() < pImpl->config.In_num_channels || out.num_channels() < pImpl->config.Out_num_channels
+      || out.num_frames() < nspc)
+  {
+    return TOVAL_ERROR::SIZE_ERROR;
+  }
 
-  ret = pImpl->TOVAL_Effect_do_set(moduleID, paramID, datalength, data);
-  //call the specific instance of the Internal Impl struct and its sub function.
-  return ret;  
+  pImpl->apply_pending_params();    // pick up sets published since the last block
+  return pImpl->process_block(in, out.first(nspc));
 }
 
-TOVAL_ERROR TOVAL_Effect::Impl::TOVAL_Effect_do_set(uint32_t moduleID, uint16_t paramID, uint16_t data_length, void* data)
+TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_process(const AudioBlockView& in, const AudioBlockView& out, const AudioBlockView& sidechain)
 {
-    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+  if (sidechain.raw() == nullptr)
+  {
+    return TOVAL_ERROR::NULL_POINTER_ERROR;
+  }
+  if (sidechain.num_channels() == 0 || sidechain.num_frames() < in.num_frames())
+  {
+    return TOVAL_ERROR::SIZE_ERROR;
+  }
 
-    switch(moduleID)
+  const AudioBlockView key = sidechain.first(in.num_frames());
+  pImpl->sidechain = &key;
+  TOVAL_ERROR ret = TOVAL_Effect_process(in, out);
+  pImpl->sidechain = nullptr;
+  return ret;
+}
+
+TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_process_events(float **ppIn, float **ppOut, size_t nspc, const TOVAL_ParamEvent* events, size_t num_events)
+{
+  if (ppIn == nullptr || ppOut == nullptr)
+  {
+    return TOVAL_ERROR::NULL_POINTER_ERROR;
+  }
+  return TOVAL_Effect_process_events(AudioBlockView(ppIn, pImpl->config.In_num_channels, nspc),
+                                     AudioBlockView(ppOut, pImpl->config.Out_num_channels, nspc), events, num_events);
+}
+
+TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_process_events(const AudioBlockView& in, const AudioBlockView& out, const TOVAL_ParamEvent* events, size_t num_events)
+{
+  TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+  const size_t nspc = in.num_frames();
+
+  TOVAL_TRACE_NEXT_BLOCK();
+  TOVAL_TRACE_SCOPE_ARGS("TOVAL_Effect_process_events", nspc, num_events);
+
+  if (in.raw() == nullptr || out.raw() == nullptr || (events == nullptr && num_events > 0))
+  {
+    return TOVAL_ERROR::NULL_POINTER_ERROR;
+  }
+  if (in.num_channels() < pImpl->config.In_num_channels || out.num_channels() < pImpl->config.Out_num_channels
+      || out.num_frames() < nspc)
+  {
+    return TOVAL_ERROR::SIZE_ERROR;
+  }
+
+  // Validate the whole list before touching any audio
+  for (size_t e = 0; e < num_events; e++)
+  {
+    if (events[e].sample_offset >= nspc || (e > 0 && events[e].sample_offset < events[e - 1].sample_offset))
     {
-      case TOVAL_Module::GLOBAL:
-        ret = global_set(paramID, data_length, (void*) data);
-        break;
+      return TOVAL_ERROR::PARAMETER_ERROR;
+    }
 
-      case TOVAL_Module::HEADROOM:
-        ret = headroom.headroom_set(paramID, data_length, (void*) data);
-        break;
-      
-      default:
-        ret = TOVAL_ERROR::MODULEID_ERROR;
-        break;
+    int index = -1;
+    ret = pImpl->validate_param(events[e].moduleID, events[e].paramID, sizeof(events[e].value), &events[e].value, index);
+    if (ret != TOVAL_ERROR::NO_ERROR)
+    {
+      return ret;
     }
-    return ret;
+  }
+
+  // Published sets land once, before the first event. Anything set during the block waits for the next
+  // one, so a set never lands between two sub-blocks and overrides an event still in force.
+  pImpl->apply_pending_params();
+
+  size_t e = 0;
+  size_t start = 0;
+
+  // Kernels only ever see whole sub-blocks, the event check happens once per split
+  while (start < nspc && ret == TOVAL_ERROR::NO_ERROR)
+  {
+    for (; e < num_events && events[e].sample_offset <= start; e++)
+    {
+      pImpl->apply_event(TOVAL_param_index(events[e].moduleID, events[e].paramID), events[e].value.u32);
+    }
+
+    const size_t end = (e < num_events) ? events[e].sample_offset : nspc;
+
+    ret = pImpl->process_block(in.slice(start, end - start), out.slice(start, end - start));
+    start = end;
+  }
+
+  return ret;
 }
 
-TOVAL_ERROR TOVAL_Effect::Impl::global_set(uint16_t paramID, uint16_t data_length, void* data)
+TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_process_pcm(const void* const* ppIn, void* const* ppOut, size_t nspc, TOVAL_PcmFormat format, TOVAL_PcmLayout layout)
 {
   TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+  PcmConverter& converter = pImpl->pcm.converter;
 
-  switch(paramID)
+  TOVAL_TRACE_SCOPE_ARGS("TOVAL_Effect_process_pcm", nspc, format);
+
+  if (ppIn == nullptr || ppOut == nullptr)
   {
-    case TOVAL_GlobalParam::GLOBAL_ENABLE:
-      if (data_length != sizeof(variables.global_enable))
-      {
-        ret = TOVAL_ERROR::SIZE_ERROR;
-      }
-      else if (data == nullptr)
-      {
-        ret = TOVAL_ERROR::NULL_POINTER_ERROR;
-      }
-      else
-      {
-        uint32_t value = *static_cast<const uint32_t*>(data);
-        variables.global_enable = value;
-      }
-      break;
+    return TOVAL_ERROR::NULL_POINTER_ERROR;
+  }
+
+  for (size_t start = 0; start < nspc && ret == TOVAL_ERROR::NO_ERROR; start += Impl::PcmStage::BLOCK)
+  {
+    const size_t count = std::min(Impl::PcmStage::BLOCK, nspc - start);
+    const AudioBlockView in = pImpl->pcm.in.view().first(count);
+    const AudioBlockView out = pImpl->pcm.out.view().first(count);
 
-    default:
-      ret = TOVAL_ERROR::PARAMID_ERROR;
-      break;
-    
+    ret = converter.to_float(ppIn, start, format, layout, in);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+      ret = TOVAL_Effect_process(in, out);
+    }
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+      ret = converter.from_float(out, format, layout, ppOut, start);
+    }
   }
   return ret;
 }
 
-TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_get(uint16_t moduleID, uint16_t paramID, uint16_t datalength, void* data)
-{ 
+TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_analyze()
+{
+  TOVAL_TRACE_SCOPE("analyzer_update");
+  pImpl->analyzer.analyzer_update();
+  return TOVAL_ERROR::NO_ERROR;
+}
+
+// One block with whatever parameters are in force, published sets are the caller's business
+TOVAL_ERROR TOVAL_Effect::Impl::process_block(const AudioBlockView& in, const AudioBlockView& out)
+{
   TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
-  ret = pImpl->TOVAL_Effect_do_get(moduleID, paramID, datalength, data);
+  const size_t nspc = in.num_frames();
+
+  if(variables.global_enable == 0)
+  {
+    for (uint16_t ch = 0; ch < config.Out_num_channels; ch++)
+    {
+      if (ch >= config.In_num_channels)
+      {
+        memset(out.channel(ch), 0, nspc * sizeof(float));
+      }
+      else if (out.channel(ch) != in.channel(ch))
+      {
+        memcpy(out.channel(ch), in.channel(ch), nspc * sizeof(float));
+      }
+    }
+  }
+  else if (src.enabled)
+  {
+     ret = process_resampled(in, out, sidechain);
+  }
+  else{
+     ret = process_chain(in, out, sidechain);
+  }
+
   return ret;
 }
 
-TOVAL_ERROR TOVAL_Effect::Impl::TOVAL_Effect_do_get(uint32_t moduleID, uint16_t paramID, uint16_t data_length, void* data)
+// Runs every module in order at the internal rate
+TOVAL_ERROR TOVAL_Effect::Impl::process_chain(const AudioBlockView& in, const AudioBlockView& out, const AudioBlockView* key)
 {
   TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
-  switch(moduleID)
-    {
-      case TOVAL_Module::GLOBAL:
-        //ret = global_set(paramID, data_length, (void*) data);
-        break;
+  const size_t nspc = in.num_frames();
+
+  // Headroom, crossover and delay are per channel stages: checked once, channels fanned out when the
+  // parallel mode is on, block level bookkeeping back on this thread. Compressor links its channels, the
+  // FIR runs both through one stereo kernel and the reverb's lines are shared by both, so those run whole.
 
-      case TOVAL_Module::HEADROOM:
-        ret = headroom.headroom_get(paramID, data_length, (void*) data);
-        break;
-      
-      default:
-        ret = TOVAL_ERROR::MODULEID_ERROR;
-        break;
+  // Each tap is a compare unless the analyzer is enabled at that point, then a copy into its ring.
+  // The input is only tapped once headroom_check has validated its pointers.
+  {
+    TOVAL_TRACE_SCOPE("headroom_process");
+    ret = headroom.headroom_check(in, out);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+      analyzer.analyzer_tap(AN_TAP_INPUT, in);
+      auto channel = [&](uint16_t ch) { headroom.headroom_process_channel(in, out, ch); };
+      for_each_channel(HeadroomChannels::NUM_CHANNELS, nspc, channel);
+      headroom.headroom_end_block(nspc);
     }
-    return ret;
+  }
+  analyzer.analyzer_tap(AN_TAP_POST_HEADROOM, out);
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    TOVAL_TRACE_SCOPE("fir_process");
+    ret = fir.fir_process(out, out);   // in place from here on
+  }
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    TOVAL_TRACE_SCOPE("compressor_process");
+    ret = compressor.compressor_process(out, out, key);
+  }
+  analyzer.analyzer_tap(AN_TAP_POST_COMPRESSOR, out);
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    TOVAL_TRACE_SCOPE("crossover_process");
+    ret = crossover.crossover_check(out, out);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+      auto channel = [&](uint16_t ch) { crossover.crossover_process_channel(out, out, ch); };
+      for_each_channel(CrossoverChannels::XO_NUM_CHANNELS, nspc, channel);
+      crossover.crossover_end_block(nspc);
+    }
+  }
+  analyzer.analyzer_tap(AN_TAP_POST_CROSSOVER, out);
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    TOVAL_TRACE_SCOPE("delay_process");
+    ret = delay.delay_check(out, out);
+    for (size_t start = 0; start < nspc && ret == TOVAL_ERROR::NO_ERROR; start += TOVAL_MAX_BLOCK_SIZE)
+    {
+      const AudioBlockView block = out.slice(start, std::min<size_t>(nspc - start, TOVAL_MAX_BLOCK_SIZE));
+      delay.delay_begin_block(block.num_frames());
+      auto channel = [&](uint16_t ch) { delay.delay_process_channel(block, block, ch); };
+      for_each_channel(DelayChannels::DL_NUM_CHANNELS, block.num_frames(), channel);
+    }
+  }
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    TOVAL_TRACE_SCOPE("reverb_process");
+    ret = reverb.reverb_process(out, out);
+  }
+  analyzer.analyzer_tap(AN_TAP_OUTPUT, out);
+
+  return ret;
 }
 
-TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_process(float **ppIn, float **ppOut, size_t nspc)
+TOVAL_ERROR TOVAL_Effect::Impl::process_resampled(const AudioBlockView& in, const AudioBlockView& out, const AudioBlockView* key)
 {
   TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
-  
-  if(pImpl->variables.global_enable == 0)
+  const size_t nspc = in.num_frames();
+
+  size_t done = 0;
+  while (done < nspc && ret == TOVAL_ERROR::NO_ERROR)
   {
-    for (uint32_t ch = 0; ch < pImpl->config.Out_num_channels; ch++)
+    const size_t n = std::min(nspc - done, static_cast<size_t>(TOVAL_MAX_BLOCK_SIZE));
+
+    // The sidechain only runs through its converter while one is passed, picking up in's position when it starts
+    const bool keyed = (key != nullptr);
+    if (keyed && !src.sidechain_live)
+    {
+      src.sidechain.resampler_follow(src.in);
+    }
+    src.sidechain_live = keyed;
+
+    // host rate -> internal rate -> chain -> host rate, appended to the output fifo
+    size_t nInternal = 0;
+    size_t nKey = 0;
+    {
+      TOVAL_TRACE_SCOPE("src_in");
+      nInternal = src.in.resampler_process(in.slice(done, n), src.internal_in.view());
+      if (keyed)
+      {
+        const AudioBlockView block = key->slice(done, n);
+        float* key_channels[CP_NUM_CHANNELS] = { block.channel(0), block.channel(std::min<uint16_t>(1, block.num_channels() - 1)) };
+        nKey = src.sidechain.resampler_process(AudioBlockView(key_channels, CP_NUM_CHANNELS, n), src.internal_sidechain.view());
+      }
+    }
+    const AudioBlockView internal_key = src.internal_sidechain.view().first(nKey);
+    ret = process_chain(src.internal_in.view().first(nInternal), src.internal_out.view().first(nInternal),
+                        (keyed && nKey == nInternal) ? &internal_key : nullptr);
+    {
+      TOVAL_TRACE_SCOPE("src_out");
+      const AudioBlockView queue = src.fifo.view();
+      src.fifo_count += src.out.resampler_process(src.internal_out.view().first(nInternal),
+                                                  queue.slice(src.fifo_count, queue.num_frames() - src.fifo_count));
+    }
+
+    // The fifo is primed so this is always a full block, zero fill is only a safety net
+    const size_t ready = std::min(n, src.fifo_count);
+    for (uint16_t ch = 0; ch < config.Out_num_channels; ch++)
     {
-      if(ch > pImpl->config.In_num_channels)
+      float* pQueue = src.fifo.channel(ch);
+      float* pOut = out.channel(ch) + done;
+      memcpy(pOut, pQueue, ready * sizeof(float));
+      if (ready < n)
       {
-        memset(ppOut[ch], 0, static_cast<size_t>(nspc) * sizeof(float));
+        memset(pOut + ready, 0, (n - ready) * sizeof(float));
       }
-      memcpy(ppOut[ch], ppIn[ch], static_cast<size_t>(nspc) * sizeof(float));
+      memmove(pQueue, pQueue + ready, (src.fifo_count - ready) * sizeof(float));
     }
+    src.fifo_count -= ready;
+    done += n;
   }
-  else{
-     ret = pImpl->headroom.headroom_process(ppIn, ppOut, nspc);
+
+  return ret;
+}
+
+float TOVAL_Effect::Impl::processing_rate() const
+{
+  return src.enabled ? config.internal_sample_rate : config.sample_rate;
+}
+
+TOVAL_ERROR TOVAL_Effect::Impl::update_resampler_config()
+{
+  TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+  const uint32_t host_rate = static_cast<uint32_t>(std::lround(config.sample_rate));
+  const uint32_t internal_rate = static_cast<uint32_t>(std::lround(config.internal_sample_rate));
+
+  src.enabled = false;
+  if (config.internal_sample_rate <= 0.0f || internal_rate == host_rate)
+  {
+    return ret;   // chain runs at the host rate
   }
 
+  if (host_rate == 0 || config.src_quality > TOVAL_SrcQuality::SRC_QUALITY_HIGH)
+  {
+    return TOVAL_ERROR::CONFIG_ERROR;
+  }
+
+  const TOVAL_SrcQuality quality = static_cast<TOVAL_SrcQuality>(config.src_quality);
+  ret = src.in.resampler_init(host_rate, internal_rate, config.In_num_channels, TOVAL_MAX_BLOCK_SIZE, quality, arena);
+  if (ret != TOVAL_ERROR::NO_ERROR)
+  {
+    return ret;
+  }
+
+  const size_t max_internal = src.in.max_output(TOVAL_MAX_BLOCK_SIZE);
+  ret = src.out.resampler_init(internal_rate, host_rate, config.Out_num_channels, max_internal, quality, arena);
+  if (ret != TOVAL_ERROR::NO_ERROR)
+  {
+    return ret;
+  }
+
+  // Rounding in the two stages can leave the output a few samples short of a block, cover it with zeros up front
+  const double ratio = static_cast<double>(internal_rate) / static_cast<double>(host_rate);
+  src.prime = static_cast<size_t>(std::ceil(2.0 / ratio)) + 3;
+
+  ret = src.sidechain.resampler_init(host_rate, internal_rate, compressor.num_channels, TOVAL_MAX_BLOCK_SIZE, quality, arena);
+  if (ret != TOVAL_ERROR::NO_ERROR)
+  {
+    return ret;
+  }
+  src.sidechain_live = false;
+
+  ret = src.internal_in.audiobuffer_init(config.In_num_channels, max_internal, arena);
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    ret = src.internal_sidechain.audiobuffer_init(compressor.num_channels, max_internal, arena);
+  }
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    ret = src.internal_out.audiobuffer_init(config.Out_num_channels, max_internal, arena);
+  }
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    ret = src.fifo.audiobuffer_init(config.Out_num_channels, src.prime + src.out.max_output(max_internal) + TOVAL_MAX_BLOCK_SIZE, arena);
+  }
+  if (ret != TOVAL_ERROR::NO_ERROR)
+  {
+    return ret;
+  }
+  src.fifo_count = src.prime;
+  src.enabled = true;
+
   return ret;
 }
 
@@ -148,7 +566,7 @@ void TOVAL_Effect::Impl::update_channel_config() {
 TOVAL_ERROR TOVAL_Effect::set_config(size_t data_length, const void *config_data)
 {
     TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
-    if (data_length != sizeof(Impl::Config))
+    if (data_length != sizeof(TOVAL_Config))
     {
         ret = TOVAL_ERROR::SIZE_ERROR;
     }
@@ -159,12 +577,21 @@ TOVAL_ERROR TOVAL_Effect::set_config(size_t data_length, const void *config_data
     }
     else
     {
-    const Impl::Config* values = static_cast<const Impl::Config*>(config_data);
-    // Defensive copy and assignment
-    pImpl->config = *values;
+    const TOVAL_Config* values = static_cast<const TOVAL_Config*>(config_data);
 
+    // Converter buffers come from the arena, so they are built at init. Only check the request here.
+    const bool resampled = values->internal_sample_rate > 0.0f && std::lround(values->internal_sample_rate) != std::lround(values->sample_rate);
+    if (resampled && (values->sample_rate <= 0.0f || values->src_quality > TOVAL_SrcQuality::SRC_QUALITY_HIGH))
+    {
+      ret = TOVAL_ERROR::CONFIG_ERROR;
+    }
+    else
+    {
+      // Defensive copy and assignment
+      pImpl->config = *values;
       pImpl->update_channel_config();  // recalculate channel counts
     }
+    }
     return ret;
 }
 
@@ -173,7 +600,7 @@ TOVAL_ERROR TOVAL_Effect::get_config(size_t data_length, void *config_data)
    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
 
     // Check if the provided data length matches the size of enable
-    if (data_length != sizeof(Impl::Config))
+    if (data_length != sizeof(TOVAL_Config))
     {
         ret = TOVAL_ERROR::SIZE_ERROR;
     }
@@ -184,7 +611,7 @@ TOVAL_ERROR TOVAL_Effect::get_config(size_t data_length, void *config_data)
     else
     {   
         pImpl->update_channel_config();  // ensure values are current
-        *static_cast<Impl::Config*>(config_data) = pImpl->config;
+        *static_cast<TOVAL_Config*>(config_data) = pImpl->config;
     }
 
     return ret;
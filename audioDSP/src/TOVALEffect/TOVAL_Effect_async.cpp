@@ -0,0 +1,136 @@
+#include "TOVAL_Effect_p.h"
+#include <array>
+#include <cstring>
+
+/*
+    Async mode.
+
+    Host thread:   push nspc frames into to_worker, wake the worker, pop nspc frames from from_worker.
+    Worker thread: whenever worker_block frames are queued, pop them, run the chain, push the result.
+
+    from_worker is primed with host_block + worker_block frames of silence: one worker block to gather
+    input and one host block for the worker to finish while the host keeps pulling. That priming is the
+    fixed added latency. If the worker still falls behind, the missing frames are zero filled and the
+    underrun counter (GLOBAL_ASYNC_UNDERRUNS) is bumped.
+*/
+
+TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_async_start(size_t host_block, size_t worker_block)
+{
+  TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+  Impl::AsyncStage& async = pImpl->async;
+
+  if (async.running.load())
+  {
+    return TOVAL_ERROR::CONFIG_ERROR;
+  }
+  if (host_block == 0 || worker_block == 0 || worker_block > TOVAL_MAX_BLOCK_SIZE)
+  {
+    return TOVAL_ERROR::PARAMETER_ERROR;
+  }
+
+  pImpl->update_channel_config();
+  const uint16_t in_channels = pImpl->config.In_num_channels;
+  const uint16_t out_channels = pImpl->config.Out_num_channels;
+
+  async.host_block = host_block;
+  async.worker_block = worker_block;
+  async.latency = static_cast<uint32_t>(host_block + worker_block);
+
+  // Room for the priming plus a worker block in flight and a couple of host blocks of slack
+  const size_t capacity = async.latency + worker_block + 2 * host_block;
+  ret = async.to_worker.spsc_init(in_channels, capacity);
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    ret = async.from_worker.spsc_init(out_channels, capacity);
+  }
+  if (ret != TOVAL_ERROR::NO_ERROR)
+  {
+    return ret;
+  }
+
+  async.work_in.assign(in_channels, std::vector<float>(worker_block, 0.0f));
+  async.work_out.assign(out_channels, std::vector<float>(worker_block, 0.0f));
+  async.from_worker.push_silence(async.latency);
+  async.underruns.store(0);
+  async.running.store(true);
+
+  async.worker = std::thread([this]()
+  {
+    Impl::AsyncStage& stage = pImpl->async;
+    std::array<float*, TOVAL_MAX_CHANNELS> pIn;
+    std::array<float*, TOVAL_MAX_CHANNELS> pOut;
+    for (size_t ch = 0; ch < stage.work_in.size(); ch++)
+    {
+      pIn[ch] = stage.work_in[ch].data();
+    }
+    for (size_t ch = 0; ch < stage.work_out.size(); ch++)
+    {
+      pOut[ch] = stage.work_out[ch].data();
+    }
+
+    while (stage.running.load(std::memory_order_acquire))
+    {
+      const uint32_t seen = stage.wake.load(std::memory_order_acquire);
+
+      if (stage.to_worker.readable() >= stage.worker_block && stage.from_worker.writable() >= stage.worker_block)
+      {
+        stage.to_worker.pop(pIn.data(), stage.worker_block);
+        TOVAL_Effect_process(pIn.data(), pOut.data(), stage.worker_block);
+        stage.from_worker.push(pOut.data(), stage.worker_block);
+        continue;
+      }
+
+      stage.wake.wait(seen, std::memory_order_acquire);    // sleeps until the host pushes again
+    }
+  });
+
+  return ret;
+}
+
+TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_async_process(float **ppIn, float **ppOut, size_t nspc)
+{
+  Impl::AsyncStage& async = pImpl->async;
+
+  if (!async.running.load(std::memory_order_relaxed))
+  {
+    return TOVAL_ERROR::CONFIG_ERROR;
+  }
+  if (ppIn == nullptr || ppOut == nullptr)
+  {
+    return TOVAL_ERROR::NULL_POINTER_ERROR;
+  }
+
+  size_t pushed = async.to_worker.push(ppIn, nspc);
+  async.wake.fetch_add(1, std::memory_order_release);
+  async.wake.notify_one();
+
+  size_t ready = async.from_worker.pop(ppOut, nspc);
+  if (ready < nspc || pushed < nspc)
+  {
+    for (uint16_t ch = 0; ch < pImpl->config.Out_num_channels; ch++)
+    {
+      memset(ppOut[ch] + ready, 0, (nspc - ready) * sizeof(float));
+    }
+    async.underruns.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  return TOVAL_ERROR::NO_ERROR;
+}
+
+TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_async_stop()
+{
+  Impl::AsyncStage& async = pImpl->async;
+
+  if (!async.running.exchange(false))
+  {
+    return TOVAL_ERROR::NO_ERROR;
+  }
+
+  async.wake.fetch_add(1, std::memory_order_release);
+  async.wake.notify_one();
+  if (async.worker.joinable())
+  {
+    async.worker.join();
+  }
+  return TOVAL_ERROR::NO_ERROR;
+}
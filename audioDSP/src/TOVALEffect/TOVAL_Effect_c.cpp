@@ -0,0 +1,160 @@
+#include <new>
+#include "TOVAL_Effect.h"
+#include "TOVAL_Effect_c.h"
+
+/*
+    The handle is the TOVAL_Effect itself, cast at the boundary. Nothing here adds state or copies
+    audio, every call is a null check and the class method.
+*/
+
+namespace {
+
+TOVAL_Effect* effect_of(TOVAL_EffectHandle* effect)
+{
+    return reinterpret_cast<TOVAL_Effect*>(effect);
+}
+
+uint32_t code(TOVAL_ERROR error)
+{
+    return static_cast<uint32_t>(error);
+}
+
+} // namespace
+
+uint32_t TOVAL_effect_version(void)
+{
+    return (TOVAL_VERSION_MAJOR << 16) | (TOVAL_VERSION_MINOR << 8) | TOVAL_VERSION_PATCH;
+}
+
+TOVAL_EffectHandle* TOVAL_effect_create(void)
+{
+    return reinterpret_cast<TOVAL_EffectHandle*>(new (std::nothrow) TOVAL_Effect);
+}
+
+void TOVAL_effect_destroy(TOVAL_EffectHandle* effect)
+{
+    delete effect_of(effect);
+}
+
+uint32_t TOVAL_effect_set_config(TOVAL_EffectHandle* effect, const TOVAL_EffectConfig* config)
+{
+    if (effect == nullptr || config == nullptr)
+    {
+        return code(TOVAL_ERROR::NULL_POINTER_ERROR);
+    }
+
+    // Start from the effect's own config so the channel counts stay the chain's
+    TOVAL_Config host{};
+    TOVAL_ERROR ret = effect_of(effect)->get_config(sizeof(host), &host);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        host.sample_rate = config->sample_rate;
+        host.internal_sample_rate = config->internal_sample_rate;
+        host.src_quality = static_cast<uint16_t>(config->src_quality);
+        ret = (config->src_quality > TOVAL_SrcQuality::SRC_QUALITY_HIGH) ? TOVAL_ERROR::CONFIG_ERROR
+                                                                         : effect_of(effect)->set_config(sizeof(host), &host);
+    }
+    return code(ret);
+}
+
+uint32_t TOVAL_effect_init(TOVAL_EffectHandle* effect)
+{
+    if (effect == nullptr)
+    {
+        return code(TOVAL_ERROR::NULL_POINTER_ERROR);
+    }
+    return code(effect_of(effect)->TOVAL_Effect_init());
+}
+
+uint32_t TOVAL_effect_num_channels(TOVAL_EffectHandle* effect, uint32_t* in_channels, uint32_t* out_channels)
+{
+    if (effect == nullptr || in_channels == nullptr || out_channels == nullptr)
+    {
+        return code(TOVAL_ERROR::NULL_POINTER_ERROR);
+    }
+
+    TOVAL_Config host{};
+    TOVAL_ERROR ret = effect_of(effect)->get_config(sizeof(host), &host);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        *in_channels = host.In_num_channels;
+        *out_channels = host.Out_num_channels;
+    }
+    return code(ret);
+}
+
+uint32_t TOVAL_effect_set(TOVAL_EffectHandle* effect, uint16_t module_id, uint16_t param_id, const void* data, uint32_t data_length)
+{
+    if (effect == nullptr)
+    {
+        return code(TOVAL_ERROR::NULL_POINTER_ERROR);
+    }
+    if (data_length > UINT16_MAX)
+    {
+        return code(TOVAL_ERROR::SIZE_ERROR);
+    }
+    // TOVAL_Effect_set only reads data
+    return code(effect_of(effect)->TOVAL_Effect_set(module_id, param_id, static_cast<uint16_t>(data_length), const_cast<void*>(data)));
+}
+
+uint32_t TOVAL_effect_get(TOVAL_EffectHandle* effect, uint16_t module_id, uint16_t param_id, void* data, uint32_t data_length)
+{
+    if (effect == nullptr)
+    {
+        return code(TOVAL_ERROR::NULL_POINTER_ERROR);
+    }
+    if (data_length > UINT16_MAX)
+    {
+        return code(TOVAL_ERROR::SIZE_ERROR);
+    }
+    return code(effect_of(effect)->TOVAL_Effect_get(module_id, param_id, static_cast<uint16_t>(data_length), data));
+}
+
+uint32_t TOVAL_effect_process(TOVAL_EffectHandle* effect, const float* const* in, float* const* out, size_t frames)
+{
+    if (effect == nullptr)
+    {
+        return code(TOVAL_ERROR::NULL_POINTER_ERROR);
+    }
+    // The chain never writes through the input pointers
+    return code(effect_of(effect)->TOVAL_Effect_process(const_cast<float**>(in), const_cast<float**>(out), frames));
+}
+
+uint32_t TOVAL_effect_analyze(TOVAL_EffectHandle* effect)
+{
+    if (effect == nullptr)
+    {
+        return code(TOVAL_ERROR::NULL_POINTER_ERROR);
+    }
+    return code(effect_of(effect)->TOVAL_Effect_analyze());
+}
+
+uint32_t TOVAL_effect_param_count(void)
+{
+    return static_cast<uint32_t>(TOVAL_PARAM_COUNT);
+}
+
+uint32_t TOVAL_effect_param_info(uint32_t index, TOVAL_EffectParamInfo* info)
+{
+    if (info == nullptr)
+    {
+        return code(TOVAL_ERROR::NULL_POINTER_ERROR);
+    }
+    if (index >= TOVAL_PARAM_COUNT)
+    {
+        return code(TOVAL_ERROR::PARAMID_ERROR);
+    }
+
+    const TOVAL_ParamDescriptor& desc = TOVAL_PARAM_TABLE[index];
+    info->module_id = desc.moduleID;
+    info->param_id = desc.paramID;
+    info->module_name = desc.module_name;
+    info->param_name = desc.param_name;
+    info->type = static_cast<uint32_t>(desc.type);
+    info->read_only = (desc.access == TOVAL_ParamAccess::READ_ONLY) ? 1 : 0;
+    info->size = desc.size;
+    info->min = desc.min;
+    info->max = desc.max;
+    info->def = desc.def;
+    return code(TOVAL_ERROR::NO_ERROR);
+}
@@ -0,0 +1,35 @@
+#include "TOVAL_Effect_p.h"
+
+/*
+    Channel parallel mode.
+
+    process_chain checks each per channel stage once, then hands its channels to the worker group: the
+    processing thread and the workers claim channels until none are left and meet at the group's
+    barrier before the next stage reads the result. Stage setup (the delay's modulation curve) and
+    block end bookkeeping (ramp targets, meters) stay on the processing thread, as does everything that
+    links channels (compressor detector, analyzer taps, resamplers).
+
+    Parameters are only applied at the start of a block on the processing thread, and the group's
+    release / acquire handoff makes them visible to the workers, so a block never mixes old and new
+    values across channels.
+*/
+
+TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_parallel_start(size_t num_workers, size_t min_work)
+{
+  Impl::ParallelStage& parallel = pImpl->parallel;
+
+  TOVAL_ERROR ret = parallel.workers.workers_start(num_workers);
+  if (ret != TOVAL_ERROR::NO_ERROR)
+  {
+    return ret;
+  }
+
+  parallel.min_work = min_work;
+  return ret;
+}
+
+TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_parallel_stop()
+{
+  pImpl->parallel.workers.workers_stop();
+  return TOVAL_ERROR::NO_ERROR;
+}
@@ -0,0 +1,433 @@
+#include "TOVAL_Effect_p.h"
+#include "TOVALtrace.h"
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+/*
+    Parameter path, driven by TOVAL_PARAM_TABLE.
+
+    TOVAL_Effect_set / set_batch can be called from any thread. They validate against the descriptor,
+    store the raw 4 bytes in params.values and mark the row dirty. The audio thread picks the dirty rows
+    up in apply_pending_params at the top of TOVAL_Effect_process and hands them to the module setters
+    through a table indexed by descriptor row, so there is no module / param switch left on either side.
+*/
+
+TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_set(uint16_t moduleID, uint16_t paramID, uint16_t datalength, void* data)
+{
+  TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+  TOVAL_TRACE_SCOPE_ARGS("TOVAL_Effect_set", moduleID, paramID);
+
+  /*
+    Potential preset idea. Where the instance of pImpl is defined, you could have several Impl objects, one for each preset.
+    This way you can pass Preset ID as an argument to the public functions, and then a switch case where you then call the do set,
+    but it will be setting the private structure variables for that specific preset impl.
+
+    Only try this addition of preset IDs to the public functions once library is working on 1 instance.
+  */
+
+  int index = -1;
+  ret = pImpl->validate_param(moduleID, paramID, datalength, data, index);
+  if (ret == TOVAL_ERROR::NO_ERROR)
+  {
+    uint32_t bits = 0;
+    memcpy(&bits, data, sizeof(bits));
+    pImpl->publish_param(index, bits);
+    pImpl->params.generation.fetch_add(1, std::memory_order_release);
+  }
+  return ret;
+}
+
+TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_set_batch(const TOVAL_ParamSet* params, size_t count)
+{
+  TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+  TOVAL_TRACE_SCOPE_ARGS("TOVAL_Effect_set_batch", count, 0);
+
+  if (params == nullptr && count > 0)
+  {
+    return TOVAL_ERROR::NULL_POINTER_ERROR;
+  }
+
+  // All or nothing
+  for (size_t i = 0; i < count; i++)
+  {
+    int index = -1;
+    ret = pImpl->validate_param(params[i].moduleID, params[i].paramID, sizeof(params[i].value), &params[i].value, index);
+    if (ret != TOVAL_ERROR::NO_ERROR)
+    {
+      return ret;
+    }
+  }
+
+  // Bracketed so apply_pending_params can tell a batch is going in and never takes half of it
+  std::atomic<uint64_t>& batches = pImpl->params.batches;
+  batches.fetch_add(Impl::ParamState::BATCH_STARTED, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t i = 0; i < count; i++)
+  {
+    pImpl->publish_param(TOVAL_param_index(params[i].moduleID, params[i].paramID), params[i].value.u32);
+  }
+  batches.fetch_add(Impl::ParamState::BATCH_FINISHED, std::memory_order_release);
+  pImpl->params.generation.fetch_add(1, std::memory_order_release);   // one bump, the whole batch lands in one block
+
+  return ret;
+}
+
+TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_get(uint16_t moduleID, uint16_t paramID, uint16_t datalength, void* data)
+{
+  TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+  TOVAL_TRACE_SCOPE_ARGS("TOVAL_Effect_get", moduleID, paramID);
+
+  const int index = TOVAL_param_index(moduleID, paramID);
+  if (moduleID >= MODULE_COUNT)
+  {
+    ret = TOVAL_ERROR::MODULEID_ERROR;
+  }
+  else if (index < 0)
+  {
+    ret = TOVAL_ERROR::PARAMID_ERROR;
+  }
+  else if (datalength != TOVAL_PARAM_TABLE[index].size)
+  {
+    ret = TOVAL_ERROR::SIZE_ERROR;
+  }
+  else if (data == nullptr)
+  {
+    ret = TOVAL_ERROR::NULL_POINTER_ERROR;
+  }
+  else if (TOVAL_PARAM_TABLE[index].type == TOVAL_ParamType::BLOB)
+  {
+    ret = pImpl->read_blob(index, datalength, data);
+  }
+  else
+  {
+    const uint32_t bits = pImpl->read_param(index);
+    memcpy(data, &bits, sizeof(bits));
+  }
+  return ret;
+}
+
+TOVAL_ERROR TOVAL_Effect::TOVAL_Effect_get_batch(TOVAL_ParamSet* params, size_t count)
+{
+  TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+  if (params == nullptr && count > 0)
+  {
+    return TOVAL_ERROR::NULL_POINTER_ERROR;
+  }
+
+  for (size_t i = 0; i < count && ret == TOVAL_ERROR::NO_ERROR; i++)
+  {
+    ret = TOVAL_Effect_get(params[i].moduleID, params[i].paramID, sizeof(params[i].value), &params[i].value);
+  }
+  return ret;
+}
+
+TOVAL_ERROR TOVAL_Effect::Impl::validate_param(uint16_t moduleID, uint16_t paramID, uint16_t data_length, const void* data, int& index) const
+{
+  index = TOVAL_param_index(moduleID, paramID);
+  if (moduleID >= MODULE_COUNT)
+  {
+    return TOVAL_ERROR::MODULEID_ERROR;
+  }
+  if (index < 0 || TOVAL_PARAM_TABLE[index].access == TOVAL_ParamAccess::READ_ONLY)
+  {
+    return TOVAL_ERROR::PARAMID_ERROR;
+  }
+
+  return TOVAL_param_check(TOVAL_PARAM_TABLE[index], data_length, data);
+}
+
+void TOVAL_Effect::Impl::publish_param(int index, uint32_t bits)
+{
+  params.values[index].store(bits, std::memory_order_relaxed);
+  params.dirty[index / 64].fetch_or(uint64_t{1} << (index % 64), std::memory_order_release);
+}
+
+/*
+    Batches are guarded like a seqlock. The dirty rows and their values are taken first and only applied
+    when no batch was being published before or during the take; otherwise the rows go back to dirty and
+    applied_generation is left alone, so the next block tries again. A batch so lands whole, in one block.
+*/
+void TOVAL_Effect::Impl::apply_pending_params()
+{
+  const uint32_t generation = params.generation.load(std::memory_order_acquire);
+  if (generation == params.applied_generation)
+  {
+    return;     // nothing published since the last block, one load on the hot path
+  }
+  const uint64_t batches = params.batches.load(std::memory_order_acquire);
+  if (batches & ParamState::BATCH_IN_FLIGHT)
+  {
+    return;
+  }
+  TOVAL_TRACE_SCOPE("apply_params");
+
+  std::array<uint64_t, std::tuple_size_v<decltype(params.dirty)>> taken;
+  std::array<uint32_t, TOVAL_PARAM_COUNT> values;
+  for (size_t word = 0; word < params.dirty.size(); word++)
+  {
+    taken[word] = params.dirty[word].exchange(0, std::memory_order_acquire);
+    for (uint64_t bits = taken[word]; bits != 0; bits &= bits - 1)
+    {
+      const size_t index = word * 64 + std::countr_zero(bits);
+      values[index] = params.values[index].load(std::memory_order_relaxed);
+    }
+  }
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (params.batches.load(std::memory_order_relaxed) != batches)
+  {
+    for (size_t word = 0; word < params.dirty.size(); word++)
+    {
+      params.dirty[word].fetch_or(taken[word], std::memory_order_relaxed);
+    }
+    return;
+  }
+  params.applied_generation = generation;
+
+  for (size_t word = 0; word < params.dirty.size(); word++)
+  {
+    for (uint64_t bits = taken[word]; bits != 0; bits &= bits - 1)
+    {
+      const int index = static_cast<int>(word * 64) + std::countr_zero(bits);
+      apply_published(index, values[index]);
+    }
+  }
+}
+
+// A value that passed the descriptor but the module still turned down is taken back out of values, unless
+// a newer set has replaced it since, so TOVAL_Effect_get keeps reporting what is in effect
+void TOVAL_Effect::Impl::apply_published(int index, uint32_t bits)
+{
+  if (apply_param(index, bits) == TOVAL_ERROR::NO_ERROR)
+  {
+    params.applied[index] = bits;
+    return;
+  }
+  uint32_t expected = bits;
+  params.values[index].compare_exchange_strong(expected, params.applied[index], std::memory_order_relaxed);
+}
+
+// Events go straight to the module and never through values, which belong to the control side. A get
+// so keeps reporting the last TOVAL_Effect_set; applied follows the event for the rollback above.
+void TOVAL_Effect::Impl::apply_event(int index, uint32_t bits)
+{
+  if (apply_param(index, bits) == TOVAL_ERROR::NO_ERROR)
+  {
+    params.applied[index] = bits;
+  }
+}
+
+TOVAL_ERROR TOVAL_Effect::Impl::apply_param(int index, uint32_t bits)
+{
+  using SetHandler = TOVAL_ERROR (*)(Impl&, size_t, void*);
+
+  // One handler per descriptor row, read only rows stay null
+  static constexpr std::array<SetHandler, TOVAL_PARAM_COUNT> handlers = [] {
+    std::array<SetHandler, TOVAL_PARAM_COUNT> h{};
+    h[TOVAL_param_index(GLOBAL, GLOBAL_ENABLE)] = [](Impl& fx, size_t n, void* d) {
+      fx.variables.global_enable = *static_cast<const uint32_t*>(d);
+      (void)n;
+      return TOVAL_ERROR::NO_ERROR;
+    };
+    h[TOVAL_param_index(GLOBAL, GLOBAL_KERNEL_ISA)] = [](Impl& fx, size_t n, void* d) {
+      fx.bind_kernels(static_cast<TOVAL_KernelIsa>(*static_cast<const uint32_t*>(d)));
+      (void)n;
+      return TOVAL_ERROR::NO_ERROR;
+    };
+
+    h[TOVAL_param_index(GLOBAL, GLOBAL_DITHER)] = [](Impl& fx, size_t n, void* d) {
+      fx.pcm.converter.set_dither(static_cast<TOVAL_Dither>(*static_cast<const uint32_t*>(d)));
+      (void)n;
+      return TOVAL_ERROR::NO_ERROR;
+    };
+
+    h[TOVAL_param_index(HEADROOM, HR_ENABLE)]    = [](Impl& fx, size_t n, void* d) { return fx.headroom.set_enable(n, d); };
+    h[TOVAL_param_index(HEADROOM, HR_GAIN)]      = [](Impl& fx, size_t n, void* d) { return fx.headroom.set_gain(n, d); };
+    h[TOVAL_param_index(HEADROOM, HR_RAMP_TIME)] = [](Impl& fx, size_t n, void* d) { return fx.headroom.set_ramp_time(n, d); };
+
+    h[TOVAL_param_index(DELAY, DL_ENABLE)]        = [](Impl& fx, size_t n, void* d) { return fx.delay.set_enable(n, d); };
+    h[TOVAL_param_index(DELAY, DL_TIME)]          = [](Impl& fx, size_t n, void* d) { return fx.delay.set_time(n, d); };
+    h[TOVAL_param_index(DELAY, DL_FEEDBACK)]      = [](Impl& fx, size_t n, void* d) { return fx.delay.set_feedback(n, d); };
+    h[TOVAL_param_index(DELAY, DL_MIX)]           = [](Impl& fx, size_t n, void* d) { return fx.delay.set_mix(n, d); };
+    h[TOVAL_param_index(DELAY, DL_MOD_DEPTH)]     = [](Impl& fx, size_t n, void* d) { return fx.delay.set_mod_depth(n, d); };
+    h[TOVAL_param_index(DELAY, DL_MOD_RATE)]      = [](Impl& fx, size_t n, void* d) { return fx.delay.set_mod_rate(n, d); };
+    h[TOVAL_param_index(DELAY, DL_INTERPOLATION)] = [](Impl& fx, size_t n, void* d) { return fx.delay.set_interpolation(n, d); };
+
+    h[TOVAL_param_index(COMPRESSOR, CP_ENABLE)]    = [](Impl& fx, size_t n, void* d) { return fx.compressor.set_enable(n, d); };
+    h[TOVAL_param_index(COMPRESSOR, CP_MODE)]      = [](Impl& fx, size_t n, void* d) { return fx.compressor.set_mode(n, d); };
+    h[TOVAL_param_index(COMPRESSOR, CP_THRESHOLD)] = [](Impl& fx, size_t n, void* d) { return fx.compressor.set_threshold(n, d); };
+    h[TOVAL_param_index(COMPRESSOR, CP_RATIO)]     = [](Impl& fx, size_t n, void* d) { return fx.compressor.set_ratio(n, d); };
+    h[TOVAL_param_index(COMPRESSOR, CP_KNEE)]      = [](Impl& fx, size_t n, void* d) { return fx.compressor.set_knee(n, d); };
+    h[TOVAL_param_index(COMPRESSOR, CP_ATTACK)]    = [](Impl& fx, size_t n, void* d) { return fx.compressor.set_attack(n, d); };
+    h[TOVAL_param_index(COMPRESSOR, CP_RELEASE)]   = [](Impl& fx, size_t n, void* d) { return fx.compressor.set_release(n, d); };
+    h[TOVAL_param_index(COMPRESSOR, CP_MAKEUP)]    = [](Impl& fx, size_t n, void* d) { return fx.compressor.set_makeup(n, d); };
+    h[TOVAL_param_index(COMPRESSOR, CP_RANGE)]     = [](Impl& fx, size_t n, void* d) { return fx.compressor.set_range(n, d); };
+    h[TOVAL_param_index(COMPRESSOR, CP_LINK)]      = [](Impl& fx, size_t n, void* d) { return fx.compressor.set_link(n, d); };
+    h[TOVAL_param_index(COMPRESSOR, CP_SIDECHAIN)] = [](Impl& fx, size_t n, void* d) { return fx.compressor.set_sidechain(n, d); };
+
+    h[TOVAL_param_index(CROSSOVER, XO_ENABLE)]    = [](Impl& fx, size_t n, void* d) { return fx.crossover.set_enable(n, d); };
+    h[TOVAL_param_index(CROSSOVER, XO_NUM_BANDS)] = [](Impl& fx, size_t n, void* d) { return fx.crossover.set_num_bands(n, d); };
+    h[TOVAL_param_index(CROSSOVER, XO_FREQ_1)]    = [](Impl& fx, size_t n, void* d) { return fx.crossover.set_frequency(0, n, d); };
+    h[TOVAL_param_index(CROSSOVER, XO_FREQ_2)]    = [](Impl& fx, size_t n, void* d) { return fx.crossover.set_frequency(1, n, d); };
+    h[TOVAL_param_index(CROSSOVER, XO_FREQ_3)]    = [](Impl& fx, size_t n, void* d) { return fx.crossover.set_frequency(2, n, d); };
+    h[TOVAL_param_index(CROSSOVER, XO_FREQ_4)]    = [](Impl& fx, size_t n, void* d) { return fx.crossover.set_frequency(3, n, d); };
+    h[TOVAL_param_index(CROSSOVER, XO_GAIN_1)]    = [](Impl& fx, size_t n, void* d) { return fx.crossover.set_band_gain(0, n, d); };
+    h[TOVAL_param_index(CROSSOVER, XO_GAIN_2)]    = [](Impl& fx, size_t n, void* d) { return fx.crossover.set_band_gain(1, n, d); };
+    h[TOVAL_param_index(CROSSOVER, XO_GAIN_3)]    = [](Impl& fx, size_t n, void* d) { return fx.crossover.set_band_gain(2, n, d); };
+    h[TOVAL_param_index(CROSSOVER, XO_GAIN_4)]    = [](Impl& fx, size_t n, void* d) { return fx.crossover.set_band_gain(3, n, d); };
+    h[TOVAL_param_index(CROSSOVER, XO_GAIN_5)]    = [](Impl& fx, size_t n, void* d) { return fx.crossover.set_band_gain(4, n, d); };
+
+    h[TOVAL_param_index(ANALYZER, AN_ENABLE)]    = [](Impl& fx, size_t n, void* d) { return fx.analyzer.set_enable(n, d); };
+    h[TOVAL_param_index(ANALYZER, AN_TAP_POINT)] = [](Impl& fx, size_t n, void* d) { return fx.analyzer.set_tap_point(n, d); };
+    h[TOVAL_param_index(ANALYZER, AN_FFT_SIZE)]  = [](Impl& fx, size_t n, void* d) { return fx.analyzer.set_fft_size(n, d); };
+    h[TOVAL_param_index(ANALYZER, AN_RATE)]      = [](Impl& fx, size_t n, void* d) { return fx.analyzer.set_rate(n, d); };
+
+    h[TOVAL_param_index(REVERB, RV_ENABLE)]  = [](Impl& fx, size_t n, void* d) { return fx.reverb.set_enable(n, d); };
+    h[TOVAL_param_index(REVERB, RV_DECAY)]   = [](Impl& fx, size_t n, void* d) { return fx.reverb.set_decay(n, d); };
+    h[TOVAL_param_index(REVERB, RV_SIZE)]    = [](Impl& fx, size_t n, void* d) { return fx.reverb.set_size(n, d); };
+    h[TOVAL_param_index(REVERB, RV_DAMPING)] = [](Impl& fx, size_t n, void* d) { return fx.reverb.set_damping(n, d); };
+    h[TOVAL_param_index(REVERB, RV_WET)]     = [](Impl& fx, size_t n, void* d) { return fx.reverb.set_wet(n, d); };
+    h[TOVAL_param_index(REVERB, RV_DENSITY)] = [](Impl& fx, size_t n, void* d) { return fx.reverb.set_density(n, d); };
+
+    h[TOVAL_param_index(FIR, FR_ENABLE)]   = [](Impl& fx, size_t n, void* d) { return fx.fir.set_enable(n, d); };
+    h[TOVAL_param_index(FIR, FR_TYPE)]     = [](Impl& fx, size_t n, void* d) { return fx.fir.set_type(n, d); };
+    h[TOVAL_param_index(FIR, FR_TAPS)]     = [](Impl& fx, size_t n, void* d) { return fx.fir.set_taps(n, d); };
+    h[TOVAL_param_index(FIR, FR_CUTOFF)]   = [](Impl& fx, size_t n, void* d) { return fx.fir.set_cutoff(n, d); };
+    h[TOVAL_param_index(FIR, FR_FRACTION)] = [](Impl& fx, size_t n, void* d) { return fx.fir.set_fraction(n, d); };
+    return h;
+  }();
+
+  if (handlers[index] == nullptr)
+  {
+    return TOVAL_ERROR::PARAMID_ERROR;
+  }
+  return handlers[index](*this, sizeof(bits), &bits);
+}
+
+// Read write rows report the last value set, read only rows are produced here
+uint32_t TOVAL_Effect::Impl::read_param(int index) const
+{
+  switch (index)
+  {
+    case TOVAL_param_index(GLOBAL, GLOBAL_ASYNC_LATENCY):
+      return async.running.load() ? async.latency : 0;
+
+    case TOVAL_param_index(GLOBAL, GLOBAL_ASYNC_UNDERRUNS):
+      return async.underruns.load(std::memory_order_relaxed);
+
+    case TOVAL_param_index(GLOBAL, GLOBAL_SETTLING_TIME):
+      return settling_samples();
+
+    case TOVAL_param_index(GLOBAL, GLOBAL_KERNEL_ACTIVE):
+      return kernel_isa.load(std::memory_order_relaxed);
+
+    case TOVAL_param_index(ANALYZER, AN_SEQUENCE):
+      return analyzer.published();
+
+    default:
+      return params.values[index].load(std::memory_order_relaxed);
+  }
+}
+
+// Blob rows are snapshots owned by their module, copied out whole
+TOVAL_ERROR TOVAL_Effect::Impl::read_blob(int index, size_t data_length, void* data)
+{
+  switch (index)
+  {
+    case TOVAL_param_index(HEADROOM, HR_METER):
+      return headroom.read_meter(data_length, data);
+
+    case TOVAL_param_index(ANALYZER, AN_SPECTRUM):
+      return analyzer.read_spectrum(data_length, data);
+
+    default:
+      return TOVAL_ERROR::PARAMID_ERROR;
+  }
+}
+
+// Points every module at one kernel table. A request above what the CPU runs falls back to the best it does.
+void TOVAL_Effect::Impl::bind_kernels(TOVAL_KernelIsa requested)
+{
+  const TOVAL_Kernels& kernels = kernels_select(requested);
+  headroom.set_kernels(kernels);
+  crossover.set_kernels(kernels);
+  delay.set_kernels(kernels);
+  src.in.set_kernels(kernels);
+  src.out.set_kernels(kernels);
+  src.sidechain.set_kernels(kernels);
+  pcm.converter.set_kernels(kernels);
+  kernel_isa.store(kernels.isa, std::memory_order_relaxed);
+}
+
+/*
+    Worst case frames before a freshly initialised instance produces the same output as one that has been
+    running, given the current settings. Offline renders pre-roll segments by this much. Worked out from
+    the published values rather than module state so it can be asked from any thread, and reflects sets
+    that have not reached the audio thread yet.
+*/
+uint32_t TOVAL_Effect::Impl::settling_samples() const
+{
+  auto f32 = [this](uint16_t module, uint16_t param) {
+    return std::bit_cast<float>(params.values[TOVAL_param_index(module, param)].load(std::memory_order_relaxed));
+  };
+  auto u32 = [this](uint16_t module, uint16_t param) {
+    return params.values[TOVAL_param_index(module, param)].load(std::memory_order_relaxed);
+  };
+
+  const float crossover_frequencies[] = { f32(CROSSOVER, XO_FREQ_1), f32(CROSSOVER, XO_FREQ_2), f32(CROSSOVER, XO_FREQ_3), f32(CROSSOVER, XO_FREQ_4) };
+
+  // Modules run in series, so their settling adds up
+  const uint32_t stages[] = {
+    headroom.settling_samples(f32(HEADROOM, HR_RAMP_TIME)),
+    fir.settling_samples(u32(FIR, FR_ENABLE), u32(FIR, FR_TAPS)),
+    compressor.settling_samples(u32(COMPRESSOR, CP_ENABLE), f32(COMPRESSOR, CP_ATTACK), f32(COMPRESSOR, CP_RELEASE), f32(COMPRESSOR, CP_RANGE)),
+    crossover.settling_samples(u32(CROSSOVER, XO_ENABLE), u32(CROSSOVER, XO_NUM_BANDS), crossover_frequencies),
+    delay.settling_samples(u32(DELAY, DL_ENABLE), f32(DELAY, DL_TIME), f32(DELAY, DL_FEEDBACK), f32(DELAY, DL_MOD_DEPTH)),
+    reverb.settling_samples(u32(REVERB, RV_ENABLE), f32(REVERB, RV_DECAY), f32(REVERB, RV_SIZE)),
+  };
+
+  double total = 0.0;
+  for (uint32_t stage : stages)
+  {
+    if (stage == TOVAL_SETTLE_NEVER)
+    {
+      return TOVAL_SETTLE_NEVER;
+    }
+    total += stage;
+  }
+
+  if (src.enabled)
+  {
+    // Chain frames are at the internal rate, plus the history of both converter filters and the fifo priming
+    const double host_per_internal = config.sample_rate / config.internal_sample_rate;
+    total = (total + src.out.history_length()) * host_per_internal + src.in.history_length() + src.prime;
+  }
+
+  return (total >= TOVAL_SETTLE_NEVER) ? TOVAL_SETTLE_NEVER - 1 : static_cast<uint32_t>(std::ceil(total));
+}
+
+void TOVAL_Effect::Impl::reset_params()
+{
+  for (size_t word = 0; word < params.dirty.size(); word++)
+  {
+    params.dirty[word].store(0, std::memory_order_relaxed);
+  }
+
+  for (size_t index = 0; index < TOVAL_PARAM_COUNT; index++)
+  {
+    const TOVAL_ParamDescriptor& desc = TOVAL_PARAM_TABLE[index];
+    if (desc.access == TOVAL_ParamAccess::READ_ONLY)
+    {
+      continue;
+    }
+
+    const uint32_t bits = (desc.type == TOVAL_ParamType::F32) ? std::bit_cast<uint32_t>(desc.def) : static_cast<uint32_t>(desc.def);
+    params.values[index].store(bits, std::memory_order_relaxed);
+    params.applied[index] = bits;
+    apply_param(static_cast<int>(index), bits);
+  }
+
+  params.applied_generation = params.generation.load(std::memory_order_acquire);
+}
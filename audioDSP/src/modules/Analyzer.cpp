@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "Analyzer.h"
+#include "TOVALparams.h"
+
+TOVAL_ERROR Analyzer::analyzer_init(float sample_rate, TOVAL_Arena& arena)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (sample_rate <= 0.0f)
+    {
+        return TOVAL_ERROR::CONFIG_ERROR;
+    }
+
+    // Two full windows of headroom so one late update does not drop frames
+    ret = ring.spsc_init(AN_NUM_CHANNELS, 2 * MAX_FFT_SIZE, arena);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        ret = fft.fft_init(MAX_FFT_SIZE, arena);
+    }
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        ret = spectra.triplebuffer_init(arena);
+    }
+    if (ret != TOVAL_ERROR::NO_ERROR)
+    {
+        return ret;
+    }
+
+    history = arena.alloc<float>(MAX_FFT_SIZE);
+    incoming = arena.alloc<float>(AN_NUM_CHANNELS * POP_CHUNK);
+    window = arena.alloc<float>(MAX_FFT_SIZE);
+    frame = arena.alloc<float>(MAX_FFT_SIZE);
+    re = arena.alloc<float>(MAX_BINS);
+    im = arena.alloc<float>(MAX_BINS);
+    if (arena.failed())
+    {
+        return TOVAL_ERROR::MEMORY_ERROR;
+    }
+
+    this->sample_rate = sample_rate;
+    enable = 0;
+    tap_point = TOVAL_AnalyzerTap::AN_TAP_OUTPUT;
+    fft_size.store(2048, std::memory_order_relaxed);
+    rate.store(20.0f, std::memory_order_relaxed);
+    history_write = 0;
+    history_filled = 0;
+    since_last = 0;
+    sequence = 0;
+    sequence_published.store(0, std::memory_order_relaxed);
+    fft.set_size(2048);
+    build_window(2048);
+
+    return ret;
+}
+
+// Periodic Hann
+void Analyzer::build_window(size_t size)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < size; i++)
+    {
+        window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * 3.14159265358979323846 * static_cast<double>(i) / static_cast<double>(size)));
+        sum += window[i];
+    }
+    window_scale = static_cast<float>(2.0 / sum);
+}
+
+TOVAL_ERROR Analyzer::set_enable(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (data_length != sizeof(enable))
+    {
+        ret = TOVAL_ERROR::SIZE_ERROR;
+    }
+    else if (data == nullptr)
+    {
+        ret = TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    else
+    {
+        enable = *static_cast<const uint32_t*>(data) ? 1 : 0;
+    }
+    return ret;
+}
+
+static_assert(TOVAL_param_descriptor(ANALYZER, AN_TAP_POINT).max == static_cast<float>(TOVAL_AnalyzerTap::AN_TAP_OUTPUT), "AN_TAP_POINT row must cover every TOVAL_AnalyzerTap");
+
+TOVAL_ERROR Analyzer::set_tap_point(size_t data_length, void* data)
+{
+    return TOVAL_param_read<ANALYZER, AN_TAP_POINT>(data_length, data, tap_point);
+}
+
+static_assert(TOVAL_param_descriptor(ANALYZER, AN_FFT_SIZE).max == static_cast<float>(Analyzer::MAX_FFT_SIZE), "AN_FFT_SIZE row must end at MAX_FFT_SIZE");
+
+TOVAL_ERROR Analyzer::set_fft_size(size_t data_length, void* data)
+{
+    uint32_t value = 0;
+    TOVAL_ERROR ret = TOVAL_param_read<ANALYZER, AN_FFT_SIZE>(data_length, data, value);     // the row's POW2 flag checks the power of two
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        fft_size.store(value, std::memory_order_relaxed);     // picked up by the next analyzer_update
+    }
+    return ret;
+}
+
+TOVAL_ERROR Analyzer::set_rate(size_t data_length, void* data)
+{
+    float value = 0.0f;
+    TOVAL_ERROR ret = TOVAL_param_read<ANALYZER, AN_RATE>(data_length, data, value);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        rate.store(value, std::memory_order_relaxed);
+    }
+    return ret;
+}
+
+bool Analyzer::analyzer_update()
+{
+    const size_t size = fft_size.load(std::memory_order_relaxed);
+    if (size != fft.size())
+    {
+        fft.set_size(size);
+        build_window(size);
+        since_last = 0;
+    }
+
+    // Drain everything queued into the mono history, only the newest MAX_FFT_SIZE frames are kept
+    constexpr size_t HISTORY_MASK = MAX_FFT_SIZE - 1;
+    float* pIncoming[AN_NUM_CHANNELS] = { &incoming[0], &incoming[POP_CHUNK] };
+    size_t got = 0;
+    while ((got = ring.pop(pIncoming, POP_CHUNK)) > 0)
+    {
+        for (size_t i = 0; i < got; i++)
+        {
+            history[history_write] = 0.5f * (pIncoming[AN_LEFT][i] + pIncoming[AN_RIGHT][i]);
+            history_write = (history_write + 1) & HISTORY_MASK;
+        }
+        history_filled = std::min(history_filled + got, MAX_FFT_SIZE);
+        since_last += got;
+    }
+
+    const size_t hop = std::max<size_t>(1, static_cast<size_t>(sample_rate / rate.load(std::memory_order_relaxed)));
+    if (history_filled < size || since_last < hop)
+    {
+        return false;
+    }
+    since_last = 0;
+
+    const size_t start = history_write + MAX_FFT_SIZE - size;
+    for (size_t i = 0; i < size; i++)
+    {
+        frame[i] = history[(start + i) & HISTORY_MASK] * window[i];
+    }
+    fft.forward(frame.data(), re.data(), im.data());
+
+    TOVAL_Spectrum& spectrum = spectra.write_slot();
+    spectrum.bins = static_cast<uint32_t>(fft.bins());
+    spectrum.sequence = ++sequence;
+    for (size_t k = 0; k < fft.bins(); k++)
+    {
+        const float magnitude = std::sqrt(re[k] * re[k] + im[k] * im[k]) * window_scale;
+        spectrum.magnitude_db[k] = 20.0f * std::log10(std::max(magnitude, 1.0e-10f));     // -200 dB floor
+    }
+    spectra.publish();
+    sequence_published.store(sequence, std::memory_order_relaxed);
+    return true;
+}
+
+TOVAL_ERROR Analyzer::read_spectrum(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (data_length != sizeof(TOVAL_Spectrum))
+    {
+        ret = TOVAL_ERROR::SIZE_ERROR;
+    }
+    else if (data == nullptr)
+    {
+        ret = TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    else
+    {
+        while (reading.test_and_set(std::memory_order_acquire))
+        {
+            reading.wait(true, std::memory_order_relaxed);
+        }
+        std::memcpy(data, &spectra.read_slot(), sizeof(TOVAL_Spectrum));
+        reading.clear(std::memory_order_release);
+        reading.notify_one();
+    }
+    return ret;
+}
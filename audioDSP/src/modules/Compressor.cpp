@@ -0,0 +1,418 @@
+#include <algorithm>
+#include <cmath>
+#include "Compressor.h"
+#include "TOVALparams.h"
+#include "TOVALsimd.h"
+
+namespace {
+
+constexpr float LOG2_PER_DB = 0.166096405f;     // 1 / (20 log10(2))
+constexpr float MIN_LEVEL = 1.0e-9f;            // -180 dB, keeps log2 off zero and denormals
+
+/*
+    Attack / release one pole on the reduction, in place over n frames for each detector.
+    Both candidates come straight off y, and the right one is always the lower when attack is the
+    faster of the two: attack pulls y down harder when the target is below it, release lifts it less
+    when the target is above. So a min picks the coefficient, with no compare on the recursion and
+    only a multiply-add and the min in its dependency chain. An attack slower than release flips it
+    to a max. Detectors run in the same loop so their chains overlap.
+*/
+template <bool FastAttack, int Detectors>
+void smooth(float* const* pGain, float* envelope, size_t n, float attack, float release)
+{
+    const float attack_in = 1.0f - attack;
+    const float release_in = 1.0f - release;
+
+    float y[Detectors];
+    std::copy(envelope, envelope + Detectors, y);
+    for (size_t i = 0; i < n; i++)
+    {
+        for (int d = 0; d < Detectors; d++)
+        {
+            const float target = pGain[d][i];
+            const float attacking = attack * y[d] + attack_in * target;
+            const float releasing = release * y[d] + release_in * target;
+            y[d] = FastAttack ? std::min(attacking, releasing) : std::max(attacking, releasing);
+            pGain[d][i] = y[d];
+        }
+    }
+    std::copy(y, y + Detectors, envelope);
+}
+
+} // namespace
+
+TOVAL_ERROR Compressor::compressor_init(float sample_rate, TOVAL_Arena& arena)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (sample_rate <= 0.0f)
+    {
+        return TOVAL_ERROR::CONFIG_ERROR;
+    }
+
+    envelope = arena.alloc<float>(CP_NUM_CHANNELS);
+    gain = arena.alloc<float>(CP_NUM_CHANNELS * CHUNK);
+    if (arena.failed())
+    {
+        return TOVAL_ERROR::MEMORY_ERROR;
+    }
+
+    this->sample_rate = sample_rate;
+    enable = 0;
+    mode = TOVAL_CompressorMode::CP_MODE_COMPRESS;
+    link = 1;
+    sidechain = 0;
+    threshold_db = -18.0f;
+    ratio = 4.0f;
+    knee_db = 6.0f;
+    attack_ms = 10.0f;
+    release_ms = 100.0f;
+    makeup_db = 0.0f;
+    range_db = 60.0f;
+    update_curve();
+
+    return ret;
+}
+
+// Everything the process loop needs, moved into log2 units once here rather than per sample
+void Compressor::update_curve()
+{
+    const bool expand = (mode == TOVAL_CompressorMode::CP_MODE_EXPAND);
+    threshold = threshold_db * LOG2_PER_DB;
+    direction = expand ? -1.0f : 1.0f;
+    slope = expand ? (1.0f - ratio) : (1.0f / ratio - 1.0f);
+    knee = std::max(knee_db * LOG2_PER_DB, 1.0e-6f);     // 0 dB is a hard knee, kept off the divide
+    half_knee = 0.5f * knee;
+    inv_twice_knee = 0.5f / knee;
+    floor_gain = -range_db * LOG2_PER_DB;
+    makeup = makeup_db * LOG2_PER_DB;
+    coefficients[0] = time_coefficient(release_ms);
+    coefficients[1] = time_coefficient(attack_ms);
+}
+
+float Compressor::time_coefficient(float ms) const
+{
+    return std::exp(-1000.0f / (ms * sample_rate));
+}
+
+uint32_t Compressor::settling_samples(uint32_t enable, float attack_ms, float release_ms, float range_db) const
+{
+    if (!enable)
+    {
+        return 0;
+    }
+
+    // Worst case the envelope sits at full range and decays until 2^envelope is within TOVAL_SETTLE_LEVEL of 1
+    const double start = std::max(range_db * LOG2_PER_DB, 1.0e-3f);
+    const double end = std::log2(1.0 + TOVAL_SETTLE_LEVEL);
+    const double tau = std::max(attack_ms, release_ms) * sample_rate / 1000.0;
+    return static_cast<uint32_t>(std::ceil(tau * std::max(std::log(start / end), 0.0)));
+}
+
+TOVAL_ERROR Compressor::set_enable(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (data_length != sizeof(enable))
+    {
+        ret = TOVAL_ERROR::SIZE_ERROR;
+    }
+    else if (data == nullptr)
+    {
+        ret = TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    else
+    {
+        uint32_t value = *static_cast<const uint32_t*>(data) ? 1 : 0;
+        if (value && !enable)
+        {
+            std::fill(envelope.begin(), envelope.end(), 0.0f);     // start from unity, not the reduction held at bypass
+        }
+        enable = value;
+    }
+    return ret;
+}
+
+static_assert(TOVAL_param_descriptor(COMPRESSOR, CP_MODE).max == static_cast<float>(TOVAL_CompressorMode::CP_MODE_EXPAND), "CP_MODE row must cover every TOVAL_CompressorMode");
+
+TOVAL_ERROR Compressor::set_mode(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_param_read<COMPRESSOR, CP_MODE>(data_length, data, mode);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        update_curve();
+    }
+    return ret;
+}
+
+TOVAL_ERROR Compressor::set_threshold(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_param_read<COMPRESSOR, CP_THRESHOLD>(data_length, data, threshold_db);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        update_curve();
+    }
+    return ret;
+}
+
+TOVAL_ERROR Compressor::set_ratio(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_param_read<COMPRESSOR, CP_RATIO>(data_length, data, ratio);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        update_curve();
+    }
+    return ret;
+}
+
+TOVAL_ERROR Compressor::set_knee(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_param_read<COMPRESSOR, CP_KNEE>(data_length, data, knee_db);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        update_curve();
+    }
+    return ret;
+}
+
+TOVAL_ERROR Compressor::set_attack(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_param_read<COMPRESSOR, CP_ATTACK>(data_length, data, attack_ms);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        update_curve();
+    }
+    return ret;
+}
+
+TOVAL_ERROR Compressor::set_release(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_param_read<COMPRESSOR, CP_RELEASE>(data_length, data, release_ms);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        update_curve();
+    }
+    return ret;
+}
+
+TOVAL_ERROR Compressor::set_makeup(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_param_read<COMPRESSOR, CP_MAKEUP>(data_length, data, makeup_db);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        update_curve();
+    }
+    return ret;
+}
+
+TOVAL_ERROR Compressor::set_range(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_param_read<COMPRESSOR, CP_RANGE>(data_length, data, range_db);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        update_curve();
+    }
+    return ret;
+}
+
+TOVAL_ERROR Compressor::set_link(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (data_length != sizeof(link))
+    {
+        ret = TOVAL_ERROR::SIZE_ERROR;
+    }
+    else if (data == nullptr)
+    {
+        ret = TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    else
+    {
+        uint32_t value = *static_cast<const uint32_t*>(data) ? 1 : 0;
+        if (value && !link)
+        {
+            envelope[0] = std::min(envelope[0], envelope[1]);   // carry on from the channel reducing most
+        }
+        else if (!value && link)
+        {
+            envelope[1] = envelope[0];
+        }
+        link = value;
+    }
+    return ret;
+}
+
+TOVAL_ERROR Compressor::set_sidechain(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (data_length != sizeof(sidechain))
+    {
+        ret = TOVAL_ERROR::SIZE_ERROR;
+    }
+    else if (data == nullptr)
+    {
+        ret = TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    else
+    {
+        sidechain = *static_cast<const uint32_t*>(data) ? 1 : 0;
+    }
+    return ret;
+}
+
+void Compressor::gain_computer(const AudioBlockView& key, uint16_t first, uint16_t count, size_t start, size_t n, float* pGain) const
+{
+    using namespace simd;
+
+    const f32x4 min_level = set1(MIN_LEVEL);
+    const f32x4 dir = set1(direction);
+    const f32x4 thresh = set1(threshold);
+    const f32x4 half = set1(half_knee);
+    const f32x4 knee_span = set1(knee);
+    const f32x4 inv_width = set1(inv_twice_knee);
+    const f32x4 gain_slope = set1(slope);
+    const f32x4 gain_floor = set1(floor_gain);
+
+    for (size_t i = 0; i < n; i += width)
+    {
+        // Peak over the keyed channels. The last group of a block not a multiple of 4 goes through a
+        // padded copy so every frame takes the same vector path.
+        f32x4 peak = zero();
+        for (uint16_t ch = first; ch < first + count; ch++)
+        {
+            const float* pKey = key.channel(ch) + start + i;
+            f32x4 x;
+            if (i + width <= n)
+            {
+                x = load(pKey);
+            }
+            else
+            {
+                float padded[width] = {};
+                std::copy(pKey, pKey + (n - i), padded);
+                x = load(padded);
+            }
+            peak = max(peak, abs(x));
+        }
+
+        // Soft knee: 0 below, over above, (over + W/2)^2 / 2W inside, built from clamps only
+        const f32x4 level = log2_approx(max(peak, min_level));
+        const f32x4 over = mul(dir, sub(level, thresh));
+        const f32x4 in_knee = min(max(add(over, half), zero()), knee_span);
+        const f32x4 shaped = madd(mul(in_knee, in_knee), inv_width, max(sub(over, half), zero()));
+        store(pGain + i, max(mul(gain_slope, shaped), gain_floor));
+    }
+}
+
+TOVAL_ERROR Compressor::compressor_process(float **ppIn, float **ppOut, size_t nspc)
+{
+    if (ppIn == nullptr || ppOut == nullptr)
+    {
+        return TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    return compressor_process(AudioBlockView(ppIn, num_channels, nspc), AudioBlockView(ppOut, num_channels, nspc));
+}
+
+TOVAL_ERROR Compressor::compressor_process(const AudioBlockView& in, const AudioBlockView& out, const AudioBlockView* sidechain_in)
+{
+    TOVAL_ERROR error = TOVAL_ERROR::NO_ERROR;
+    if (in.raw() == nullptr || out.raw() == nullptr)
+    {
+        return TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    if (in.num_channels() < CompressorChannels::CP_NUM_CHANNELS || out.num_channels() < CompressorChannels::CP_NUM_CHANNELS
+        || out.num_frames() < in.num_frames())
+    {
+        return TOVAL_ERROR::SIZE_ERROR;
+    }
+
+    for (int ch = 0; ch < CompressorChannels::CP_NUM_CHANNELS; ++ch)
+    {
+        if (in.channel(ch) == nullptr || out.channel(ch) == nullptr)
+        {
+            return TOVAL_ERROR::NULL_POINTER_ERROR;
+        }
+    }
+
+    const size_t nspc = in.num_frames();
+
+    if (!enable)
+    {
+        for (int ch = 0; ch < CompressorChannels::CP_NUM_CHANNELS; ++ch)
+        {
+            if (out.channel(ch) != in.channel(ch))
+            {
+                std::memcpy(out.channel(ch), in.channel(ch), sizeof(float) * nspc);
+            }
+        }
+        return error;
+    }
+
+    const bool external = sidechain && sidechain_in != nullptr && sidechain_in->raw() != nullptr
+                          && sidechain_in->num_channels() > 0 && sidechain_in->num_frames() >= nspc;
+    const AudioBlockView& key = external ? *sidechain_in : in;
+    const uint16_t key_channels = external ? sidechain_in->num_channels() : static_cast<uint16_t>(CP_NUM_CHANNELS);
+    const uint16_t detectors = link ? 1 : static_cast<uint16_t>(CP_NUM_CHANNELS);
+
+    for (size_t start = 0; start < nspc; start += CHUNK)
+    {
+        const size_t n = std::min(nspc - start, CHUNK);
+
+        float* pGain[CP_NUM_CHANNELS];
+        for (uint16_t d = 0; d < detectors; d++)
+        {
+            pGain[d] = &gain[d * CHUNK];
+            if (link)
+            {
+                gain_computer(key, 0, key_channels, start, n, pGain[d]);
+            }
+            else
+            {
+                gain_computer(key, std::min<uint16_t>(d, key_channels - 1), 1, start, n, pGain[d]);
+            }
+        }
+
+        const bool fast_attack = coefficients[1] <= coefficients[0];
+        if (link)
+        {
+            fast_attack ? smooth<true, 1>(pGain, envelope.data(), n, coefficients[1], coefficients[0])
+                        : smooth<false, 1>(pGain, envelope.data(), n, coefficients[1], coefficients[0]);
+        }
+        else
+        {
+            fast_attack ? smooth<true, CP_NUM_CHANNELS>(pGain, envelope.data(), n, coefficients[1], coefficients[0])
+                        : smooth<false, CP_NUM_CHANNELS>(pGain, envelope.data(), n, coefficients[1], coefficients[0]);
+        }
+
+        // Back to linear. The scratch is CHUNK long, so a partial last group stays inside it.
+        const simd::f32x4 makeup_gain = simd::set1(makeup);
+        for (uint16_t d = 0; d < detectors; d++)
+        {
+            for (size_t i = 0; i < n; i += simd::width)
+            {
+                simd::store(pGain[d] + i, simd::exp2_approx(simd::add(simd::load(pGain[d] + i), makeup_gain)));
+            }
+        }
+
+        for (int ch = 0; ch < CompressorChannels::CP_NUM_CHANNELS; ++ch)
+        {
+            const float* pIn = in.channel(ch) + start;
+            float* pOut = out.channel(ch) + start;
+            const float* pGain = &gain[(link ? 0 : ch) * CHUNK];
+
+            size_t i = 0;
+            for (; i + simd::width <= n; i += simd::width)
+            {
+                simd::store(pOut + i, simd::mul(simd::load(pIn + i), simd::load(pGain + i)));
+            }
+            for (; i < n; i++)
+            {
+                pOut[i] = pIn[i] * pGain[i];
+            }
+        }
+    }
+
+    return error;
+}
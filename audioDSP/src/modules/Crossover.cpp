@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cmath>
+#include "Crossover.h"
+#include "TOVALparams.h"
+#include "TOVALsimd.h"
+#include "conversionFN.h"
+
+TOVAL_ERROR Crossover::crossover_init(float sample_rate, TOVAL_Arena& arena)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (sample_rate <= 0.0f)
+    {
+        return TOVAL_ERROR::CONFIG_ERROR;
+    }
+
+    ret = splitter.lrcrossover_init(sample_rate, XO_NUM_CHANNELS, arena);
+    if (ret != TOVAL_ERROR::NO_ERROR)
+    {
+        return ret;
+    }
+    bands = arena.alloc<float>(XO_NUM_CHANNELS * CHUNK * LRCrossover::LANES);    // one per channel, channels may run in parallel
+    if (arena.failed())
+    {
+        return TOVAL_ERROR::MEMORY_ERROR;
+    }
+
+    this->sample_rate = sample_rate;
+    enable = 0;
+    num_bands = 3;
+    const float default_frequency[MAX_BANDS - 1] = { 200.0f, 2000.0f, 6000.0f, 12000.0f };
+    for (uint32_t j = 0; j < MAX_BANDS - 1; j++)
+    {
+        frequency[j] = default_frequency[j];
+    }
+    for (uint32_t band = 0; band < MAX_BANDS; band++)
+    {
+        gain_db[band] = 0.0f;
+        gain_target[band] = 1.0f;
+        gain_current[band] = 1.0f;
+    }
+    update_bands();
+
+    return ret;
+}
+
+void Crossover::set_kernels(const TOVAL_Kernels& table)
+{
+    splitter.set_kernels(table);
+}
+
+// Splitter wants ascending frequencies below Nyquist, the params can be set in any order
+void Crossover::update_bands()
+{
+    const uint32_t count = std::clamp<uint32_t>(num_bands, 2, MAX_BANDS) - 1;
+    float sorted[MAX_BANDS - 1];
+    std::copy(frequency, frequency + count, sorted);
+    std::sort(sorted, sorted + count);
+
+    const float limit = 0.45f * sample_rate;
+    for (uint32_t j = 0; j < count; j++)
+    {
+        sorted[j] = std::min(sorted[j], limit);
+    }
+    splitter.set_bands(num_bands, sorted);
+}
+
+uint32_t Crossover::settling_samples(uint32_t enable, uint32_t num_bands, const float* frequencies) const
+{
+    if (!enable || num_bands < 2 || num_bands > MAX_BANDS)
+    {
+        return 0;
+    }
+
+    // Butterworth poles decay at w / sqrt(2). The cascade of up to eight repeated poles rings for a few
+    // time constants longer than one, so double the single pole figure.
+    const float lowest = *std::min_element(frequencies, frequencies + num_bands - 1);
+    const double decay_per_sample = 2.0 * 3.14159265358979323846 * std::max(lowest, 1.0f) / (std::sqrt(2.0) * sample_rate);
+    return static_cast<uint32_t>(std::ceil(2.0 * std::log(1.0 / TOVAL_SETTLE_LEVEL) / decay_per_sample));
+}
+
+TOVAL_ERROR Crossover::set_enable(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (data_length != sizeof(enable))
+    {
+        ret = TOVAL_ERROR::SIZE_ERROR;
+    }
+    else if (data == nullptr)
+    {
+        ret = TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    else
+    {
+        uint32_t value = *static_cast<const uint32_t*>(data) ? 1 : 0;
+        if (value && !enable)
+        {
+            splitter.lrcrossover_reset();   // no ringing left over from before the bypass
+        }
+        enable = value;
+    }
+    return ret;
+}
+
+TOVAL_ERROR Crossover::set_num_bands(size_t data_length, void* data)
+{
+    static_assert(TOVAL_param_descriptor(CROSSOVER, XO_NUM_BANDS).max == static_cast<float>(MAX_BANDS), "XO_NUM_BANDS row must end at MAX_BANDS");
+
+    uint32_t value = 0;
+    TOVAL_ERROR ret = TOVAL_param_read<CROSSOVER, XO_NUM_BANDS>(data_length, data, value);
+    if (ret == TOVAL_ERROR::NO_ERROR && value != num_bands)
+    {
+        num_bands = value;
+        update_bands();
+        splitter.lrcrossover_reset();   // band layout changed, old state belongs to other filters
+    }
+    return ret;
+}
+
+TOVAL_ERROR Crossover::set_frequency(uint32_t index, size_t data_length, void* data)
+{
+    if (index >= MAX_BANDS - 1)
+    {
+        return TOVAL_ERROR::PARAMID_ERROR;
+    }
+
+    TOVAL_ERROR ret = TOVAL_param_read(TOVAL_param_descriptor(CROSSOVER, XO_FREQ_1 + index), data_length, data, frequency[index]);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        update_bands();
+    }
+    return ret;
+}
+
+TOVAL_ERROR Crossover::set_band_gain(uint32_t band, size_t data_length, void* data)
+{
+    if (band >= MAX_BANDS)
+    {
+        return TOVAL_ERROR::PARAMID_ERROR;
+    }
+
+    TOVAL_ERROR ret = TOVAL_param_read(TOVAL_param_descriptor(CROSSOVER, XO_GAIN_1 + band), data_length, data, gain_db[band]);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        gain_target[band] = dbToLinear(gain_db[band]);
+    }
+    return ret;
+}
+
+TOVAL_ERROR Crossover::crossover_process(float **ppIn, float **ppOut, size_t nspc)
+{
+    if (ppIn == nullptr || ppOut == nullptr)
+    {
+        return TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    return crossover_process(AudioBlockView(ppIn, num_channels, nspc), AudioBlockView(ppOut, num_channels, nspc));
+}
+
+TOVAL_ERROR Crossover::crossover_process(const AudioBlockView& in, const AudioBlockView& out)
+{
+    TOVAL_ERROR error = crossover_check(in, out);
+    if (error != TOVAL_ERROR::NO_ERROR)
+    {
+        return error;
+    }
+
+    for (uint16_t ch = 0; ch < CrossoverChannels::XO_NUM_CHANNELS; ++ch)
+    {
+        crossover_process_channel(in, out, ch);
+    }
+
+    crossover_end_block(in.num_frames());
+    return error;
+}
+
+TOVAL_ERROR Crossover::crossover_check(const AudioBlockView& in, const AudioBlockView& out) const
+{
+    if (in.raw() == nullptr || out.raw() == nullptr)
+    {
+        return TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    if (in.num_channels() < CrossoverChannels::XO_NUM_CHANNELS || out.num_channels() < CrossoverChannels::XO_NUM_CHANNELS
+        || out.num_frames() < in.num_frames())
+    {
+        return TOVAL_ERROR::SIZE_ERROR;
+    }
+
+    for (uint16_t ch = 0; ch < CrossoverChannels::XO_NUM_CHANNELS; ++ch)
+    {
+        if (in.channel(ch) == nullptr || out.channel(ch) == nullptr)
+        {
+            return TOVAL_ERROR::NULL_POINTER_ERROR;
+        }
+    }
+    return TOVAL_ERROR::NO_ERROR;
+}
+
+// One channel through every chunk. Gains ramp across the first chunk only, from gain_current, which
+// stays put until crossover_end_block so every channel ramps the same way whatever order they run in.
+void Crossover::crossover_process_channel(const AudioBlockView& in, const AudioBlockView& out, uint16_t ch)
+{
+    const size_t nspc = in.num_frames();
+
+    if (!enable)
+    {
+        if (out.channel(ch) != in.channel(ch))
+        {
+            std::memcpy(out.channel(ch), in.channel(ch), sizeof(float) * nspc);
+        }
+        return;
+    }
+
+    simd::FlushDenormals flush;     // highpass bands decay into denormals on DC and silence, per thread
+    constexpr size_t LANES = LRCrossover::LANES;
+    float* pBands = &bands[ch * CHUNK * LANES];
+    const float* start_gain = gain_current;
+
+    for (size_t start = 0; start < nspc; start += CHUNK)
+    {
+        const size_t n = std::min(nspc - start, CHUNK);
+        float* pOut = out.channel(ch) + start;
+        splitter.split(ch, in.channel(ch) + start, pBands, n);
+
+        float gain[MAX_BANDS];
+        float step[MAX_BANDS];
+        for (uint32_t band = 0; band < num_bands; band++)
+        {
+            gain[band] = start_gain[band];
+            step[band] = (gain_target[band] - start_gain[band]) / static_cast<float>(n);
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            float sum = 0.0f;
+            for (uint32_t band = 0; band < num_bands; band++)
+            {
+                gain[band] += step[band];
+                sum += pBands[i * LANES + band] * gain[band];
+            }
+            pOut[i] = sum;
+        }
+
+        start_gain = gain_target;
+    }
+}
+
+void Crossover::crossover_end_block(size_t nspc)
+{
+    if (enable && nspc > 0)
+    {
+        std::copy(gain_target, gain_target + MAX_BANDS, gain_current);
+    }
+}
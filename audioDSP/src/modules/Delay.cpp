@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <iostream>
+#include "Delay.h"
+using namespace std;
+
+static constexpr float TWO_PI = 6.28318530717958647692f;
+
+TOVAL_ERROR Delay::delay_init(float sample_rate, TOVAL_Arena& arena)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (sample_rate <= 0.0f)
+    {
+        return TOVAL_ERROR::CONFIG_ERROR;
+    }
+    this->sample_rate = sample_rate;
+
+    const size_t max_delay = static_cast<size_t>((MAX_TIME_MS + MAX_MOD_DEPTH_MS) * sample_rate / 1000.0f) + DelayLine::GUARD;
+
+    lines = arena.alloc<DelayLine>(DL_NUM_CHANNELS);
+    delay_curve = arena.alloc<float>(TOVAL_MAX_BLOCK_SIZE);
+    wet = arena.alloc<float>(DL_NUM_CHANNELS * TOVAL_MAX_BLOCK_SIZE);      // per channel, channels may run in parallel
+    feed = arena.alloc<float>(DL_NUM_CHANNELS * TOVAL_MAX_BLOCK_SIZE);
+    if (arena.failed())
+    {
+        return TOVAL_ERROR::MEMORY_ERROR;
+    }
+
+    for (int ch = 0; ch < DL_NUM_CHANNELS && ret == TOVAL_ERROR::NO_ERROR; ch++)
+    {
+        ret = lines[ch].delayline_init(max_delay, arena);
+    }
+    if (ret != TOVAL_ERROR::NO_ERROR)
+    {
+        return ret;
+    }
+
+    enable = 0;
+    interpolation = TOVAL_DelayInterp::DL_INTERP_LINEAR;
+    time_ms = 250.0f;
+    feedback = 0.3f;
+    mix = 0.3f;
+    mod_depth_ms = 0.0f;
+    mod_rate_hz = 0.5f;
+
+    lfo_sin = 0.0f;
+    lfo_cos = 1.0f;
+    update_lfo_increment();
+
+    kernels = &kernels_select(KERNEL_ISA_AUTO);
+
+    return ret;
+}
+
+void Delay::set_kernels(const TOVAL_Kernels& table)
+{
+    kernels = &table;
+}
+
+void Delay::update_lfo_increment()
+{
+    const float w = TWO_PI * mod_rate_hz / sample_rate;
+    lfo_rot_sin = std::sin(w);
+    lfo_rot_cos = std::cos(w);
+}
+
+uint32_t Delay::settling_samples(uint32_t enable, float time_ms, float feedback, float mod_depth_ms) const
+{
+    if (!enable)
+    {
+        return 0;   // the lines are not touched while bypassed
+    }
+    if (mod_depth_ms > 0.0f)
+    {
+        return TOVAL_SETTLE_NEVER;  // LFO phase depends on how long the instance has been running
+    }
+
+    // Every echo is one more trip round the line, scaled by feedback
+    const float echoes = (feedback > 0.0f) ? std::ceil(std::log(TOVAL_SETTLE_LEVEL) / std::log(feedback)) : 0.0f;
+    const double samples = (echoes + 1.0) * std::ceil(time_ms * sample_rate / 1000.0f);
+    return (samples >= TOVAL_SETTLE_NEVER) ? TOVAL_SETTLE_NEVER : static_cast<uint32_t>(samples);
+}
+
+TOVAL_ERROR Delay::set_enable(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (data_length != sizeof(enable))
+    {
+        ret = TOVAL_ERROR::SIZE_ERROR;
+    }
+    else if (data == nullptr)
+    {
+        ret = TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    else
+    {
+        uint32_t value = *static_cast<const uint32_t*>(data) ? 1 : 0;
+        if (value && !enable)
+        {
+            for (auto& line : lines)
+            {
+                line.delayline_reset();     // don't replay stale audio from before the bypass
+            }
+        }
+        enable = value;
+    }
+    return ret;
+}
+
+TOVAL_ERROR Delay::set_time(size_t data_length, void* data)
+{
+    return TOVAL_param_read<DELAY, DL_TIME>(data_length, data, time_ms);
+}
+
+TOVAL_ERROR Delay::set_feedback(size_t data_length, void* data)
+{
+    // The row stops short of 1, which never decays
+    return TOVAL_param_read<DELAY, DL_FEEDBACK>(data_length, data, feedback);
+}
+
+TOVAL_ERROR Delay::set_mix(size_t data_length, void* data)
+{
+    return TOVAL_param_read<DELAY, DL_MIX>(data_length, data, mix);
+}
+
+TOVAL_ERROR Delay::set_mod_depth(size_t data_length, void* data)
+{
+    return TOVAL_param_read<DELAY, DL_MOD_DEPTH>(data_length, data, mod_depth_ms);
+}
+
+TOVAL_ERROR Delay::set_mod_rate(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_param_read<DELAY, DL_MOD_RATE>(data_length, data, mod_rate_hz);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        update_lfo_increment();
+    }
+    return ret;
+}
+
+static_assert(TOVAL_param_descriptor(DELAY, DL_INTERPOLATION).max == static_cast<float>(TOVAL_DelayInterp::DL_INTERP_CUBIC), "DL_INTERPOLATION row must cover every TOVAL_DelayInterp");
+
+TOVAL_ERROR Delay::set_interpolation(size_t data_length, void* data)
+{
+    return TOVAL_param_read<DELAY, DL_INTERPOLATION>(data_length, data, interpolation);
+}
+
+TOVAL_ERROR Delay::delay_process(float **ppIn, float **ppOut, size_t nspc)
+{
+    if (ppIn == nullptr || ppOut == nullptr)
+    {
+        return TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    return delay_process(AudioBlockView(ppIn, num_channels, nspc), AudioBlockView(ppOut, num_channels, nspc));
+}
+
+TOVAL_ERROR Delay::delay_process(const AudioBlockView& in, const AudioBlockView& out)
+{
+    TOVAL_ERROR error = delay_check(in, out);
+    if (error != TOVAL_ERROR::NO_ERROR)
+    {
+        return error;
+    }
+
+    const size_t nspc = in.num_frames();
+    for (size_t block_start = 0; block_start < nspc; block_start += TOVAL_MAX_BLOCK_SIZE)
+    {
+        const size_t block = std::min<size_t>(nspc - block_start, TOVAL_MAX_BLOCK_SIZE);
+
+        delay_begin_block(block);
+        for (uint16_t ch = 0; ch < DelayChannels::DL_NUM_CHANNELS; ++ch)
+        {
+            delay_process_channel(in.slice(block_start, block), out.slice(block_start, block), ch);
+        }
+    }
+
+    return error;
+}
+
+TOVAL_ERROR Delay::delay_check(const AudioBlockView& in, const AudioBlockView& out) const
+{
+    if (in.raw() == nullptr || out.raw() == nullptr)
+    {
+        return TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    if (in.num_channels() < DelayChannels::DL_NUM_CHANNELS || out.num_channels() < DelayChannels::DL_NUM_CHANNELS
+        || out.num_frames() < in.num_frames())
+    {
+        return TOVAL_ERROR::SIZE_ERROR;
+    }
+
+    for (uint16_t ch = 0; ch < DelayChannels::DL_NUM_CHANNELS; ++ch)
+    {
+        if (in.channel(ch) == nullptr || out.channel(ch) == nullptr)
+        {
+            return TOVAL_ERROR::NULL_POINTER_ERROR;
+        }
+    }
+    return TOVAL_ERROR::NO_ERROR;
+}
+
+// Delay curve for the next block, identical for every channel, and the LFO advanced past it
+void Delay::delay_begin_block(size_t block)
+{
+    if (!enable)
+    {
+        return;
+    }
+
+    const float samples_per_ms = sample_rate / 1000.0f;
+    const float depth = mod_depth_ms * samples_per_ms;
+    const float base = std::max(time_ms * samples_per_ms, depth + 3.0f);     // keep the interpolation window behind the write head
+
+    // Longest stretch that can be read before any of it has to be written
+    chunk_limit = std::max<size_t>(1, static_cast<size_t>(base - depth) - 2);
+
+    float s = lfo_sin;
+    float c = lfo_cos;
+    for (size_t i = 0; i < block; ++i)
+    {
+        delay_curve[i] = base + depth * s;
+        const float s_next = s * lfo_rot_cos + c * lfo_rot_sin;
+        c = c * lfo_rot_cos - s * lfo_rot_sin;
+        s = s_next;
+    }
+    const float norm = 1.5f - 0.5f * (s * s + c * c);   // pull the rotation back onto the unit circle
+    lfo_sin = s * norm;
+    lfo_cos = c * norm;
+}
+
+// One channel of the block delay_begin_block prepared. Own line and scratch, so channels can run in parallel.
+void Delay::delay_process_channel(const AudioBlockView& in, const AudioBlockView& out, uint16_t ch)
+{
+    const size_t block = in.num_frames();
+    const float* pIn = in.channel(ch);
+    float* pOut = out.channel(ch);
+
+    if (!enable)
+    {
+        if (pOut != pIn)
+        {
+            std::memcpy(pOut, pIn, sizeof(float) * block);
+        }
+        return;
+    }
+
+    DelayLine& line = lines[ch];
+    float* pWet = &wet[ch * TOVAL_MAX_BLOCK_SIZE];
+    float* pFeed = &feed[ch * TOVAL_MAX_BLOCK_SIZE];
+
+    for (size_t offset = 0; offset < block; )
+    {
+        const size_t n = std::min(block - offset, chunk_limit);
+
+        if (interpolation == TOVAL_DelayInterp::DL_INTERP_CUBIC)
+        {
+            line.read_block_cubic(pWet, &delay_curve[offset], n);
+        }
+        else
+        {
+            line.read_block_linear(pWet, &delay_curve[offset], n);
+        }
+
+        // wet and feed are arena buffers, 64 byte aligned from index 0 as the kernel requires
+        kernels->delay_mix(pIn + offset, pWet, pFeed, pOut + offset, n, feedback, mix);
+
+        line.write_block(pFeed, n);
+        offset += n;
+    }
+}
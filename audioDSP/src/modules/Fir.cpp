@@ -0,0 +1,152 @@
+#include <algorithm>
+#include "Fir.h"
+#include "TOVALparams.h"
+
+TOVAL_ERROR Fir::fir_init(float sample_rate, TOVAL_Arena& arena)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (sample_rate <= 0.0f)
+    {
+        return TOVAL_ERROR::CONFIG_ERROR;
+    }
+    this->sample_rate = sample_rate;
+
+    ret = filter.firfilter_init(FirChannels::FR_NUM_CHANNELS, MAX_TAPS, arena);
+    if (ret != TOVAL_ERROR::NO_ERROR)
+    {
+        return ret;
+    }
+
+    enable = 0;
+    type = TOVAL_FirType::FR_TYPE_LOWPASS;
+    taps = 31;
+    cutoff_hz = 8000.0f;
+    fraction = 0.0f;
+    update_taps();
+
+    return ret;
+}
+
+uint32_t Fir::settling_samples(uint32_t enable, uint32_t taps) const
+{
+    return enable ? taps : 0;
+}
+
+// Redesigns into the scratch array and hands it to the filter, nothing is allocated
+void Fir::update_taps()
+{
+    const float cutoff = std::min(cutoff_hz / sample_rate, MAX_CUTOFF);
+    fir_design(static_cast<FirType>(type), taps, cutoff, fraction, designed);
+    filter.set_taps(designed, taps);
+}
+
+TOVAL_ERROR Fir::set_enable(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (data_length != sizeof(enable))
+    {
+        ret = TOVAL_ERROR::SIZE_ERROR;
+    }
+    else if (data == nullptr)
+    {
+        ret = TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    else
+    {
+        uint32_t value = *static_cast<const uint32_t*>(data) ? 1 : 0;
+        if (value && !enable)
+        {
+            filter.firfilter_reset();   // don't replay the input from before the bypass
+        }
+        enable = value;
+    }
+    return ret;
+}
+
+static_assert(TOVAL_param_descriptor(FIR, FR_TYPE).max == static_cast<float>(TOVAL_FirType::FR_TYPE_DC_BLOCK), "FR_TYPE row must cover every TOVAL_FirType");
+
+TOVAL_ERROR Fir::set_type(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_param_read<FIR, FR_TYPE>(data_length, data, type);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        update_taps();
+    }
+    return ret;
+}
+
+static_assert(TOVAL_param_descriptor(FIR, FR_TAPS).max == static_cast<float>(Fir::MAX_TAPS), "FR_TAPS row must end at the filter's MAX_TAPS");
+
+TOVAL_ERROR Fir::set_taps(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_param_read<FIR, FR_TAPS>(data_length, data, taps);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        update_taps();
+    }
+    return ret;
+}
+
+TOVAL_ERROR Fir::set_cutoff(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_param_read<FIR, FR_CUTOFF>(data_length, data, cutoff_hz);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        update_taps();
+    }
+    return ret;
+}
+
+TOVAL_ERROR Fir::set_fraction(size_t data_length, void* data)
+{
+    // 1 itself would be a whole sample, which FR_TAPS already covers
+    TOVAL_ERROR ret = TOVAL_param_read<FIR, FR_FRACTION>(data_length, data, fraction);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        fraction = std::min(fraction, 0.999f);
+        update_taps();
+    }
+    return ret;
+}
+
+TOVAL_ERROR Fir::fir_process(float **ppIn, float **ppOut, size_t nspc)
+{
+    if (ppIn == nullptr || ppOut == nullptr)
+    {
+        return TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    return fir_process(AudioBlockView(ppIn, num_channels, nspc), AudioBlockView(ppOut, num_channels, nspc));
+}
+
+TOVAL_ERROR Fir::fir_process(const AudioBlockView& in, const AudioBlockView& out)
+{
+    if (in.raw() == nullptr || out.raw() == nullptr)
+    {
+        return TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    if (in.num_channels() < FirChannels::FR_NUM_CHANNELS || out.num_channels() < FirChannels::FR_NUM_CHANNELS
+        || out.num_frames() < in.num_frames())
+    {
+        return TOVAL_ERROR::SIZE_ERROR;
+    }
+
+    if (!enable)
+    {
+        for (int ch = 0; ch < FirChannels::FR_NUM_CHANNELS; ++ch)
+        {
+            if (in.channel(ch) == nullptr || out.channel(ch) == nullptr)
+            {
+                return TOVAL_ERROR::NULL_POINTER_ERROR;
+            }
+            if (out.channel(ch) != in.channel(ch))
+            {
+                std::memcpy(out.channel(ch), in.channel(ch), sizeof(float) * in.num_frames());
+            }
+        }
+        return TOVAL_ERROR::NO_ERROR;
+    }
+
+    return filter.firfilter_process(in, out);
+}
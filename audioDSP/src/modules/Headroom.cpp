@@ -1,52 +1,48 @@
+#include <algorithm>
 #include <iostream>
 #include "Headroom.h"
+#include "TOVALparams.h"
 using namespace std;
 
-TOVAL_ERROR Headroom::headroom_init()
+TOVAL_ERROR Headroom::headroom_init(float sample_rate, TOVAL_Arena& arena)
 {
     TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
 
-    headroom_features.resize(NUM_CHANNELS);       // In future this will not be macro, but a variable in main effect, defined in main effect Init before this
-    y_1.resize(NUM_CHANNELS);                     // Using vector allows num channels to be more flexible at runtime.
-    for(int ch=0; ch<headroom_features.size(); ch++)
+    constexpr float gain_ramp_ms = TOVAL_param_descriptor(HEADROOM, HR_RAMP_TIME).def;
+
+    headroom_features = arena.alloc<Headroom_gain>(NUM_CHANNELS);     // In future this will not be macro, but a variable in main effect, defined in main effect Init before this
+    y_1 = arena.alloc<float>(NUM_CHANNELS);                           // Sized at runtime so num channels can be more flexible.
+    gain_smoothers = arena.alloc<SmoothedValue>(NUM_CHANNELS);
+    gain_control = arena.alloc<ControlRate<1>>(NUM_CHANNELS);
+    meter_block = arena.alloc<TOVAL_MeterAccum>(NUM_CHANNELS);
+    meter_pending = arena.alloc<MeterPending>(NUM_CHANNELS);
+    if (arena.failed() || meters.triplebuffer_init(arena) != TOVAL_ERROR::NO_ERROR)
+    {
+        return TOVAL_ERROR::MEMORY_ERROR;
+    }
+    static_assert(NUM_CHANNELS <= TOVAL_METER_CHANNELS, "TOVAL_Meter must hold every headroom channel");
+
+    for(size_t ch=0; ch<headroom_features.size(); ch++)
     {
         headroom_features[ch].channel = ch;
-        headroom_features[ch].gain = 1;
+        headroom_features[ch].gain = 0.0f;
         y_1[ch] = 0;
+        gain_smoothers[ch].smoothed_init(sample_rate, gain_ramp_ms, 0.0f);   // straight line in dB
+        gain_control[ch].control_init(CONTROL_INTERVAL, 1.0f);
     }
+    meter_frames = 0;
+    meter_sequence = 0;
+    started = false;
     enable = 0;
     alpha = 0.1f;
+    this->sample_rate = sample_rate;
+    kernels = &kernels_select(KERNEL_ISA_AUTO);
   return ret;
 }
 
-TOVAL_ERROR Headroom::headroom_set(uint16_t ParamID, size_t data_length, void* data)
+void Headroom::set_kernels(const TOVAL_Kernels& table)
 {
-    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
-
-    ret = headroom_do_set(ParamID, data_length, data);
-
-    return ret;
-}
-
-TOVAL_ERROR Headroom::headroom_do_set(uint16_t ParamID, size_t data_length, void* data)
-{
-    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
-
-    switch (ParamID)
-    {
-        case TOVAL_HeadroomParam::HR_ENABLE:
-            ret = set_enable(data_length, data);
-            break;
-
-        case TOVAL_HeadroomParam::HR_GAIN:
-            ret = set_gain(data_length, data);
-            break;
-
-        default:
-            ret = TOVAL_ERROR::PARAMID_ERROR;
-            break;
-    }
-    return ret;
+    kernels = &table;
 }
 
 TOVAL_ERROR Headroom::set_enable(size_t data_length, void* data)
@@ -71,22 +67,37 @@ TOVAL_ERROR Headroom::set_enable(size_t data_length, void* data)
 
 TOVAL_ERROR Headroom::set_gain(size_t data_length, void* data)
 {
-    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
-    if (data_length != sizeof(float))
+    float gain = 0.0f;
+    TOVAL_ERROR ret = TOVAL_param_read<HEADROOM, HR_GAIN>(data_length, data, gain);
+    if (ret == TOVAL_ERROR::NO_ERROR)
     {
-        ret = TOVAL_ERROR::SIZE_ERROR;
-    }
-    if (data == nullptr)
-    {
-        ret = TOVAL_ERROR::NULL_POINTER_ERROR;
+        for(int ch=0; ch < HeadroomChannels::NUM_CHANNELS; ch++)
+        {
+            headroom_features[ch].gain = gain;                    // dB, converted to linear at control rate
+            if (started)
+            {
+                gain_smoothers[ch].set_target(gain);              // ramp to it rather than jump (zipper noise)
+            }
+            else
+            {
+                // Nothing has been heard yet, so the initial setup applies as is
+                gain_smoothers[ch].set_immediate(gain);
+                gain_control[ch].set_immediate(std::pow(10.0f, gain / 20.0f));
+            }
+        }
     }
-    else
+    return ret;
+}
+
+TOVAL_ERROR Headroom::set_ramp_time(size_t data_length, void* data)
+{
+    float value = 0.0f;
+    TOVAL_ERROR ret = TOVAL_param_read<HEADROOM, HR_RAMP_TIME>(data_length, data, value);
+    if (ret == TOVAL_ERROR::NO_ERROR)
     {
-        float values = *static_cast<const float*>(data);
-        float gain = values;
         for(int ch=0; ch < HeadroomChannels::NUM_CHANNELS; ch++)
         {
-            headroom_features[ch].gain = std::pow(10.0f, (gain / 20.0f));      // dB gain passed, Linear gain stored
+            gain_smoothers[ch].set_ramp_time(value);   // takes effect from the next gain change
         }
     }
     return ret;
@@ -111,112 +122,163 @@ TOVAL_ERROR Headroom::set_alpha(size_t data_length, void* data)
     }
     return ret;
 }
-TOVAL_ERROR Headroom::headroom_get(uint16_t ParamID, size_t data_length, void* data)
+uint32_t Headroom::settling_samples(float ramp_ms) const
 {
-    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
-
-    ret = headroom_do_get(ParamID, data_length, data);
-
-    return ret;
+    // y_1 decays by alpha per sample
+    const float filter = (alpha > 0.0f) ? std::ceil(std::log(TOVAL_SETTLE_LEVEL) / std::log(alpha)) : 0.0f;
+    return static_cast<uint32_t>(filter + std::ceil(ramp_ms * sample_rate / 1000.0f)) + 2 * CONTROL_INTERVAL;   // a tick late, then one interval to land
 }
 
-TOVAL_ERROR Headroom::headroom_do_get(uint16_t ParamID, size_t data_length, void* data)
-{
-    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
-
-    switch (ParamID)
-    {
-        case TOVAL_HeadroomParam::HR_ENABLE:
-            ret = get_enable(data_length, data);
-            break;
 
-        // Add other cases for other parameters...
 
-        default:
-            ret = TOVAL_ERROR::PARAMID_ERROR;
-            break;
+TOVAL_ERROR Headroom::headroom_process(float **ppIn, float **ppOut, size_t nspc) {
+    if (ppIn == nullptr || ppOut == nullptr)
+    {
+        return TOVAL_ERROR::NULL_POINTER_ERROR;
     }
-
-    return ret;
+    return headroom_process(AudioBlockView(ppIn, num_channels, nspc), AudioBlockView(ppOut, num_channels, nspc));
 }
 
-TOVAL_ERROR Headroom::get_enable(size_t data_length, void* data)
-{
-    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
-
-    // Check if the provided data length matches the size of enable
-    if (data_length != sizeof(enable))
-    {
-        ret = TOVAL_ERROR::SIZE_ERROR;
-    }
-    else if (data == nullptr)
+TOVAL_ERROR Headroom::headroom_process(const AudioBlockView& in, const AudioBlockView& out) {
+    TOVAL_ERROR error = headroom_check(in, out);
+    if (error != TOVAL_ERROR::NO_ERROR)
     {
-        ret = TOVAL_ERROR::NULL_POINTER_ERROR;
+        return error;
     }
-    else
+
+    for (uint16_t ch = 0; ch < HeadroomChannels::NUM_CHANNELS; ++ch)
     {
-        // Cast data to bool pointer and retrieve the enable value
-        *static_cast<uint32_t*>(data) = enable;
+        headroom_process_channel(in, out, ch);
     }
 
-    return ret;
+    headroom_end_block(in.num_frames());
+    return error;
 }
 
-TOVAL_ERROR Headroom::get_gain(size_t data_length, void* data)
+TOVAL_ERROR Headroom::headroom_check(const AudioBlockView& in, const AudioBlockView& out) const
 {
-    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
-    if (data_length != sizeof(float))
+    if (in.raw() == nullptr || out.raw() == nullptr)
     {
-        ret = TOVAL_ERROR::SIZE_ERROR;
+        return TOVAL_ERROR::NULL_POINTER_ERROR;
     }
-    if (data == nullptr)
+    if (in.num_channels() < HeadroomChannels::NUM_CHANNELS || out.num_channels() < HeadroomChannels::NUM_CHANNELS
+        || out.num_frames() < in.num_frames())
     {
-        ret = TOVAL_ERROR::NULL_POINTER_ERROR;
+        return TOVAL_ERROR::SIZE_ERROR;
     }
-    else
+    for (uint16_t ch = 0; ch < HeadroomChannels::NUM_CHANNELS; ++ch)
     {
-        float value = 20.0f * std::log10(headroom_features[0].gain);
-        *static_cast<float*>(data) = value;      // dB gain passed, Linear gain stored
+        if (in.channel(ch) == nullptr || out.channel(ch) == nullptr)
+        {
+            return TOVAL_ERROR::NULL_POINTER_ERROR;
+        }
     }
-
-    return ret;
+    return TOVAL_ERROR::NO_ERROR;
 }
 
+// Touches only channel ch's state, so channels can run on different threads
+void Headroom::headroom_process_channel(const AudioBlockView& in, const AudioBlockView& out, uint16_t ch)
+{
+    const size_t nspc = in.num_frames();
+    float* pIn = in.channel(ch);
+    float* pOut = out.channel(ch);
 
+    meter_block[ch] = {};
 
-TOVAL_ERROR Headroom::headroom_process(float **ppIn, float **ppOut, size_t nspc) {
-    TOVAL_ERROR error = TOVAL_ERROR::NO_ERROR;
-    if (ppIn == nullptr || ppOut == nullptr)
+    if (!enable)
     {
-        return TOVAL_ERROR::NULL_POINTER_ERROR;
+        if (pOut != pIn)
+        {
+            std::memcpy(pOut, pIn, sizeof(float) * nspc);
+        }
+        kernels->meter(pOut, nspc, &meter_block[ch]);
+        return;
     }
 
-    for (int ch = 0; ch < HeadroomChannels::NUM_CHANNELS; ++ch)
+    SmoothedValue& gain_db = gain_smoothers[ch];
+    ControlRate<1>& control = gain_control[ch];
+
+    if (!gain_db.is_smoothing() && !control.is_ramping())
     {
-        float* pIn = ppIn[ch];
-        float* pOut = ppOut[ch];
+        kernels->onepole_gain_meter(pIn, pOut, nspc, alpha, control.get_current()[0], &y_1[ch], &meter_block[ch]);  // Apply gain after smoothing, meter on the way out
+        return;
+    }
 
-        if (pIn == nullptr || pOut == nullptr)
+    // Ramping: the dB ramp and its conversion move once per CONTROL_INTERVAL, the gain in between is linear
+    kernels->onepole_gain(pIn, pOut, nspc, alpha, 1.0f, &y_1[ch]);
+    control.run(nspc,
+        [&](float* target)
         {
-            return TOVAL_ERROR::NULL_POINTER_ERROR;
-        }
+            gain_db.skip(CONTROL_INTERVAL);
+            target[0] = std::pow(10.0f, gain_db.get_current() / 20.0f);
+        },
+        [&](size_t start, size_t n, const float* from, const float* step)
+        {
+            control_ramp_gain(pOut + start, pOut + start, n, from[0], step[0]);
+        });
+    kernels->meter(pOut, nspc, &meter_block[ch]);      // extra pass only while ramping
+}
+
+void Headroom::headroom_end_block(size_t nspc)
+{
+    started = true;
+    publish_meters(nspc);
+}
 
-        if (!enable)
+void Headroom::publish_meters(size_t nspc)
+{
+    // The reader took the last snapshot, start a fresh interval. Clip counts keep running.
+    if (!meters.has_new())
+    {
+        meter_frames = 0;
+        for (MeterPending& pending : meter_pending)
         {
-            std::memcpy(pOut, pIn, sizeof(float) * nspc);
-            continue;  // Skip processing for this channel
+            pending.sum_squares = 0.0;
+            pending.peak = 0.0f;
         }
+    }
+    meter_frames += nspc;
+
+    TOVAL_Meter& snapshot = meters.write_slot();
+    snapshot = {};
+    snapshot.sequence = ++meter_sequence;
+    snapshot.frames = static_cast<uint32_t>(std::min<uint64_t>(meter_frames, UINT32_MAX));
+    for (size_t ch = 0; ch < meter_pending.size(); ch++)
+    {
+        MeterPending& pending = meter_pending[ch];
+        pending.sum_squares += meter_block[ch].sum_squares;
+        pending.peak = std::max(pending.peak, meter_block[ch].peak);
+        pending.clips += meter_block[ch].clips;
+
+        snapshot.peak[ch] = pending.peak;
+        snapshot.rms[ch] = static_cast<float>(std::sqrt(pending.sum_squares / static_cast<double>(meter_frames)));
+        snapshot.clips[ch] = pending.clips;
+    }
+    meters.publish();
+}
 
-        float gain = headroom_features[ch].gain;
+TOVAL_ERROR Headroom::read_meter(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
 
-        for (int sample = 0; sample < nspc; ++sample)
+    if (data_length != sizeof(TOVAL_Meter))
+    {
+        ret = TOVAL_ERROR::SIZE_ERROR;
+    }
+    else if (data == nullptr)
+    {
+        ret = TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    else
+    {
+        while (reading.test_and_set(std::memory_order_acquire))
         {
-            float smoothed = (1 - alpha) * pIn[sample] + alpha * y_1[ch];
-            y_1[ch] = smoothed;
-            pOut[sample] = smoothed * gain;  // Apply gain after smoothing
+            reading.wait(true, std::memory_order_relaxed);
         }
+        std::memcpy(data, &meters.read_slot(), sizeof(TOVAL_Meter));
+        reading.clear(std::memory_order_release);
+        reading.notify_one();
     }
-
-    return error;
+    return ret;
 }
 
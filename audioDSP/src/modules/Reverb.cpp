@@ -0,0 +1,374 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include "Reverb.h"
+#include "TOVALparams.h"
+#include "TOVALsimd.h"
+
+namespace {
+
+constexpr float MAX_DAMPING = 0.95f;        // damping 1 decays the highs 20x faster than the lows
+
+// Input sign per line, so the two channels reach the lines in different mixes
+constexpr float INPUT_SIGNS[Reverb::MAX_LINES] = { 1.0f,  1.0f, -1.0f,  1.0f,  1.0f, -1.0f,  1.0f,  1.0f,
+                                                  -1.0f,  1.0f,  1.0f, -1.0f,  1.0f, -1.0f, -1.0f, -1.0f };
+
+bool is_prime(uint32_t n)
+{
+    if (n < 4)
+    {
+        return n > 1;
+    }
+    if (n % 2 == 0)
+    {
+        return false;
+    }
+    for (uint32_t d = 3; d * d <= n; d += 2)
+    {
+        if (n % d == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TOVAL_ERROR Reverb::reverb_init(float sample_rate, TOVAL_Arena& arena)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (sample_rate <= 0.0f)
+    {
+        return TOVAL_ERROR::CONFIG_ERROR;
+    }
+    this->sample_rate = sample_rate;
+
+    // Room for the longest line at the largest size plus what the prime search may add
+    const size_t frames = std::bit_ceil(static_cast<size_t>(std::ceil(longest_line(TOVAL_param_descriptor(REVERB, RV_SIZE).max))) + 64);
+    ring = arena.alloc<float>(frames * MAX_LINES);
+    if (arena.failed())
+    {
+        return TOVAL_ERROR::MEMORY_ERROR;
+    }
+    ring_mask = frames - 1;
+
+    enable = 0;
+    density = TOVAL_ReverbDensity::RV_DENSITY_8;
+    decay_s = 1.5f;
+    size = 0.5f;
+    damping = 0.5f;
+    wet = 0.25f;
+
+    lines = 8;
+    std::fill(std::begin(delay), std::end(delay), 0u);
+    reset();
+    update_lines();
+    update_gains();
+
+    return ret;
+}
+
+float Reverb::longest_line(float size) const
+{
+    return (MIN_LONGEST_MS + size * (MAX_LONGEST_MS - MIN_LONGEST_MS)) * sample_rate / 1000.0f;
+}
+
+uint32_t Reverb::settling_samples(uint32_t enable, float decay_s, float size) const
+{
+    if (!enable)
+    {
+        return 0;   // the lines are not touched while bypassed
+    }
+
+    // RV_DECAY is the time to -60 dB, the tail has to get down to TOVAL_SETTLE_LEVEL
+    const double level_db = -20.0 * std::log10(TOVAL_SETTLE_LEVEL);
+    const double samples = decay_s * sample_rate * level_db / 60.0 + longest_line(size);
+    return (samples >= TOVAL_SETTLE_NEVER) ? TOVAL_SETTLE_NEVER - 1 : static_cast<uint32_t>(std::ceil(samples));
+}
+
+// Clears the tail, so a re-enable or a density change starts from silence
+void Reverb::reset()
+{
+    std::fill(ring.begin(), ring.begin() + (ring_mask + 1) * lines, 0.0f);
+    std::fill(std::begin(state), std::end(state), 0.0f);
+    position = 0;
+}
+
+/*
+    Exponential spread from SHORTEST_RATIO x the longest up to the longest, each rounded up to a prime
+    above the previous one. Lanes take the lengths in a stride (N / 2 + 1 is odd, so every length is used
+    once) rather than in order, so neighbouring lanes, which the two channels share, differ a lot.
+
+    The ring only holds what has been written so far. A line that grows would read rows it never wrote,
+    left from a lap ago, so those are zeroed. A line that shrinks overwrites some of its pending output.
+*/
+void Reverb::update_lines()
+{
+    const float longest = longest_line(size);
+    uint32_t lengths[MAX_LINES];
+    uint32_t previous = 1;
+
+    for (size_t k = 0; k < lines; k++)
+    {
+        const float exponent = static_cast<float>(lines - 1 - k) / static_cast<float>(lines - 1);
+        uint32_t length = std::max(static_cast<uint32_t>(longest * std::pow(SHORTEST_RATIO, exponent)), previous + 1);
+        while (!is_prime(length))
+        {
+            length++;
+        }
+        lengths[k] = std::min<uint32_t>(length, static_cast<uint32_t>(ring_mask));
+        previous = length;
+    }
+
+    for (size_t l = 0; l < lines; l++)
+    {
+        const uint32_t length = lengths[(l * (lines / 2 + 1)) % lines];
+        for (size_t k = delay[l]; k < length; k++)
+        {
+            ring[((position + k) & ring_mask) * lines + l] = 0.0f;
+        }
+        delay[l] = length;
+    }
+}
+
+/*
+    Line gain sets the low frequency decay: a trip round line l is d_l frames, so it has to lose
+    60 dB * d_l / (decay * rate). The lowpass takes the highs down further, to the decay time damping
+    asks for, through its gain at Nyquist (1 - a) / (1 + a). The Hadamard normalisation rides on the gain.
+*/
+void Reverb::update_gains()
+{
+    const float norm = 1.0f / std::sqrt(static_cast<float>(lines));
+    const float high_decay_s = decay_s * (1.0f - MAX_DAMPING * damping);
+    const float input = 0.5f;      // the taps see 1 / N of the network, so this keeps 8 and 16 lines equally loud
+
+    for (size_t l = 0; l < lines; l++)
+    {
+        const float low = std::pow(10.0f, -3.0f * delay[l] / (decay_s * sample_rate));
+        const float high = std::pow(10.0f, -3.0f * delay[l] / (high_decay_s * sample_rate));
+        const float ratio = high / low;
+
+        damp[l] = (1.0f - ratio) / (1.0f + ratio);
+        gain[l] = low * norm;
+        input_sign[l] = INPUT_SIGNS[l] * input;
+    }
+}
+
+TOVAL_ERROR Reverb::set_enable(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (data_length != sizeof(enable))
+    {
+        ret = TOVAL_ERROR::SIZE_ERROR;
+    }
+    else if (data == nullptr)
+    {
+        ret = TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    else
+    {
+        uint32_t value = *static_cast<const uint32_t*>(data) ? 1 : 0;
+        if (value && !enable)
+        {
+            reset();    // don't replay the tail from before the bypass
+        }
+        enable = value;
+    }
+    return ret;
+}
+
+TOVAL_ERROR Reverb::set_decay(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_param_read<REVERB, RV_DECAY>(data_length, data, decay_s);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        update_gains();
+    }
+    return ret;
+}
+
+TOVAL_ERROR Reverb::set_size(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_param_read<REVERB, RV_SIZE>(data_length, data, size);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        update_lines();
+        update_gains();     // same decay time over the new lengths
+    }
+    return ret;
+}
+
+TOVAL_ERROR Reverb::set_damping(size_t data_length, void* data)
+{
+    TOVAL_ERROR ret = TOVAL_param_read<REVERB, RV_DAMPING>(data_length, data, damping);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        update_gains();
+    }
+    return ret;
+}
+
+TOVAL_ERROR Reverb::set_wet(size_t data_length, void* data)
+{
+    return TOVAL_param_read<REVERB, RV_WET>(data_length, data, wet);
+}
+
+static_assert(TOVAL_param_descriptor(REVERB, RV_DENSITY).max == static_cast<float>(TOVAL_ReverbDensity::RV_DENSITY_16), "RV_DENSITY row must cover every TOVAL_ReverbDensity");
+
+TOVAL_ERROR Reverb::set_density(size_t data_length, void* data)
+{
+    uint32_t value = 0;
+    TOVAL_ERROR ret = TOVAL_param_read<REVERB, RV_DENSITY>(data_length, data, value);
+    if (ret == TOVAL_ERROR::NO_ERROR && value != density)
+    {
+        // The row stride changes, so the tail can't be carried over
+        density = value;
+        lines = (density == TOVAL_ReverbDensity::RV_DENSITY_16) ? 16 : 8;
+        std::fill(std::begin(delay), std::end(delay), 0u);
+        reset();
+        update_lines();
+        update_gains();
+    }
+    return ret;
+}
+
+TOVAL_ERROR Reverb::reverb_process(float **ppIn, float **ppOut, size_t nspc)
+{
+    if (ppIn == nullptr || ppOut == nullptr)
+    {
+        return TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    return reverb_process(AudioBlockView(ppIn, num_channels, nspc), AudioBlockView(ppOut, num_channels, nspc));
+}
+
+TOVAL_ERROR Reverb::reverb_process(const AudioBlockView& in, const AudioBlockView& out)
+{
+    TOVAL_ERROR error = TOVAL_ERROR::NO_ERROR;
+    if (in.raw() == nullptr || out.raw() == nullptr)
+    {
+        return TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    if (in.num_channels() < ReverbChannels::RV_NUM_CHANNELS || out.num_channels() < ReverbChannels::RV_NUM_CHANNELS
+        || out.num_frames() < in.num_frames())
+    {
+        return TOVAL_ERROR::SIZE_ERROR;
+    }
+
+    for (int ch = 0; ch < ReverbChannels::RV_NUM_CHANNELS; ++ch)
+    {
+        if (in.channel(ch) == nullptr || out.channel(ch) == nullptr)
+        {
+            return TOVAL_ERROR::NULL_POINTER_ERROR;
+        }
+    }
+
+    const size_t nspc = in.num_frames();
+
+    if (!enable)
+    {
+        for (int ch = 0; ch < ReverbChannels::RV_NUM_CHANNELS; ++ch)
+        {
+            if (out.channel(ch) != in.channel(ch))
+            {
+                std::memcpy(out.channel(ch), in.channel(ch), sizeof(float) * nspc);
+            }
+        }
+        return error;
+    }
+
+    simd::FlushDenormals flush;     // the tail decays into denormals on silence
+    if (lines == 16)
+    {
+        run<4>(in.channel(RV_LEFT), in.channel(RV_RIGHT), out.channel(RV_LEFT), out.channel(RV_RIGHT), nspc);
+    }
+    else
+    {
+        run<2>(in.channel(RV_LEFT), in.channel(RV_RIGHT), out.channel(RV_LEFT), out.channel(RV_RIGHT), nspc);
+    }
+    return error;
+}
+
+// The network for N = 4 x Registers lines. Reads a frame before writing it, so in place is fine.
+template <size_t Registers>
+void Reverb::run(const float* pInL, const float* pInR, float* pOutL, float* pOutR, size_t n)
+{
+    constexpr size_t N = 4 * Registers;
+    using simd::f32x4;
+
+    f32x4 z[Registers];
+    f32x4 a[Registers];
+    f32x4 g[Registers];
+    f32x4 s[Registers];
+    for (size_t r = 0; r < Registers; r++)
+    {
+        z[r] = simd::load_aligned(&state[4 * r]);
+        a[r] = simd::load_aligned(&damp[4 * r]);
+        g[r] = simd::load_aligned(&gain[4 * r]);
+        s[r] = simd::load_aligned(&input_sign[4 * r]);
+    }
+
+    uint32_t d[N];
+    std::copy(delay, delay + N, d);
+    float* pRing = ring.data();
+    const size_t mask = ring_mask;
+    const float level = wet;
+    size_t t = position;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        const float* row = pRing + t * N;
+
+        f32x4 h[Registers];
+        for (size_t r = 0; r < Registers; r++)
+        {
+            const f32x4 x = simd::load_aligned(row + 4 * r);
+            z[r] = simd::madd(a[r], simd::sub(z[r], x), x);
+            h[r] = simd::mul(z[r], g[r]);
+        }
+
+        // Hadamard: the register index bits first, then the two lane bits inside each register
+        for (size_t span = 1; span < Registers; span *= 2)
+        {
+            for (size_t r = 0; r < Registers; r++)
+            {
+                if ((r & span) == 0)
+                {
+                    const f32x4 lo = h[r];
+                    h[r] = simd::add(lo, h[r + span]);
+                    h[r + span] = simd::sub(lo, h[r + span]);
+                }
+            }
+        }
+        for (size_t r = 0; r < Registers; r++)
+        {
+            h[r] = simd::butterfly_halves(simd::butterfly_pairs(h[r]));
+        }
+
+        alignas(16) float feed[N];
+        simd::store_aligned(feed, h[0]);
+        const float inL = pInL[i];
+        const float inR = pInR[i];
+        pOutL[i] = inL + level * feed[0];
+        pOutR[i] = inR + level * feed[1];
+
+        const f32x4 input = simd::set(inL, inR, inL, inR);
+        for (size_t r = 0; r < Registers; r++)
+        {
+            simd::store_aligned(&feed[4 * r], simd::madd(input, s[r], h[r]));
+        }
+        for (size_t l = 0; l < N; l++)
+        {
+            pRing[((t + d[l]) & mask) * N + l] = feed[l];
+        }
+        t = (t + 1) & mask;
+    }
+
+    position = t;
+    for (size_t r = 0; r < Registers; r++)
+    {
+        simd::store_aligned(&state[4 * r], z[r]);
+    }
+}
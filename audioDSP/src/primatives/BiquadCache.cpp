@@ -0,0 +1,143 @@
+#include "BiquadCache.h"
+
+namespace {
+
+static_assert((BiquadCache::SETS & (BiquadCache::SETS - 1)) == 0, "SETS is a power of two");
+
+// Static storage and constant initialised, so the first call (maybe on an audio thread) runs no init guard
+constinit BiquadCache cache;
+
+} // namespace
+
+BiquadCache& biquad_cache()
+{
+    return cache;
+}
+
+size_t BiquadCache::set_of(const uint32_t (&words)[KEY_WORDS])
+{
+    uint64_t h = 0x9E3779B97F4A7C15ull;
+    for (uint32_t word : words)
+    {
+        h = (h ^ word) * 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+    return static_cast<size_t>(h) & (SETS - 1);
+}
+
+bool BiquadCache::key_matches(Entry& entry, const uint32_t (&words)[KEY_WORDS])
+{
+    for (size_t k = 0; k < KEY_WORDS; k++)
+    {
+        if (std::atomic_ref<uint32_t>(entry.key[k]).load(std::memory_order_relaxed) != words[k])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Seqlock read: the copy counts if the version is the same even value before and after it
+bool BiquadCache::try_copy(Entry& entry, const uint32_t (&words)[KEY_WORDS], BiquadCoeffs& out)
+{
+    const uint32_t version = entry.version.load(std::memory_order_acquire);
+    if (version == 0 || (version & 1) != 0 || !key_matches(entry, words))
+    {
+        return false;
+    }
+
+    for (size_t k = 0; k < 5; k++)
+    {
+        out.c[k] = std::atomic_ref<double>(entry.coeffs.c[k]).load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (entry.version.load(std::memory_order_relaxed) != version)
+    {
+        return false;
+    }
+
+    entry.last_used.store(clock.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return true;
+}
+
+void BiquadCache::lookup(const BiquadKey& key, BiquadCoeffs& out)
+{
+    uint32_t words[KEY_WORDS];
+    std::memcpy(words, &key, sizeof(words));
+    const size_t set = set_of(words);
+
+    for (size_t way = 0; way < WAYS; way++)
+    {
+        if (try_copy(entries[set * WAYS + way], words, out))
+        {
+            return;
+        }
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+    biquad_design(key, out);
+
+    if (!inserting.test_and_set(std::memory_order_acquire))
+    {
+        bool present = false;
+        for (size_t way = 0; way < WAYS && !present; way++)
+        {
+            Entry& entry = entries[set * WAYS + way];
+            present = entry.version.load(std::memory_order_relaxed) != 0 && key_matches(entry, words);
+        }
+        if (!present)
+        {
+            insert(set, words, out);
+        }
+        inserting.clear(std::memory_order_release);
+    }
+}
+
+/*
+    Called with the insert flag held, so this is the only writer. The version goes odd before the fields
+    are written and the release fence keeps the field stores behind it, against try_copy.
+*/
+void BiquadCache::insert(size_t set, const uint32_t (&words)[KEY_WORDS], const BiquadCoeffs& coeffs)
+{
+    // An empty way first, then the least recently used
+    size_t victim = 0;
+    for (size_t way = 0; way < WAYS; way++)
+    {
+        const Entry& entry = entries[set * WAYS + way];
+        if (entry.version.load(std::memory_order_relaxed) == 0)
+        {
+            victim = way;
+            break;
+        }
+        if (entry.last_used.load(std::memory_order_relaxed) < entries[set * WAYS + victim].last_used.load(std::memory_order_relaxed))
+        {
+            victim = way;
+        }
+    }
+
+    Entry& entry = entries[set * WAYS + victim];
+    const uint32_t version = entry.version.load(std::memory_order_relaxed);
+    entry.version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t k = 0; k < KEY_WORDS; k++)
+    {
+        std::atomic_ref<uint32_t>(entry.key[k]).store(words[k], std::memory_order_relaxed);
+    }
+    for (size_t k = 0; k < 5; k++)
+    {
+        std::atomic_ref<double>(entry.coeffs.c[k]).store(coeffs.c[k], std::memory_order_relaxed);
+    }
+    entry.last_used.store(clock.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);    // only inserts tick
+    entry.version.store(version + 2, std::memory_order_release);
+
+    if (version != 0)
+    {
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+BiquadCache::Stats BiquadCache::stats() const
+{
+    return { misses.load(std::memory_order_relaxed), evictions.load(std::memory_order_relaxed) };
+}
@@ -0,0 +1,91 @@
+#include <cmath>
+#include "BiquadDesign.h"
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+
+} // namespace
+
+void biquad_design(const BiquadKey& key, BiquadCoeffs& out)
+{
+    const double w0 = 2.0 * pi * key.frequency / key.sample_rate;
+    const double cosw = std::cos(w0);
+    const double sinw = std::sin(w0);
+    const double alpha = sinw / (2.0 * key.q);
+    const bool has_gain = key.type == BiquadType::PEAKING || key.type == BiquadType::LOWSHELF || key.type == BiquadType::HIGHSHELF;
+    const double A = has_gain ? std::pow(10.0, key.gain_db / 40.0) : 1.0;
+
+    double b0 = 1.0;
+    double b1 = -2.0 * cosw;
+    double b2 = 1.0;
+    double a0 = 1.0 + alpha;
+    double a1 = -2.0 * cosw;
+    double a2 = 1.0 - alpha;
+
+    switch (key.type)
+    {
+        case BiquadType::LOWPASS:
+            b0 = 0.5 * (1.0 - cosw);
+            b1 = 1.0 - cosw;
+            b2 = 0.5 * (1.0 - cosw);
+            break;
+
+        case BiquadType::HIGHPASS:
+            b0 = 0.5 * (1.0 + cosw);
+            b1 = -(1.0 + cosw);
+            b2 = 0.5 * (1.0 + cosw);
+            break;
+
+        case BiquadType::BANDPASS:
+            b0 = key.q * alpha;
+            b1 = 0.0;
+            b2 = -key.q * alpha;
+            break;
+
+        case BiquadType::NOTCH:
+            break;
+
+        case BiquadType::PEAKING:
+            b0 = 1.0 + alpha * A;
+            b2 = 1.0 - alpha * A;
+            a0 = 1.0 + alpha / A;
+            a2 = 1.0 - alpha / A;
+            break;
+
+        case BiquadType::LOWSHELF:
+        {
+            const double beta = std::sqrt(A) / key.q * sinw;
+            b0 = A * ((A + 1.0) - (A - 1.0) * cosw + beta);
+            b1 = 2.0 * A * ((A - 1.0) - (A + 1.0) * cosw);
+            b2 = A * ((A + 1.0) - (A - 1.0) * cosw - beta);
+            a0 = (A + 1.0) + (A - 1.0) * cosw + beta;
+            a1 = -2.0 * ((A - 1.0) + (A + 1.0) * cosw);
+            a2 = (A + 1.0) + (A - 1.0) * cosw - beta;
+            break;
+        }
+
+        case BiquadType::HIGHSHELF:
+        {
+            const double beta = std::sqrt(A) / key.q * sinw;
+            b0 = A * ((A + 1.0) + (A - 1.0) * cosw + beta);
+            b1 = -2.0 * A * ((A - 1.0) + (A + 1.0) * cosw);
+            b2 = A * ((A + 1.0) + (A - 1.0) * cosw - beta);
+            a0 = (A + 1.0) - (A - 1.0) * cosw + beta;
+            a1 = 2.0 * ((A - 1.0) - (A + 1.0) * cosw);
+            a2 = (A + 1.0) - (A - 1.0) * cosw - beta;
+            break;
+        }
+
+        case BiquadType::ALLPASS:
+            b0 = 1.0 - alpha;
+            b2 = 1.0 + alpha;
+            break;
+    }
+
+    out.c[0] = b0 / a0;
+    out.c[1] = b1 / a0;
+    out.c[2] = b2 / a0;
+    out.c[3] = a1 / a0;
+    out.c[4] = a2 / a0;
+}
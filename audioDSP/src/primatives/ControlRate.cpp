@@ -0,0 +1,20 @@
+#include "ControlRate.h"
+#include "TOVALsimd.h"
+
+void control_ramp_gain(const float* pIn, float* pOut, size_t n, float from, float step)
+{
+    size_t i = 0;
+
+    simd::f32x4 value = simd::set(from, from + step, from + 2.0f * step, from + 3.0f * step);
+    const simd::f32x4 advance = simd::set1(4.0f * step);
+    for (; i + simd::width <= n; i += simd::width)
+    {
+        simd::store(pOut + i, simd::mul(simd::load(pIn + i), value));
+        value = simd::add(value, advance);
+    }
+
+    for (; i < n; i++)
+    {
+        pOut[i] = pIn[i] * (from + static_cast<float>(i) * step);
+    }
+}
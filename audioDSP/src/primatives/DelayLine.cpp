@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "DelayLine.h"
+
+TOVAL_ERROR DelayLine::delayline_init(size_t max_delay, TOVAL_Arena& arena)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (max_delay == 0)
+    {
+        return TOVAL_ERROR::CONFIG_ERROR;
+    }
+
+    // Room for the longest delay, the interpolation window and one block of writes
+    size_t size = 1;
+    while (size < max_delay + GUARD + TOVAL_MAX_BLOCK_SIZE)
+    {
+        size <<= 1;
+    }
+
+    buffer = arena.alloc<float>(size + GUARD);     // zeroed
+    if (arena.failed())
+    {
+        return TOVAL_ERROR::MEMORY_ERROR;
+    }
+
+    mask = size - 1;
+    write_pos = 0;
+    return ret;
+}
+
+void DelayLine::delayline_reset()
+{
+    std::fill(buffer.begin(), buffer.end(), 0.0f);
+    write_pos = 0;
+}
+
+void DelayLine::write_block(const float* pIn, size_t n)
+{
+    const size_t size = mask + 1;
+    const size_t first = std::min(n, size - write_pos);
+
+    std::memcpy(&buffer[write_pos], pIn, first * sizeof(float));
+    if (first < n)
+    {
+        std::memcpy(&buffer[0], pIn + first, (n - first) * sizeof(float));
+    }
+
+    // Keep the guard mirror in step when the head of the buffer was touched
+    if (write_pos + n > size || write_pos < GUARD)
+    {
+        std::memcpy(&buffer[size], &buffer[0], GUARD * sizeof(float));
+    }
+
+    write_pos = (write_pos + n) & mask;
+}
+
+void DelayLine::read_block(float* pOut, size_t n, size_t delay) const
+{
+    const size_t size = mask + 1;
+    const size_t read_pos = (write_pos - delay) & mask;
+    const size_t first = std::min(n, size - read_pos);
+
+    std::memcpy(pOut, &buffer[read_pos], first * sizeof(float));
+    if (first < n)
+    {
+        std::memcpy(pOut + first, &buffer[0], (n - first) * sizeof(float));
+    }
+}
+
+void DelayLine::read_block_linear(float* pOut, const float* pDelay, size_t n) const
+{
+    const float* pBuf = buffer.data();
+    for (size_t i = 0; i < n; ++i)
+    {
+        // Split the delay before forming the position, a float index loses the fraction on long buffers
+        const size_t whole = static_cast<size_t>(pDelay[i]);
+        const float frac = 1.0f - (pDelay[i] - static_cast<float>(whole));
+        const float* p = pBuf + ((write_pos + i - whole - 1) & mask);     // p[1] may sit in the guard
+        pOut[i] = p[0] + frac * (p[1] - p[0]);
+    }
+}
+
+void DelayLine::read_block_cubic(float* pOut, const float* pDelay, size_t n) const
+{
+    const float* pBuf = buffer.data();
+    for (size_t i = 0; i < n; ++i)
+    {
+        const size_t whole = static_cast<size_t>(pDelay[i]);
+        const float t = 1.0f - (pDelay[i] - static_cast<float>(whole));
+        const float* p = pBuf + ((write_pos + i - whole - 2) & mask);  // window p[0..3] around p[1], upper taps may sit in the guard
+
+        // 4 point, 3rd order Hermite (Catmull-Rom)
+        const float c1 = 0.5f * (p[2] - p[0]);
+        const float c2 = p[0] - 2.5f * p[1] + 2.0f * p[2] - 0.5f * p[3];
+        const float c3 = 0.5f * (p[3] - p[0]) + 1.5f * (p[1] - p[2]);
+        pOut[i] = ((c3 * t + c2) * t + c1) * t + p[1];
+    }
+}
@@ -0,0 +1,125 @@
+#include <cmath>
+#include "FFT.h"
+
+namespace {
+
+bool is_power_of_two(size_t value)
+{
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+} // namespace
+
+TOVAL_ERROR FFT::fft_init(size_t max_size, TOVAL_Arena& arena)
+{
+    if (max_size < MIN_SIZE || !is_power_of_two(max_size))
+    {
+        return TOVAL_ERROR::CONFIG_ERROR;
+    }
+
+    cos_table = arena.alloc<float>(max_size / 2);
+    sin_table = arena.alloc<float>(max_size / 2);
+    bit_reverse = arena.alloc<uint32_t>(max_size / 2);
+    work_re = arena.alloc<float>(max_size / 2);
+    work_im = arena.alloc<float>(max_size / 2);
+    if (arena.failed())
+    {
+        return TOVAL_ERROR::MEMORY_ERROR;
+    }
+
+    max_n = max_size;
+    for (size_t k = 0; k < max_size / 2; k++)
+    {
+        const double angle = 2.0 * 3.14159265358979323846 * static_cast<double>(k) / static_cast<double>(max_size);
+        cos_table[k] = static_cast<float>(std::cos(angle));
+        sin_table[k] = static_cast<float>(std::sin(angle));
+    }
+    return set_size(max_size);
+}
+
+TOVAL_ERROR FFT::set_size(size_t size)
+{
+    if (size < MIN_SIZE || size > max_n || !is_power_of_two(size))
+    {
+        return TOVAL_ERROR::PARAMETER_ERROR;
+    }
+
+    n = size;
+    const size_t m = n / 2;
+    uint32_t bits = 0;
+    while ((size_t{1} << bits) < m)
+    {
+        bits++;
+    }
+    for (size_t i = 0; i < m; i++)
+    {
+        uint32_t reversed = 0;
+        for (uint32_t b = 0; b < bits; b++)
+        {
+            reversed |= ((i >> b) & 1u) << (bits - 1 - b);
+        }
+        bit_reverse[i] = reversed;
+    }
+    return TOVAL_ERROR::NO_ERROR;
+}
+
+// In place on work_re / work_im, input already in bit reversed order
+void FFT::complex_fft(size_t m)
+{
+    for (size_t span = 1; span < m; span <<= 1)
+    {
+        const size_t stride = max_n / (2 * span);      // twiddle step for this stage's 2 * span point butterflies
+        for (size_t start = 0; start < m; start += 2 * span)
+        {
+            for (size_t k = 0; k < span; k++)
+            {
+                const float wr = cos_table[k * stride];
+                const float wi = -sin_table[k * stride];
+                const size_t a = start + k;
+                const size_t b = a + span;
+                const float tr = work_re[b] * wr - work_im[b] * wi;
+                const float ti = work_re[b] * wi + work_im[b] * wr;
+                work_re[b] = work_re[a] - tr;
+                work_im[b] = work_im[a] - ti;
+                work_re[a] += tr;
+                work_im[a] += ti;
+            }
+        }
+    }
+}
+
+void FFT::forward(const float* pIn, float* pRe, float* pIm)
+{
+    const size_t m = n / 2;
+    for (size_t i = 0; i < m; i++)
+    {
+        const size_t j = bit_reverse[i];
+        work_re[j] = pIn[2 * i];
+        work_im[j] = pIn[2 * i + 1];
+    }
+    complex_fft(m);
+
+    // Z = FFT of the packed pairs. X[k] = (Z[k] + conj(Z[m-k])) / 2 - i W^k (Z[k] - conj(Z[m-k])) / 2
+    const size_t stride = max_n / n;
+    pRe[0] = work_re[0] + work_im[0];
+    pIm[0] = 0.0f;
+    pRe[m] = work_re[0] - work_im[0];
+    pIm[m] = 0.0f;
+    for (size_t k = 1; k < m; k++)
+    {
+        const float zr = work_re[k];
+        const float zi = work_im[k];
+        const float cr = work_re[m - k];
+        const float ci = -work_im[m - k];
+
+        const float even_re = 0.5f * (zr + cr);
+        const float even_im = 0.5f * (zi + ci);
+        const float odd_re = 0.5f * (zi - ci);      // -i (Z - conj) / 2
+        const float odd_im = -0.5f * (zr - cr);
+
+        const float wr = cos_table[k * stride];
+        const float wi = -sin_table[k * stride];
+        pRe[k] = even_re + odd_re * wr - odd_im * wi;
+        pIm[k] = even_im + odd_re * wi + odd_im * wr;
+    }
+}
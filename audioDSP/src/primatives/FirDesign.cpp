@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cmath>
+#include "FirDesign.h"
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+
+double sinc(double x)
+{
+    return (std::abs(x) < 1.0e-12) ? 1.0 : std::sin(pi * x) / (pi * x);
+}
+
+// t in [0, 1] across the window
+double blackman(double t)
+{
+    t = std::clamp(t, 0.0, 1.0);
+    return 0.42 - 0.5 * std::cos(2.0 * pi * t) + 0.08 * std::cos(4.0 * pi * t);
+}
+
+// Windowed sinc lowpass of n taps centred on centre, scaled to unity gain at DC
+void lowpass(double* h, size_t n, double cutoff, double centre, double window_span)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++)
+    {
+        const double x = static_cast<double>(i) - centre;
+        h[i] = 2.0 * cutoff * sinc(2.0 * cutoff * x) * blackman(0.5 + x / window_span);
+        sum += h[i];
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        h[i] /= sum;
+    }
+}
+
+} // namespace
+
+void fir_design(FirType type, size_t num_taps, double cutoff, double fraction, float* h)
+{
+    if (num_taps == 0)
+    {
+        return;
+    }
+
+    double taps[FIR_DESIGN_MAX_TAPS] = {};
+    num_taps = std::min(num_taps, FIR_DESIGN_MAX_TAPS);
+    const size_t odd = (num_taps % 2 == 1) ? num_taps : num_taps - 1;
+    const size_t centre = (odd - 1) / 2;
+    const double span = static_cast<double>(odd + 1);     // keeps the end taps off zero
+
+    switch (type)
+    {
+        case FirType::LOWPASS:
+            lowpass(taps, num_taps, cutoff, (num_taps - 1) / 2.0, static_cast<double>(num_taps + 1));
+            break;
+
+        case FirType::HIGHPASS:
+            // Spectral inversion of the lowpass, so odd length only
+            lowpass(taps, odd, cutoff, static_cast<double>(centre), span);
+            for (size_t i = 0; i < odd; i++)
+            {
+                taps[i] = -taps[i];
+            }
+            taps[centre] += 1.0;
+            break;
+
+        case FirType::HALFBAND:
+        {
+            lowpass(taps, odd, 0.25, static_cast<double>(centre), span);
+            double sum = 0.0;
+            for (size_t i = 0; i < odd; i++)
+            {
+                const size_t distance = (i > centre) ? i - centre : centre - i;
+                if (distance != 0 && distance % 2 == 0)
+                {
+                    taps[i] = 0.0;      // sinc zeros, exact rather than rounding noise
+                }
+                sum += taps[i];
+            }
+            for (size_t i = 0; i < odd; i++)
+            {
+                taps[i] /= sum;
+            }
+            break;
+        }
+
+        case FirType::FRACTIONAL_DELAY:
+            // Full band sinc shifted by fraction, the window moves with it
+            lowpass(taps, num_taps, 0.5, static_cast<double>((num_taps - 1) / 2) + fraction, static_cast<double>(num_taps + 1));
+            break;
+
+        case FirType::DC_BLOCK:
+            for (size_t i = 0; i < odd; i++)
+            {
+                taps[i] = -1.0 / static_cast<double>(odd);
+            }
+            taps[centre] += 1.0;
+            break;
+    }
+
+    for (size_t i = 0; i < num_taps; i++)
+    {
+        h[i] = static_cast<float>(taps[i]);
+    }
+}
@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <array>
+#include <utility>
+#include "FirFilter.h"
+#include "TOVALsimd.h"
+
+namespace {
+
+using MonoKernel = void (*)(float*, uint32_t&, const float*, const float*, float*, size_t);
+using StereoKernel = void (*)(float*, float*, uint32_t&, const float*, const float*, const float*, float*, float*, size_t);
+
+// x unaligned (a window into the history), h aligned. Four accumulators when Length allows, so the
+// multiply-adds of one output overlap instead of queueing on a single register.
+template <size_t Length>
+inline float dot(const float* x, const float* h)
+{
+    constexpr size_t ACC = (Length % 16 == 0) ? 4 : 2;
+
+    simd::f32x4 acc[ACC];
+    for (size_t a = 0; a < ACC; a++)
+    {
+        acc[a] = simd::zero();
+    }
+    for (size_t i = 0; i < Length; i += ACC * simd::width)
+    {
+        for (size_t a = 0; a < ACC; a++)
+        {
+            acc[a] = simd::madd(simd::load(x + i + a * simd::width), simd::load_aligned(h + i + a * simd::width), acc[a]);
+        }
+    }
+    for (size_t a = ACC / 2; a > 0; a /= 2)
+    {
+        for (size_t b = 0; b < a; b++)
+        {
+            acc[b] = simd::add(acc[b], acc[b + a]);
+        }
+    }
+    return simd::hsum(acc[0]);
+}
+
+// Two channels against the same taps, each group of taps loaded once
+template <size_t Length>
+inline void dot2(const float* x0, const float* x1, const float* h, float& y0, float& y1)
+{
+    simd::f32x4 a0 = simd::zero();
+    simd::f32x4 a1 = simd::zero();
+    simd::f32x4 b0 = simd::zero();
+    simd::f32x4 b1 = simd::zero();
+    for (size_t i = 0; i < Length; i += 2 * simd::width)
+    {
+        const simd::f32x4 h0 = simd::load_aligned(h + i);
+        const simd::f32x4 h1 = simd::load_aligned(h + i + simd::width);
+        a0 = simd::madd(simd::load(x0 + i), h0, a0);
+        a1 = simd::madd(simd::load(x0 + i + simd::width), h1, a1);
+        b0 = simd::madd(simd::load(x1 + i), h0, b0);
+        b1 = simd::madd(simd::load(x1 + i + simd::width), h1, b1);
+    }
+    y0 = simd::hsum(simd::add(a0, a1));
+    y1 = simd::hsum(simd::add(b0, b1));
+}
+
+// Writes x[0, n) into the doubled ring of 2 * Length after position, n <= Length. Returns the new position.
+template <size_t Length>
+inline uint32_t push(float* history, uint32_t position, const float* x, size_t n)
+{
+    constexpr size_t RING = 2 * Length;
+
+    uint32_t p = position;
+    for (size_t i = 0; i < n; i++)
+    {
+        p = (p + 1 == RING) ? 0 : p + 1;
+        history[p] = x[i];
+        history[p + RING] = x[i];
+    }
+    return p;
+}
+
+/*
+    position is where the newest input sits in the ring of 2 * Length, its window is the Length floats
+    ending at history[position + 2 * Length]. Inputs go in a chunk of up to Length at a time, which the
+    spare Length of ring leaves room for without touching any window of the chunk, then the dot products
+    follow. The vector loads so never wait on a scalar store still in flight, and reading the whole chunk
+    first makes pOut == pIn safe.
+*/
+template <size_t Length>
+void run_mono(float* history, uint32_t& position, const float* coeffs, const float* pIn, float* pOut, size_t n)
+{
+    constexpr size_t RING = 2 * Length;
+
+    uint32_t p = position;
+    for (size_t start = 0; start < n; start += Length)
+    {
+        const size_t count = std::min(n - start, Length);
+        push<Length>(history, p, pIn + start, count);
+        for (size_t i = 0; i < count; i++)
+        {
+            p = (p + 1 == RING) ? 0 : p + 1;
+            pOut[start + i] = dot<Length>(history + p + RING - Length + 1, coeffs);
+        }
+    }
+    position = p;
+}
+
+template <size_t Length>
+void run_stereo(float* history0, float* history1, uint32_t& position, const float* coeffs,
+                const float* pIn0, const float* pIn1, float* pOut0, float* pOut1, size_t n)
+{
+    constexpr size_t RING = 2 * Length;
+
+    uint32_t p = position;
+    for (size_t start = 0; start < n; start += Length)
+    {
+        const size_t count = std::min(n - start, Length);
+        push<Length>(history0, p, pIn0 + start, count);
+        push<Length>(history1, p, pIn1 + start, count);
+        for (size_t i = 0; i < count; i++)
+        {
+            p = (p + 1 == RING) ? 0 : p + 1;
+            const size_t window = p + RING - Length + 1;
+            dot2<Length>(history0 + window, history1 + window, coeffs, pOut0[start + i], pOut1[start + i]);
+        }
+    }
+    position = p;
+}
+
+constexpr size_t NUM_LENGTHS = FirFilter::MAX_TAPS / FirFilter::TAP_GROUP;
+
+template <size_t... I>
+constexpr std::array<MonoKernel, sizeof...(I)> mono_kernels(std::index_sequence<I...>)
+{
+    return { &run_mono<(I + 1) * FirFilter::TAP_GROUP>... };
+}
+
+template <size_t... I>
+constexpr std::array<StereoKernel, sizeof...(I)> stereo_kernels(std::index_sequence<I...>)
+{
+    return { &run_stereo<(I + 1) * FirFilter::TAP_GROUP>... };
+}
+
+// Entry k runs length (k + 1) * TAP_GROUP
+constexpr std::array<MonoKernel, NUM_LENGTHS> MONO_KERNELS = mono_kernels(std::make_index_sequence<NUM_LENGTHS>{});
+constexpr std::array<StereoKernel, NUM_LENGTHS> STEREO_KERNELS = stereo_kernels(std::make_index_sequence<NUM_LENGTHS>{});
+
+} // namespace
+
+TOVAL_ERROR FirFilter::firfilter_init(uint16_t num_channels, size_t max_taps, TOVAL_Arena& arena)
+{
+    if (num_channels == 0 || max_taps == 0 || max_taps > MAX_TAPS)
+    {
+        return TOVAL_ERROR::CONFIG_ERROR;
+    }
+
+    this->num_channels = num_channels;
+    max_length = (max_taps + TAP_GROUP - 1) / TAP_GROUP * TAP_GROUP;
+    coeffs = arena.alloc<float>(max_length);
+    history = arena.alloc<float>(num_channels * HISTORY_PER_LENGTH * max_length);
+    position = arena.alloc<uint32_t>(num_channels);
+    if (arena.failed())
+    {
+        return TOVAL_ERROR::MEMORY_ERROR;
+    }
+
+    // Pass through until the first set_taps
+    const float unit = 1.0f;
+    length = 0;
+    return set_taps(&unit, 1);
+}
+
+void FirFilter::firfilter_reset()
+{
+    std::fill(history.begin(), history.end(), 0.0f);
+    std::fill(position.begin(), position.end(), 0u);
+}
+
+TOVAL_ERROR FirFilter::set_taps(const float* taps, size_t num_taps)
+{
+    if (taps == nullptr)
+    {
+        return TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    if (num_taps == 0 || num_taps > max_length)
+    {
+        return TOVAL_ERROR::PARAMETER_ERROR;
+    }
+
+    const size_t new_length = (num_taps + TAP_GROUP - 1) / TAP_GROUP * TAP_GROUP;
+    if (new_length != length)
+    {
+        length = new_length;
+        firfilter_reset();      // ring positions mean something else at another length
+    }
+    this->num_taps = num_taps;
+
+    for (size_t j = 0; j < length; j++)
+    {
+        const size_t k = length - 1 - j;
+        coeffs[j] = (k < num_taps) ? taps[k] : 0.0f;
+    }
+
+    mono = MONO_KERNELS[length / TAP_GROUP - 1];
+    stereo = STEREO_KERNELS[length / TAP_GROUP - 1];
+    return TOVAL_ERROR::NO_ERROR;
+}
+
+void FirFilter::process_channel(const float* pIn, float* pOut, size_t n, uint16_t ch)
+{
+    mono(&history[ch * HISTORY_PER_LENGTH * max_length], position[ch], coeffs.data(), pIn, pOut, n);
+}
+
+TOVAL_ERROR FirFilter::firfilter_process(const AudioBlockView& in, const AudioBlockView& out)
+{
+    if (in.raw() == nullptr || out.raw() == nullptr)
+    {
+        return TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    if (in.num_channels() < num_channels || out.num_channels() < num_channels || out.num_frames() < in.num_frames())
+    {
+        return TOVAL_ERROR::SIZE_ERROR;
+    }
+    for (uint16_t ch = 0; ch < num_channels; ++ch)
+    {
+        if (in.channel(ch) == nullptr || out.channel(ch) == nullptr)
+        {
+            return TOVAL_ERROR::NULL_POINTER_ERROR;
+        }
+    }
+
+    const size_t n = in.num_frames();
+    uint16_t ch = 0;
+    for (; ch + 1 < num_channels; ch += 2)
+    {
+        // Pairs share a position as long as the channels have only ever been run together
+        if (position[ch] != position[ch + 1])
+        {
+            process_channel(in.channel(ch), out.channel(ch), n, ch);
+            process_channel(in.channel(ch + 1), out.channel(ch + 1), n, ch + 1);
+            continue;
+        }
+        stereo(&history[ch * HISTORY_PER_LENGTH * max_length], &history[(ch + 1) * HISTORY_PER_LENGTH * max_length], position[ch], coeffs.data(),
+               in.channel(ch), in.channel(ch + 1), out.channel(ch), out.channel(ch + 1), n);
+        position[ch + 1] = position[ch];
+    }
+    if (ch < num_channels)
+    {
+        process_channel(in.channel(ch), out.channel(ch), n, ch);
+    }
+    return TOVAL_ERROR::NO_ERROR;
+}
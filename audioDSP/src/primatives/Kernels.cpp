@@ -0,0 +1,45 @@
+#include "Kernels.h"
+
+namespace {
+
+// CPUID (and the OS having enabled the wider register state) looked at once per process.
+// The CPU check comes first: a variant's accessor is itself built for that ISA.
+TOVAL_KernelIsa detect_isa()
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")
+        && kernels_avx512() != nullptr)
+    {
+        return KERNEL_ISA_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && kernels_avx2() != nullptr)
+    {
+        return KERNEL_ISA_AVX2;
+    }
+#endif
+    return KERNEL_ISA_GENERIC;
+}
+
+} // namespace
+
+TOVAL_KernelIsa kernels_best_supported()
+{
+    static const TOVAL_KernelIsa best = detect_isa();
+    return best;
+}
+
+const TOVAL_Kernels& kernels_select(TOVAL_KernelIsa requested)
+{
+    const TOVAL_KernelIsa best = kernels_best_supported();
+    const TOVAL_KernelIsa isa = (requested == KERNEL_ISA_AUTO || requested > best) ? best : requested;
+
+    const TOVAL_Kernels* table = nullptr;
+    switch (isa)
+    {
+        case KERNEL_ISA_AVX512: table = kernels_avx512(); break;
+        case KERNEL_ISA_AVX2:   table = kernels_avx2();   break;
+        default:                break;
+    }
+    return (table != nullptr) ? *table : *kernels_generic();
+}
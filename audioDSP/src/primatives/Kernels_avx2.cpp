@@ -0,0 +1,326 @@
+#include "Kernels.h"
+
+// AVX2 + FMA variant. Built with -mavx2 -mfma (see audioDSP/src/CMakeLists.txt), empty otherwise.
+
+#if defined(__AVX2__) && defined(__FMA__)
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <immintrin.h>
+
+namespace {
+
+float dot(const float* a, const float* b, size_t n)
+{
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    for (; i + 8 <= n; i += 8)
+    {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+
+    const __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+    for (; i < n; ++i)
+    {
+        sum = _mm_fmadd_ss(_mm_load_ss(a + i), _mm_load_ss(b + i), sum);
+    }
+    return _mm_cvtss_f32(sum);
+}
+
+// The recursion cannot go wide, but one FMA per sample halves the dependency chain
+void onepole_gain(const float* pIn, float* pOut, size_t n, float alpha, float gain, float* state)
+{
+    const __m128 a = _mm_set_ss(alpha);
+    const __m128 b = _mm_set_ss(1 - alpha);
+    const __m128 g = _mm_set_ss(gain);
+    __m128 y = _mm_set_ss(*state);
+    for (size_t i = 0; i < n; ++i)
+    {
+        y = _mm_fmadd_ss(a, y, _mm_mul_ss(b, _mm_load_ss(pIn + i)));
+        _mm_store_ss(pOut + i, _mm_mul_ss(y, g));
+    }
+    *state = _mm_cvtss_f32(y);
+}
+
+void meter(const float* pIn, size_t n, TOVAL_MeterAccum* meter)
+{
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256 peak = _mm256_setzero_ps();
+    __m256 squares = _mm256_setzero_ps();
+    __m256 clips = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m256 x = _mm256_loadu_ps(pIn + i);
+        const __m256 level = _mm256_andnot_ps(sign, x);
+        peak = _mm256_max_ps(peak, level);
+        squares = _mm256_fmadd_ps(x, x, squares);
+        clips = _mm256_add_ps(clips, _mm256_and_ps(_mm256_cmp_ps(level, one, _CMP_GE_OQ), one));
+    }
+
+    __m128 p = _mm_max_ps(_mm256_castps256_ps128(peak), _mm256_extractf128_ps(peak, 1));
+    p = _mm_max_ps(p, _mm_movehl_ps(p, p));
+    p = _mm_max_ss(p, _mm_movehdup_ps(p));
+    __m128 sq = _mm_add_ps(_mm256_castps256_ps128(squares), _mm256_extractf128_ps(squares, 1));
+    sq = _mm_add_ps(sq, _mm_movehl_ps(sq, sq));
+    sq = _mm_add_ss(sq, _mm_movehdup_ps(sq));
+    __m128 c = _mm_add_ps(_mm256_castps256_ps128(clips), _mm256_extractf128_ps(clips, 1));
+    c = _mm_add_ps(c, _mm_movehl_ps(c, c));
+    c = _mm_add_ss(c, _mm_movehdup_ps(c));
+    p = _mm_max_ss(p, _mm_set_ss(meter->peak));
+    for (; i < n; ++i)
+    {
+        const __m128 x = _mm_load_ss(pIn + i);
+        const __m128 level = _mm_andnot_ps(_mm256_castps256_ps128(sign), x);
+        p = _mm_max_ss(p, level);
+        sq = _mm_fmadd_ss(x, x, sq);
+        c = _mm_add_ss(c, _mm_and_ps(_mm_cmp_ss(level, _mm256_castps256_ps128(one), _CMP_GE_OQ), _mm256_castps256_ps128(one)));
+    }
+    meter->peak = _mm_cvtss_f32(p);
+    meter->sum_squares += _mm_cvtss_f32(sq);
+    meter->clips += static_cast<uint32_t>(_mm_cvtss_f32(c));
+}
+
+// Same shape as the generic one: metering inside the recursion adds loop carried chains that cost more
+// than an 8 wide pass over each 64 samples while they are still in L1.
+void onepole_gain_meter(const float* pIn, float* pOut, size_t n, float alpha, float gain, float* state, TOVAL_MeterAccum* accum)
+{
+    constexpr size_t CHUNK = 64;
+    for (size_t i = 0; i < n; i += CHUNK)
+    {
+        const size_t count = std::min(CHUNK, n - i);
+        onepole_gain(pIn + i, pOut + i, count, alpha, gain, state);
+        meter(pOut + i, count, accum);
+    }
+}
+
+void delay_mix(const float* pIn, const float* pWet, float* pFeed, float* pOut, size_t n, float feedback, float mix)
+{
+    const __m256 fb = _mm256_set1_ps(feedback);
+    const __m256 wet_mix = _mm256_set1_ps(mix);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m256 x = _mm256_loadu_ps(pIn + i);
+        const __m256 y = _mm256_load_ps(pWet + i);
+        _mm256_store_ps(pFeed + i, _mm256_fmadd_ps(fb, y, x));
+        _mm256_storeu_ps(pOut + i, _mm256_fmadd_ps(wet_mix, _mm256_sub_ps(y, x), x));
+    }
+    for (; i < n; ++i)
+    {
+        const __m128 x = _mm_load_ss(pIn + i);
+        const __m128 y = _mm_load_ss(pWet + i);
+        _mm_store_ss(pFeed + i, _mm_fmadd_ss(_mm_set_ss(feedback), y, x));
+        _mm_store_ss(pOut + i, _mm_fmadd_ss(_mm_set_ss(mix), _mm_sub_ss(y, x), x));
+    }
+}
+
+// All eight lanes in one register, one pass over the block
+void biquad_lanes(const float* pIn, float* pOut, size_t n, const float* coeffs, float* state, size_t num_stages, size_t num_lanes)
+{
+    constexpr size_t L = TOVAL_KERNEL_LANES;
+    (void)num_lanes;
+    for (size_t i = 0; i < n; ++i)
+    {
+        __m256 x = _mm256_set1_ps(pIn[i]);
+        for (size_t s = 0; s < num_stages; ++s)
+        {
+            const float* c = coeffs + s * 5 * L;
+            float* z = state + s * 2 * L;
+            const __m256 y = _mm256_fmadd_ps(_mm256_load_ps(c), x, _mm256_load_ps(z));
+            _mm256_store_ps(z, _mm256_fnmadd_ps(_mm256_load_ps(c + 3 * L), y, _mm256_fmadd_ps(_mm256_load_ps(c + L), x, _mm256_load_ps(z + L))));
+            _mm256_store_ps(z + L, _mm256_fnmadd_ps(_mm256_load_ps(c + 4 * L), y, _mm256_mul_ps(_mm256_load_ps(c + 2 * L), x)));
+            x = y;
+        }
+        _mm256_store_ps(pOut + i * L, x);
+    }
+}
+
+// Sample formats. Strided and 24 bit input is read with 32 bit gathers at each sample's first byte and
+// sign extended from the low bits. A gather reads past a 16 or 24 bit sample, so the gather loop stops
+// while another sample follows the last lane and the tail is read one sample at a time.
+template <TOVAL_PcmFormat F> constexpr size_t pcm_bytes = (F == PCM_INT16) ? 2 : (F == PCM_INT24) ? 3 : 4;
+template <TOVAL_PcmFormat F> constexpr float pcm_full_scale = (F == PCM_INT16) ? 32768.0f : (F == PCM_INT24) ? 8388608.0f : 2147483648.0f;
+template <TOVAL_PcmFormat F> constexpr float pcm_top = (F == PCM_INT16) ? 32767.0f : (F == PCM_INT24) ? 8388607.0f : 2147483520.0f;
+
+template <TOVAL_PcmFormat F>
+int32_t read_pcm(const uint8_t* p)
+{
+    if constexpr (F == PCM_INT16)
+    {
+        int16_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+    else if constexpr (F == PCM_INT24)
+    {
+        return static_cast<int32_t>(uint32_t{p[0]} << 8 | uint32_t{p[1]} << 16 | uint32_t{p[2]} << 24) >> 8;
+    }
+    else
+    {
+        int32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+}
+
+template <TOVAL_PcmFormat F>
+void write_pcm(uint8_t* p, int32_t value)
+{
+    if constexpr (F == PCM_INT16)
+    {
+        const int16_t v = static_cast<int16_t>(value);
+        std::memcpy(p, &v, sizeof(v));
+    }
+    else if constexpr (F == PCM_INT24)
+    {
+        p[0] = static_cast<uint8_t>(value);
+        p[1] = static_cast<uint8_t>(value >> 8);
+        p[2] = static_cast<uint8_t>(value >> 16);
+    }
+    else
+    {
+        std::memcpy(p, &value, sizeof(value));
+    }
+}
+
+template <TOVAL_PcmFormat F>
+void pcm_to_float_format(const void* pIn, size_t stride, float* pOut, size_t n)
+{
+    constexpr size_t BYTES = pcm_bytes<F>;
+    constexpr float scale = 1.0f / pcm_full_scale<F>;
+    const uint8_t* src = static_cast<const uint8_t*>(pIn);
+    const size_t step = stride * BYTES;
+    const __m256 vscale = _mm256_set1_ps(scale);
+    size_t i = 0;
+
+    if (F == PCM_INT16 && stride == 1)
+    {
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256i x = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * BYTES)));
+            _mm256_storeu_ps(pOut + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), vscale));
+        }
+    }
+    else if (F == PCM_INT32 && stride == 1)
+    {
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * BYTES));
+            _mm256_storeu_ps(pOut + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), vscale));
+        }
+    }
+    else
+    {
+        constexpr int SHIFT = 32 - 8 * static_cast<int>(BYTES);
+        const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(step)));
+        for (; (F == PCM_INT32) ? i + 8 <= n : i + 8 < n; i += 8)
+        {
+            __m256i x = _mm256_i32gather_epi32(reinterpret_cast<const int*>(src + i * step), offsets, 1);
+            if constexpr (SHIFT > 0)
+            {
+                x = _mm256_srai_epi32(_mm256_slli_epi32(x, SHIFT), SHIFT);
+            }
+            _mm256_storeu_ps(pOut + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), vscale));
+        }
+    }
+    for (; i < n; ++i)
+    {
+        pOut[i] = static_cast<float>(read_pcm<F>(src + i * step)) * scale;
+    }
+}
+
+// Saturate first so the floor and conversion stay in range, then round half up
+template <TOVAL_PcmFormat F>
+void float_to_pcm_format(const float* pIn, const float* pDither, void* pOut, size_t stride, size_t n)
+{
+    constexpr size_t BYTES = pcm_bytes<F>;
+    uint8_t* dst = static_cast<uint8_t*>(pOut);
+    const size_t step = stride * BYTES;
+    const __m256 scale = _mm256_set1_ps(pcm_full_scale<F>);
+    const __m256 bottom = _mm256_set1_ps(-pcm_full_scale<F>);
+    const __m256 top = _mm256_set1_ps(pcm_top<F>);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    alignas(32) int32_t lanes[8];
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m256 d = (pDither != nullptr) ? _mm256_loadu_ps(pDither + i) : _mm256_setzero_ps();
+        __m256 x = _mm256_fmadd_ps(_mm256_loadu_ps(pIn + i), scale, d);
+        x = _mm256_min_ps(_mm256_max_ps(x, bottom), top);
+        const __m256i q = _mm256_cvttps_epi32(_mm256_floor_ps(_mm256_add_ps(x, half)));
+
+        if (F == PCM_INT32 && stride == 1)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * BYTES), q);
+        }
+        else if (F == PCM_INT16 && stride == 1)
+        {
+            const __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(q), _mm256_extracti128_si256(q, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * BYTES), packed);
+        }
+        else
+        {
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), q);
+            for (size_t k = 0; k < 8; ++k)
+            {
+                write_pcm<F>(dst + (i + k) * step, lanes[k]);
+            }
+        }
+    }
+    for (; i < n; ++i)
+    {
+        float x = pIn[i] * pcm_full_scale<F> + (pDither != nullptr ? pDither[i] : 0.0f);
+        x = std::min(std::max(x, -pcm_full_scale<F>), pcm_top<F>);
+        write_pcm<F>(dst + i * step, static_cast<int32_t>(std::floor(x + 0.5f)));
+    }
+}
+
+void pcm_to_float(const void* pIn, size_t stride, float* pOut, size_t n, TOVAL_PcmFormat format)
+{
+    switch (format)
+    {
+        case PCM_INT16: pcm_to_float_format<PCM_INT16>(pIn, stride, pOut, n); break;
+        case PCM_INT24: pcm_to_float_format<PCM_INT24>(pIn, stride, pOut, n); break;
+        case PCM_INT32: pcm_to_float_format<PCM_INT32>(pIn, stride, pOut, n); break;
+    }
+}
+
+void float_to_pcm(const float* pIn, const float* pDither, void* pOut, size_t stride, size_t n, TOVAL_PcmFormat format)
+{
+    switch (format)
+    {
+        case PCM_INT16: float_to_pcm_format<PCM_INT16>(pIn, pDither, pOut, stride, n); break;
+        case PCM_INT24: float_to_pcm_format<PCM_INT24>(pIn, pDither, pOut, stride, n); break;
+        case PCM_INT32: float_to_pcm_format<PCM_INT32>(pIn, pDither, pOut, stride, n); break;
+    }
+}
+
+constexpr TOVAL_Kernels table = { KERNEL_ISA_AVX2, "avx2", dot, onepole_gain, delay_mix, biquad_lanes, onepole_gain_meter, meter, pcm_to_float, float_to_pcm };
+
+} // namespace
+
+const TOVAL_Kernels* kernels_avx2()
+{
+    return &table;
+}
+
+#else
+
+const TOVAL_Kernels* kernels_avx2()
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,122 @@
+#include "Kernels.h"
+
+// AVX-512F variant. Built with -mavx512f -mavx2 -mfma (see audioDSP/src/CMakeLists.txt), empty otherwise.
+// Loop tails use masked loads and stores instead of a scalar remainder. The one pole recursion gains
+// nothing from wider registers, so those entries are the AVX2 ones.
+
+#if defined(__AVX512F__) && defined(__AVX2__) && defined(__FMA__)
+
+#include <algorithm>
+#include <immintrin.h>
+
+// GCC 12's avx512fintrin.h seeds shuffles with _mm512_undefined_ps(), which -Wuninitialized and
+// -Wmaybe-uninitialized (the reduce_max path) flag
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+namespace {
+
+inline __mmask16 tail_mask(size_t remaining)
+{
+    return static_cast<__mmask16>((1u << remaining) - 1u);
+}
+
+float dot(const float* a, const float* b, size_t n)
+{
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+    }
+    for (; i + 16 <= n; i += 16)
+    {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+    }
+    if (i < n)
+    {
+        const __mmask16 m = tail_mask(n - i);
+        acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a + i), _mm512_maskz_loadu_ps(m, b + i), acc1);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+void delay_mix(const float* pIn, const float* pWet, float* pFeed, float* pOut, size_t n, float feedback, float mix)
+{
+    const __m512 fb = _mm512_set1_ps(feedback);
+    const __m512 wet_mix = _mm512_set1_ps(mix);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m512 x = _mm512_loadu_ps(pIn + i);
+        const __m512 y = _mm512_load_ps(pWet + i);
+        _mm512_store_ps(pFeed + i, _mm512_fmadd_ps(fb, y, x));
+        _mm512_storeu_ps(pOut + i, _mm512_fmadd_ps(wet_mix, _mm512_sub_ps(y, x), x));
+    }
+    if (i < n)
+    {
+        const __mmask16 m = tail_mask(n - i);
+        const __m512 x = _mm512_maskz_loadu_ps(m, pIn + i);
+        const __m512 y = _mm512_maskz_load_ps(m, pWet + i);
+        _mm512_mask_store_ps(pFeed + i, m, _mm512_fmadd_ps(fb, y, x));
+        _mm512_mask_storeu_ps(pOut + i, m, _mm512_fmadd_ps(wet_mix, _mm512_sub_ps(y, x), x));
+    }
+}
+
+void meter(const float* pIn, size_t n, TOVAL_MeterAccum* meter)
+{
+    const __m512 one = _mm512_set1_ps(1.0f);
+    __m512 peak = _mm512_setzero_ps();
+    __m512 squares = _mm512_setzero_ps();
+    __m512 clips = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m512 x = _mm512_loadu_ps(pIn + i);
+        const __m512 level = _mm512_abs_ps(x);
+        peak = _mm512_max_ps(peak, level);
+        squares = _mm512_fmadd_ps(x, x, squares);
+        clips = _mm512_mask_add_ps(clips, _mm512_cmp_ps_mask(level, one, _CMP_GE_OQ), clips, one);
+    }
+    if (i < n)
+    {
+        const __mmask16 m = tail_mask(n - i);
+        const __m512 x = _mm512_maskz_loadu_ps(m, pIn + i);
+        const __m512 level = _mm512_abs_ps(x);
+        peak = _mm512_max_ps(peak, level);
+        squares = _mm512_fmadd_ps(x, x, squares);
+        clips = _mm512_mask_add_ps(clips, _mm512_cmp_ps_mask(level, one, _CMP_GE_OQ), clips, one);
+    }
+    meter->peak = std::max(meter->peak, _mm512_reduce_max_ps(peak));
+    meter->sum_squares += _mm512_reduce_add_ps(squares);
+    meter->clips += static_cast<uint32_t>(_mm512_reduce_add_ps(clips));
+}
+
+} // namespace
+
+const TOVAL_Kernels* kernels_avx512()
+{
+    static const TOVAL_Kernels table = [] {
+        TOVAL_Kernels t = *kernels_avx2();
+        t.isa = KERNEL_ISA_AVX512;
+        t.name = "avx512";
+        t.dot = dot;
+        t.delay_mix = delay_mix;
+        t.meter = meter;
+        return t;
+    }();
+    return &table;
+}
+
+#else
+
+const TOVAL_Kernels* kernels_avx512()
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <cmath>
+#include "Kernels.h"
+#include "TOVALsimd.h"
+
+// Build baseline: the 4 lane simd wrapper (SSE2, NEON or scalar). Matches the pre-dispatch results exactly.
+
+namespace {
+
+float dot(const float* a, const float* b, size_t n)
+{
+    return simd::dot(a, b, n);
+}
+
+void onepole_gain(const float* pIn, float* pOut, size_t n, float alpha, float gain, float* state)
+{
+    float y = *state;
+    for (size_t i = 0; i < n; ++i)
+    {
+        y = (1 - alpha) * pIn[i] + alpha * y;
+        pOut[i] = y * gain;
+    }
+    *state = y;
+}
+
+void meter(const float* pIn, size_t n, TOVAL_MeterAccum* meter)
+{
+    const simd::f32x4 one = simd::set1(1.0f);
+    simd::f32x4 peak = simd::zero();
+    simd::f32x4 squares = simd::zero();
+    simd::f32x4 clips = simd::zero();
+    size_t i = 0;
+    for (; i + simd::width <= n; i += simd::width)
+    {
+        const simd::f32x4 x = simd::load(pIn + i);
+        const simd::f32x4 level = simd::abs(x);
+        peak = simd::max(peak, level);
+        squares = simd::madd(x, x, squares);
+        clips = simd::add(clips, simd::floor(simd::min(level, one)));     // 1 at or above full scale, else 0
+    }
+
+    float peak_sum = std::fmax(meter->peak, simd::hmax(peak));
+    float square_sum = simd::hsum(squares);
+    uint32_t clip_sum = static_cast<uint32_t>(simd::hsum(clips));
+    for (; i < n; ++i)
+    {
+        const float level = std::fabs(pIn[i]);
+        peak_sum = std::fmax(peak_sum, level);
+        square_sum += pIn[i] * pIn[i];
+        clip_sum += (level >= 1.0f);
+    }
+    meter->peak = peak_sum;
+    meter->sum_squares += square_sum;
+    meter->clips += clip_sum;
+}
+
+// Metered 64 samples at a time straight after the recursion writes them, still in L1. Cheaper than
+// metering inside the recursion, which would add loop carried chains of its own.
+void onepole_gain_meter(const float* pIn, float* pOut, size_t n, float alpha, float gain, float* state, TOVAL_MeterAccum* accum)
+{
+    constexpr size_t CHUNK = 64;
+    for (size_t i = 0; i < n; i += CHUNK)
+    {
+        const size_t count = std::min(CHUNK, n - i);
+        onepole_gain(pIn + i, pOut + i, count, alpha, gain, state);
+        meter(pOut + i, count, accum);
+    }
+}
+
+void delay_mix(const float* pIn, const float* pWet, float* pFeed, float* pOut, size_t n, float feedback, float mix)
+{
+    const simd::f32x4 fb = simd::set1(feedback);
+    const simd::f32x4 wet_mix = simd::set1(mix);
+    size_t i = 0;
+    for (; i + simd::width <= n; i += simd::width)
+    {
+        const simd::f32x4 x = simd::load(pIn + i);
+        const simd::f32x4 y = simd::load_aligned(pWet + i);
+        simd::store_aligned(pFeed + i, simd::add(x, simd::mul(fb, y)));
+        simd::store(pOut + i, simd::add(x, simd::mul(wet_mix, simd::sub(y, x))));
+    }
+    for (; i < n; ++i)
+    {
+        const float x = pIn[i];
+        const float y = pWet[i];
+        pFeed[i] = x + feedback * y;
+        pOut[i] = x + mix * (y - x);
+    }
+}
+
+// Four lanes per register, so up to two passes over the block
+void biquad_lanes(const float* pIn, float* pOut, size_t n, const float* coeffs, float* state, size_t num_stages, size_t num_lanes)
+{
+    constexpr size_t L = TOVAL_KERNEL_LANES;
+    for (size_t group = 0; group < num_lanes; group += simd::width)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            simd::f32x4 x = simd::set1(pIn[i]);
+            for (size_t s = 0; s < num_stages; ++s)
+            {
+                const float* c = coeffs + s * 5 * L + group;
+                float* z = state + s * 2 * L + group;
+                const simd::f32x4 z1 = simd::load_aligned(z);
+                const simd::f32x4 z2 = simd::load_aligned(z + L);
+                const simd::f32x4 y = simd::madd(simd::load_aligned(c), x, z1);
+                simd::store_aligned(z, simd::sub(simd::madd(simd::load_aligned(c + L), x, z2), simd::mul(simd::load_aligned(c + 3 * L), y)));
+                simd::store_aligned(z + L, simd::sub(simd::mul(simd::load_aligned(c + 2 * L), x), simd::mul(simd::load_aligned(c + 4 * L), y)));
+                x = y;
+            }
+            simd::store_aligned(pOut + i * L + group, x);
+        }
+    }
+}
+
+// Sample format access, one instantiation per format so the switch happens once per call
+template <TOVAL_PcmFormat F>
+int32_t read_pcm(const void* p, size_t index)
+{
+    if constexpr (F == PCM_INT16)
+    {
+        return static_cast<const int16_t*>(p)[index];
+    }
+    else if constexpr (F == PCM_INT24)
+    {
+        const uint8_t* b = static_cast<const uint8_t*>(p) + 3 * index;
+        return static_cast<int32_t>(uint32_t{b[0]} << 8 | uint32_t{b[1]} << 16 | uint32_t{b[2]} << 24) >> 8;
+    }
+    else
+    {
+        return static_cast<const int32_t*>(p)[index];
+    }
+}
+
+template <TOVAL_PcmFormat F>
+void write_pcm(void* p, size_t index, int32_t value)
+{
+    if constexpr (F == PCM_INT16)
+    {
+        static_cast<int16_t*>(p)[index] = static_cast<int16_t>(value);
+    }
+    else if constexpr (F == PCM_INT24)
+    {
+        uint8_t* b = static_cast<uint8_t*>(p) + 3 * index;
+        b[0] = static_cast<uint8_t>(value);
+        b[1] = static_cast<uint8_t>(value >> 8);
+        b[2] = static_cast<uint8_t>(value >> 16);
+    }
+    else
+    {
+        static_cast<int32_t*>(p)[index] = value;
+    }
+}
+
+// 2^15, 2^23, 2^31. The top of the range is full scale - 1, or for int32 the largest float below 2^31.
+template <TOVAL_PcmFormat F> constexpr float pcm_full_scale = (F == PCM_INT16) ? 32768.0f : (F == PCM_INT24) ? 8388608.0f : 2147483648.0f;
+template <TOVAL_PcmFormat F> constexpr float pcm_top = (F == PCM_INT16) ? 32767.0f : (F == PCM_INT24) ? 8388607.0f : 2147483520.0f;
+
+template <TOVAL_PcmFormat F>
+void pcm_to_float_format(const void* pIn, size_t stride, float* pOut, size_t n)
+{
+    constexpr float scale = 1.0f / pcm_full_scale<F>;
+    int32_t lanes[simd::width];
+    size_t i = 0;
+    for (; i + simd::width <= n; i += simd::width)
+    {
+        for (size_t k = 0; k < simd::width; ++k)
+        {
+            lanes[k] = read_pcm<F>(pIn, (i + k) * stride);
+        }
+        simd::store(pOut + i, simd::mul(simd::to_float(simd::load(lanes)), simd::set1(scale)));
+    }
+    for (; i < n; ++i)
+    {
+        pOut[i] = static_cast<float>(read_pcm<F>(pIn, i * stride)) * scale;
+    }
+}
+
+// Saturate first so floor and the conversion stay in range, then round half up
+template <TOVAL_PcmFormat F>
+void float_to_pcm_format(const float* pIn, const float* pDither, void* pOut, size_t stride, size_t n)
+{
+    const simd::f32x4 scale = simd::set1(pcm_full_scale<F>);
+    const simd::f32x4 bottom = simd::set1(-pcm_full_scale<F>);
+    const simd::f32x4 top = simd::set1(pcm_top<F>);
+    const simd::f32x4 half = simd::set1(0.5f);
+    int32_t lanes[simd::width];
+    size_t i = 0;
+    for (; i + simd::width <= n; i += simd::width)
+    {
+        simd::f32x4 x = simd::mul(simd::load(pIn + i), scale);
+        if (pDither != nullptr)
+        {
+            x = simd::add(x, simd::load(pDither + i));
+        }
+        x = simd::min(simd::max(x, bottom), top);
+        simd::store(lanes, simd::to_int(simd::floor(simd::add(x, half))));
+        for (size_t k = 0; k < simd::width; ++k)
+        {
+            write_pcm<F>(pOut, (i + k) * stride, lanes[k]);
+        }
+    }
+    for (; i < n; ++i)
+    {
+        float x = pIn[i] * pcm_full_scale<F> + (pDither != nullptr ? pDither[i] : 0.0f);
+        x = std::fmin(std::fmax(x, -pcm_full_scale<F>), pcm_top<F>);
+        write_pcm<F>(pOut, i * stride, static_cast<int32_t>(std::floor(x + 0.5f)));
+    }
+}
+
+void pcm_to_float(const void* pIn, size_t stride, float* pOut, size_t n, TOVAL_PcmFormat format)
+{
+    switch (format)
+    {
+        case PCM_INT16: pcm_to_float_format<PCM_INT16>(pIn, stride, pOut, n); break;
+        case PCM_INT24: pcm_to_float_format<PCM_INT24>(pIn, stride, pOut, n); break;
+        case PCM_INT32: pcm_to_float_format<PCM_INT32>(pIn, stride, pOut, n); break;
+    }
+}
+
+void float_to_pcm(const float* pIn, const float* pDither, void* pOut, size_t stride, size_t n, TOVAL_PcmFormat format)
+{
+    switch (format)
+    {
+        case PCM_INT16: float_to_pcm_format<PCM_INT16>(pIn, pDither, pOut, stride, n); break;
+        case PCM_INT24: float_to_pcm_format<PCM_INT24>(pIn, pDither, pOut, stride, n); break;
+        case PCM_INT32: float_to_pcm_format<PCM_INT32>(pIn, pDither, pOut, stride, n); break;
+    }
+}
+
+constexpr TOVAL_Kernels table = { KERNEL_ISA_GENERIC, "generic", dot, onepole_gain, delay_mix, biquad_lanes, onepole_gain_meter, meter, pcm_to_float, float_to_pcm };
+
+} // namespace
+
+const TOVAL_Kernels* kernels_generic()
+{
+    return &table;
+}
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include "BiquadCache.h"
+#include "LRCrossover.h"
+
+namespace {
+
+constexpr float BUTTERWORTH_Q = 0.70710678f;
+
+} // namespace
+
+TOVAL_ERROR LRCrossover::lrcrossover_init(float sample_rate, uint16_t num_channels, TOVAL_Arena& arena)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (sample_rate <= 0.0f || num_channels == 0 || num_channels > TOVAL_MAX_CHANNELS)
+    {
+        return TOVAL_ERROR::CONFIG_ERROR;
+    }
+
+    coeffs = arena.alloc<float>(MAX_STAGES * 5 * LANES);
+    state = arena.alloc<float>(static_cast<size_t>(num_channels) * MAX_STAGES * 2 * LANES);
+    if (arena.failed())
+    {
+        return TOVAL_ERROR::MEMORY_ERROR;
+    }
+
+    this->sample_rate = sample_rate;
+    this->num_channels = num_channels;
+    num_bands = 0;
+    num_stages = 0;
+    kernels = &kernels_select(KERNEL_ISA_AUTO);
+    return ret;
+}
+
+void LRCrossover::lrcrossover_reset()
+{
+    std::fill(state.begin(), state.end(), 0.0f);
+}
+
+void LRCrossover::set_kernels(const TOVAL_Kernels& table)
+{
+    kernels = &table;
+}
+
+void LRCrossover::set_stage(size_t stage, size_t lane, const BiquadCoeffs& design)
+{
+    for (size_t k = 0; k < 5; k++)
+    {
+        coeffs[(stage * 5 + k) * LANES + lane] = static_cast<float>(design.c[k]);
+    }
+}
+
+TOVAL_ERROR LRCrossover::set_bands(uint32_t num_bands, const float* frequencies)
+{
+    if (num_bands < 2 || num_bands > MAX_BANDS)
+    {
+        return TOVAL_ERROR::PARAMETER_ERROR;
+    }
+    if (frequencies == nullptr)
+    {
+        return TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+    for (uint32_t j = 0; j + 1 < num_bands; j++)
+    {
+        if (!(frequencies[j] > 0.0f && frequencies[j] < 0.5f * sample_rate) || (j > 0 && frequencies[j] < frequencies[j - 1]))
+        {
+            return TOVAL_ERROR::PARAMETER_ERROR;
+        }
+    }
+
+    // Unused lanes (and stages past this band count) stay all zero and output silence
+    std::fill(coeffs.begin(), coeffs.end(), 0.0f);
+
+    const BiquadCoeffs identity = { { 1.0, 0.0, 0.0, 0.0, 0.0 } };
+    for (uint32_t j = 0; j + 1 < num_bands; j++)
+    {
+        // Designed once per process for this rate and frequency, a preset load on another instance is a copy
+        BiquadCoeffs lowpass;
+        BiquadCoeffs highpass;
+        BiquadCoeffs allpass;
+        biquad_cache().lookup({ BiquadType::LOWPASS, frequencies[j], BUTTERWORTH_Q, 0.0f, sample_rate }, lowpass);
+        biquad_cache().lookup({ BiquadType::HIGHPASS, frequencies[j], BUTTERWORTH_Q, 0.0f, sample_rate }, highpass);
+        biquad_cache().lookup({ BiquadType::ALLPASS, frequencies[j], BUTTERWORTH_Q, 0.0f, sample_rate }, allpass);
+
+        for (uint32_t band = 0; band < num_bands; band++)
+        {
+            if (j < band)
+            {
+                set_stage(2 * j, band, highpass);
+                set_stage(2 * j + 1, band, highpass);
+            }
+            else if (j == band)
+            {
+                set_stage(2 * j, band, lowpass);
+                set_stage(2 * j + 1, band, lowpass);
+            }
+            else
+            {
+                set_stage(2 * j, band, allpass);
+                set_stage(2 * j + 1, band, identity);
+            }
+        }
+    }
+
+    this->num_bands = num_bands;
+    num_stages = 2 * (num_bands - 1);
+    return TOVAL_ERROR::NO_ERROR;
+}
+
+void LRCrossover::split(uint16_t ch, const float* pIn, float* pBands, size_t n)
+{
+    float* pState = &state[static_cast<size_t>(ch) * MAX_STAGES * 2 * LANES];
+    kernels->biquad_lanes(pIn, pBands, n, coeffs.data(), pState, num_stages, num_bands);
+}
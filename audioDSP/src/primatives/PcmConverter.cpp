@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <cmath>
+#include "PcmConverter.h"
+
+namespace {
+
+constexpr uint64_t RNG_SEED = 0x9E3779B97F4A7C15ull;
+
+float full_scale(TOVAL_PcmFormat format)
+{
+    switch (format)
+    {
+        case PCM_INT16: return 32768.0f;
+        case PCM_INT24: return 8388608.0f;
+        default:        return 2147483648.0f;
+    }
+}
+
+} // namespace
+
+TOVAL_ERROR PcmConverter::pcm_init(uint16_t num_channels, TOVAL_Arena& arena)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    noise = arena.alloc<float>(CHUNK);
+    shaped = arena.alloc<float>(CHUNK);
+    error = arena.alloc<float>(2 * static_cast<size_t>(num_channels));
+    if (arena.failed())
+    {
+        return TOVAL_ERROR::MEMORY_ERROR;
+    }
+
+    this->num_channels = num_channels;
+    kernels = &kernels_select(KERNEL_ISA_AUTO);
+    pcm_reset();
+    return ret;
+}
+
+void PcmConverter::pcm_reset()
+{
+    std::fill(error.begin(), error.end(), 0.0f);
+    rng = RNG_SEED;
+}
+
+void PcmConverter::set_kernels(const TOVAL_Kernels& table)
+{
+    kernels = &table;
+}
+
+size_t PcmConverter::sample_bytes(TOVAL_PcmFormat format)
+{
+    switch (format)
+    {
+        case PCM_INT16: return 2;
+        case PCM_INT24: return 3;
+        default:        return 4;
+    }
+}
+
+TOVAL_ERROR PcmConverter::check(const void* const* pp, TOVAL_PcmFormat format, TOVAL_PcmLayout layout, uint16_t channels_used) const
+{
+    if (format > PCM_INT32 || layout > PCM_INTERLEAVED)
+    {
+        return TOVAL_ERROR::PARAMETER_ERROR;
+    }
+    if (pp == nullptr)
+    {
+        return TOVAL_ERROR::NULL_POINTER_ERROR;
+    }
+
+    const uint16_t pointers = (layout == PCM_INTERLEAVED) ? 1 : channels_used;
+    for (uint16_t ch = 0; ch < pointers; ch++)
+    {
+        if (pp[ch] == nullptr)
+        {
+            return TOVAL_ERROR::NULL_POINTER_ERROR;
+        }
+    }
+    return TOVAL_ERROR::NO_ERROR;
+}
+
+TOVAL_ERROR PcmConverter::to_float(const void* const* ppIn, size_t first_frame, TOVAL_PcmFormat format, TOVAL_PcmLayout layout, const AudioBlockView& out)
+{
+    TOVAL_ERROR ret = check(ppIn, format, layout, out.num_channels());
+    if (ret != TOVAL_ERROR::NO_ERROR)
+    {
+        return ret;
+    }
+
+    const size_t bytes = sample_bytes(format);
+    const size_t stride = (layout == PCM_INTERLEAVED) ? out.num_channels() : 1;
+    for (uint16_t ch = 0; ch < out.num_channels(); ch++)
+    {
+        const uint8_t* pIn = (layout == PCM_INTERLEAVED)
+            ? static_cast<const uint8_t*>(ppIn[0]) + (first_frame * stride + ch) * bytes
+            : static_cast<const uint8_t*>(ppIn[ch]) + first_frame * bytes;
+        kernels->pcm_to_float(pIn, stride, out.channel(ch), out.num_frames(), format);
+    }
+    return ret;
+}
+
+TOVAL_ERROR PcmConverter::from_float(const AudioBlockView& in, TOVAL_PcmFormat format, TOVAL_PcmLayout layout, void* const* ppOut, size_t first_frame)
+{
+    TOVAL_ERROR ret = check(ppOut, format, layout, in.num_channels());
+    if (ret != TOVAL_ERROR::NO_ERROR)
+    {
+        return ret;
+    }
+    if (in.num_channels() > num_channels)
+    {
+        return TOVAL_ERROR::SIZE_ERROR;
+    }
+
+    const size_t bytes = sample_bytes(format);
+    const size_t stride = (layout == PCM_INTERLEAVED) ? in.num_channels() : 1;
+    const float scale = full_scale(format);
+    const size_t nspc = in.num_frames();
+
+    for (uint16_t ch = 0; ch < in.num_channels(); ch++)
+    {
+        uint8_t* pOut = (layout == PCM_INTERLEAVED)
+            ? static_cast<uint8_t*>(ppOut[0]) + (first_frame * stride + ch) * bytes
+            : static_cast<uint8_t*>(ppOut[ch]) + first_frame * bytes;
+        const float* pIn = in.channel(ch);
+
+        if (dither == DITHER_NONE)
+        {
+            kernels->float_to_pcm(pIn, nullptr, pOut, stride, nspc, format);
+            continue;
+        }
+
+        for (size_t start = 0; start < nspc; start += CHUNK)
+        {
+            const size_t count = std::min(CHUNK, nspc - start);
+            fill_tpdf(noise.data(), count);
+            if (dither == DITHER_TPDF_SHAPED)
+            {
+                shape(pIn + start, noise.data(), shaped.data(), count, scale, &error[2 * ch]);
+                kernels->float_to_pcm(shaped.data(), nullptr, pOut + start * stride * bytes, stride, count, format);
+            }
+            else
+            {
+                kernels->float_to_pcm(pIn + start, noise.data(), pOut + start * stride * bytes, stride, count, format);
+            }
+        }
+    }
+    return ret;
+}
+
+// xorshift64*, each draw gives two samples of the sum of two 16 bit uniforms: triangular on (-1, 1) LSB
+void PcmConverter::fill_tpdf(float* pOut, size_t n)
+{
+    constexpr float SCALE = 1.0f / 65536.0f;
+    uint64_t x = rng;
+    for (size_t i = 0; i < n; i += 2)
+    {
+        x ^= x >> 12;
+        x ^= x << 25;
+        x ^= x >> 27;
+        const uint64_t r = x * 0x2545F4914F6CDD1Dull;
+        pOut[i] = static_cast<float>(static_cast<int32_t>((r & 0xFFFF) + ((r >> 16) & 0xFFFF)) - 65535) * SCALE;
+        if (i + 1 < n)
+        {
+            pOut[i + 1] = static_cast<float>(static_cast<int32_t>(((r >> 32) & 0xFFFF) + (r >> 48)) - 65535) * SCALE;
+        }
+    }
+    rng = x;
+}
+
+/*
+    Error feedback: the target has the last two errors fed back as 2 e[n-1] - e[n-2], so the output is
+    x + e[n] - 2 e[n-1] + e[n-2] and the error (dither included) comes out through (1 - z^-1)^2. The
+    error is limited to 2 LSB so a clipped stretch cannot wind the loop up. Output is the rounded value
+    back over full scale, which float_to_pcm then reproduces exactly.
+*/
+void PcmConverter::shape(const float* pIn, const float* pDither, float* pOut, size_t n, float full_scale, float* error)
+{
+    const float inverse = 1.0f / full_scale;
+    float e1 = error[0];
+    float e2 = error[1];
+    for (size_t i = 0; i < n; ++i)
+    {
+        const float target = pIn[i] * full_scale - (2.0f * e1 - e2);
+        const float y = std::floor(std::clamp(target + pDither[i], -full_scale, full_scale - 1.0f) + 0.5f);
+        e2 = e1;
+        e1 = std::clamp(y - target, -2.0f, 2.0f);
+        pOut[i] = y * inverse;
+    }
+    error[0] = e1;
+    error[1] = e2;
+}
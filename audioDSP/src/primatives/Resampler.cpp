@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include "Resampler.h"
+
+static constexpr double pi = 3.14159265358979323846;
+
+// Zeroth order modified Bessel function, used by the Kaiser window
+static double bessel_i0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; ++k)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+TOVAL_ERROR Resampler::resampler_init(uint32_t in_rate, uint32_t out_rate, uint16_t num_channels, size_t max_block, TOVAL_SrcQuality quality, TOVAL_Arena& arena)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (in_rate == 0 || out_rate == 0 || num_channels == 0 || num_channels > TOVAL_MAX_CHANNELS || max_block == 0)
+    {
+        return TOVAL_ERROR::CONFIG_ERROR;
+    }
+
+    uint32_t divisor = std::gcd(in_rate, out_rate);
+    L = out_rate / divisor;
+    M = in_rate / divisor;
+
+    double beta;
+    switch (quality)
+    {
+        case TOVAL_SrcQuality::SRC_QUALITY_LOW:
+            taps_per_phase = 16;
+            beta = 5.0;
+            break;
+
+        case TOVAL_SrcQuality::SRC_QUALITY_HIGH:
+            taps_per_phase = 64;
+            beta = 9.0;
+            break;
+
+        case TOVAL_SrcQuality::SRC_QUALITY_MEDIUM:
+        default:
+            taps_per_phase = 32;
+            beta = 7.0;
+            break;
+    }
+
+    this->num_channels = num_channels;
+    this->max_block = max_block;
+
+    const size_t length = static_cast<size_t>(L) * taps_per_phase;
+    coeffs = arena.alloc<float>(length);
+    history = arena.alloc<std::span<float>>(num_channels);
+    for (auto& channel : history)
+    {
+        channel = arena.alloc<float>(taps_per_phase - 1 + max_block);
+    }
+    if (arena.failed())
+    {
+        return TOVAL_ERROR::MEMORY_ERROR;
+    }
+
+    // Prototype lowpass at the upsampled rate. Cutoff sits just below the lower of the two Nyquist limits.
+    const double cutoff = 0.95 * 0.5 / static_cast<double>(std::max(L, M));   // cycles per upsampled sample
+    const double centre = 0.5 * static_cast<double>(length - 1);
+    const double i0_beta = bessel_i0(beta);
+
+    // Phase p, tap k uses prototype[k * L + p]. Reverse the taps so they line up with history order.
+    for (uint32_t p = 0; p < L; ++p)
+    {
+        float* pPhase = &coeffs[static_cast<size_t>(p) * taps_per_phase];
+        for (uint32_t k = 0; k < taps_per_phase; ++k)
+        {
+            double t = static_cast<double>(static_cast<size_t>(k) * L + p) - centre;
+            double x = 2.0 * cutoff * t;
+            double sinc = (std::fabs(x) < 1e-12) ? 1.0 : std::sin(pi * x) / (pi * x);
+            double r = t / centre;
+            double window = bessel_i0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / i0_beta;
+            pPhase[taps_per_phase - 1 - k] = static_cast<float>(2.0 * cutoff * L * sinc * window);   // L restores the gain lost to zero stuffing
+        }
+    }
+
+    kernels = &kernels_select(KERNEL_ISA_AUTO);
+    resampler_reset();
+    return ret;
+}
+
+void Resampler::set_kernels(const TOVAL_Kernels& table)
+{
+    kernels = &table;
+}
+
+void Resampler::resampler_reset()
+{
+    for (auto& channel : history)
+    {
+        std::fill(channel.begin(), channel.end(), 0.0f);
+    }
+    phase = 0;
+    index = taps_per_phase - 1;
+}
+
+void Resampler::resampler_follow(const Resampler& leader)
+{
+    for (auto& channel : history)
+    {
+        std::fill(channel.begin(), channel.end(), 0.0f);
+    }
+    phase = leader.phase;
+    index = leader.index;
+}
+
+size_t Resampler::max_output(size_t nIn) const
+{
+    return (nIn * L + M - 1) / M + 1;
+}
+
+uint32_t Resampler::latency() const
+{
+    return (L * taps_per_phase) / (2 * M);
+}
+
+size_t Resampler::resampler_process(float **ppIn, size_t nIn, float **ppOut)
+{
+    if (ppIn == nullptr || ppOut == nullptr)
+    {
+        return 0;
+    }
+    return resampler_process(AudioBlockView(ppIn, num_channels, nIn), AudioBlockView(ppOut, num_channels, max_output(nIn)));
+}
+
+size_t Resampler::resampler_process(const AudioBlockView& in, const AudioBlockView& out)
+{
+    const size_t nIn = in.num_frames();
+    if (in.raw() == nullptr || out.raw() == nullptr || nIn > max_block
+        || in.num_channels() < num_channels || out.num_channels() < num_channels || out.num_frames() < max_output(nIn))
+    {
+        return 0;
+    }
+
+    const size_t carry = taps_per_phase - 1;
+    const size_t available = carry + nIn;
+    const uint32_t step_int = M / L;
+    const uint32_t step_frac = M % L;
+
+    for (uint16_t ch = 0; ch < num_channels; ++ch)
+    {
+        std::memcpy(history[ch].data() + carry, in.channel(ch), nIn * sizeof(float));
+    }
+
+    // Output positions are the same for every channel, so walk them once and run each channel per output
+    size_t produced = 0;
+    while (index < available)
+    {
+        const float* pPhase = &coeffs[static_cast<size_t>(phase) * taps_per_phase];
+        const size_t start = index - carry;
+
+        for (uint16_t ch = 0; ch < num_channels; ++ch)
+        {
+            out.channel(ch)[produced] = kernels->dot(history[ch].data() + start, pPhase, taps_per_phase);
+        }
+        ++produced;
+
+        phase += step_frac;
+        index += step_int;
+        if (phase >= L)
+        {
+            phase -= L;
+            ++index;
+        }
+    }
+
+    // Keep the last taps_per_phase - 1 inputs for the next block
+    for (uint16_t ch = 0; ch < num_channels; ++ch)
+    {
+        float* pHist = history[ch].data();
+        std::memmove(pHist, pHist + nIn, carry * sizeof(float));
+    }
+    index -= nIn;
+
+    return produced;
+}
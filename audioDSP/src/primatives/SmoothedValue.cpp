@@ -0,0 +1,52 @@
+#include <algorithm>
+#include "SmoothedValue.h"
+
+void SmoothedValue::smoothed_init(float sample_rate, float ramp_ms, float initial)
+{
+    this->sample_rate = (sample_rate > 0.0f) ? sample_rate : 48000.0f;
+    set_ramp_time(ramp_ms);
+    set_immediate(initial);
+}
+
+void SmoothedValue::set_ramp_time(float ramp_ms)
+{
+    this->ramp_ms = std::max(0.0f, ramp_ms);
+    ramp_samples = static_cast<uint32_t>(this->ramp_ms * sample_rate / 1000.0f);
+}
+
+void SmoothedValue::set_immediate(float value)
+{
+    current = value;
+    target = value;
+    remaining = 0;
+}
+
+void SmoothedValue::set_target(float new_target)
+{
+    if (ramp_samples == 0 || new_target == current)
+    {
+        set_immediate(new_target);
+        return;
+    }
+
+    // Restart from wherever the previous ramp got to
+    target = new_target;
+    remaining = ramp_samples;
+    step = (new_target - current) / static_cast<float>(ramp_samples);
+}
+
+void SmoothedValue::skip(size_t n)
+{
+    if (!is_smoothing())
+    {
+        return;
+    }
+
+    const uint32_t m = static_cast<uint32_t>(std::min<size_t>(n, remaining));
+    current += step * static_cast<float>(m);
+    remaining -= m;
+    if (remaining == 0)
+    {
+        current = target;   // land exactly, rounding in the steps never leaks into the settled value
+    }
+}
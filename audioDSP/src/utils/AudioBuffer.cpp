@@ -0,0 +1,50 @@
+#include <algorithm>
+#include "AudioBuffer.h"
+
+size_t AudioBuffer::padded_stride(size_t num_frames)
+{
+    const size_t line = AudioBlockView::ALIGN_FRAMES;
+    size_t stride = std::max<size_t>(line, (num_frames + line - 1) / line * line);
+
+    // Channel starts a multiple of 4 KiB apart map to the same cache sets, nudge them off
+    if ((stride * sizeof(float)) % 4096 == 0)
+    {
+        stride += line;
+    }
+    return stride;
+}
+
+TOVAL_ERROR AudioBuffer::audiobuffer_init(uint16_t num_channels, size_t num_frames, TOVAL_Arena& arena)
+{
+    if (num_channels == 0 || num_channels > TOVAL_MAX_CHANNELS)
+    {
+        return TOVAL_ERROR::CONFIG_ERROR;
+    }
+
+    channel_stride = padded_stride(num_frames);
+    storage = arena.alloc<float>(channel_stride * num_channels);
+    pointers = arena.alloc<float*>(num_channels);
+    if (arena.failed())
+    {
+        return TOVAL_ERROR::MEMORY_ERROR;
+    }
+
+    for (uint16_t ch = 0; ch < num_channels; ch++)
+    {
+        pointers[ch] = storage.data() + ch * channel_stride;
+    }
+    num_ch = num_channels;
+    frames = num_frames;
+    return TOVAL_ERROR::NO_ERROR;
+}
+
+TOVAL_ERROR AudioBuffer::audiobuffer_init(uint16_t num_channels, size_t num_frames)
+{
+    own.arena_init_heap();
+    return audiobuffer_init(num_channels, num_frames, own);
+}
+
+void AudioBuffer::clear()
+{
+    std::fill(storage.begin(), storage.end(), 0.0f);
+}
@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cstring>
+#include "SpscRing.h"
+
+TOVAL_ERROR SpscRing::spsc_init(uint16_t num_channels, size_t min_capacity, TOVAL_Arena& arena)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    if (num_channels == 0 || num_channels > TOVAL_MAX_CHANNELS || min_capacity == 0)
+    {
+        return TOVAL_ERROR::CONFIG_ERROR;
+    }
+
+    size_t size = 1;
+    while (size < min_capacity)
+    {
+        size <<= 1;
+    }
+
+    storage = arena.alloc<float>(size * num_channels);
+    if (arena.failed())
+    {
+        return TOVAL_ERROR::MEMORY_ERROR;
+    }
+
+    this->num_channels = num_channels;
+    mask = size - 1;
+    spsc_reset();
+    return ret;
+}
+
+TOVAL_ERROR SpscRing::spsc_init(uint16_t num_channels, size_t min_capacity)
+{
+    own.arena_init_heap();
+    return spsc_init(num_channels, min_capacity, own);
+}
+
+void SpscRing::spsc_reset()
+{
+    write_count.store(0, std::memory_order_relaxed);
+    read_count.store(0, std::memory_order_relaxed);
+}
+
+size_t SpscRing::readable() const
+{
+    return write_count.load(std::memory_order_acquire) - read_count.load(std::memory_order_relaxed);
+}
+
+size_t SpscRing::writable() const
+{
+    return capacity() - (write_count.load(std::memory_order_relaxed) - read_count.load(std::memory_order_acquire));
+}
+
+size_t SpscRing::push(const float* const* ppIn, size_t n, size_t offset)
+{
+    return push_channels(ppIn, num_channels, n, offset);
+}
+
+// A block with fewer channels than the ring only has that many pointers, the rest of the ring is silenced
+size_t SpscRing::push(const AudioBlockView& block)
+{
+    return push_channels(block.raw(), std::min(block.num_channels(), num_channels), block.num_frames(), block.frame_offset());
+}
+
+size_t SpscRing::push_channels(const float* const* ppIn, uint16_t channels, size_t n, size_t offset)
+{
+    const size_t w = write_count.load(std::memory_order_relaxed);
+    const size_t r = read_count.load(std::memory_order_acquire);
+    n = std::min(n, capacity() - (w - r));
+
+    // Copy as two spans, the wrap is handled once per call rather than per sample
+    const size_t start = w & mask;
+    const size_t first = std::min(n, capacity() - start);
+    for (uint16_t ch = 0; ch < num_channels; ch++)
+    {
+        float* pRing = &storage[ch * capacity()];
+        if (ch < channels)
+        {
+            const float* pIn = ppIn[ch] + offset;
+            std::memcpy(pRing + start, pIn, first * sizeof(float));
+            std::memcpy(pRing, pIn + first, (n - first) * sizeof(float));
+        }
+        else
+        {
+            std::memset(pRing + start, 0, first * sizeof(float));
+            std::memset(pRing, 0, (n - first) * sizeof(float));
+        }
+    }
+
+    write_count.store(w + n, std::memory_order_release);
+    return n;
+}
+
+size_t SpscRing::push_silence(size_t n)
+{
+    const size_t w = write_count.load(std::memory_order_relaxed);
+    const size_t r = read_count.load(std::memory_order_acquire);
+    n = std::min(n, capacity() - (w - r));
+
+    const size_t start = w & mask;
+    const size_t first = std::min(n, capacity() - start);
+    for (uint16_t ch = 0; ch < num_channels; ch++)
+    {
+        float* pRing = &storage[ch * capacity()];
+        std::memset(pRing + start, 0, first * sizeof(float));
+        std::memset(pRing, 0, (n - first) * sizeof(float));
+    }
+
+    write_count.store(w + n, std::memory_order_release);
+    return n;
+}
+
+size_t SpscRing::pop(float **ppOut, size_t n, size_t offset)
+{
+    const size_t r = read_count.load(std::memory_order_relaxed);
+    const size_t w = write_count.load(std::memory_order_acquire);
+    n = std::min(n, w - r);
+
+    const size_t start = r & mask;
+    const size_t first = std::min(n, capacity() - start);
+    for (uint16_t ch = 0; ch < num_channels; ch++)
+    {
+        const float* pRing = &storage[ch * capacity()];
+        float* pOut = ppOut[ch] + offset;
+        std::memcpy(pOut, pRing + start, first * sizeof(float));
+        std::memcpy(pOut + first, pRing, (n - first) * sizeof(float));
+    }
+
+    read_count.store(r + n, std::memory_order_release);
+    return n;
+}
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <cstring>
+#include "TOVALarena.h"
+
+void TOVAL_Arena::arena_init_heap()
+{
+    arena_release();
+    mode = Mode::HEAP;
+}
+
+bool TOVAL_Arena::arena_init_fixed(void* base, size_t size)
+{
+    arena_release();
+    if (base == nullptr || (reinterpret_cast<uintptr_t>(base) & (ALIGNMENT - 1)) != 0)
+    {
+        return false;
+    }
+    mode = Mode::FIXED;
+    this->base = static_cast<uint8_t*>(base);
+    this->size = size;
+    return true;
+}
+
+void TOVAL_Arena::arena_release()
+{
+    rewind(0);
+    mode = Mode::NONE;
+    base = nullptr;
+    size = 0;
+}
+
+void* TOVAL_Arena::alloc_bytes(size_t bytes)
+{
+    const size_t offset = used;
+    const size_t padded = align_up(bytes);
+
+    if (mode == Mode::FIXED)
+    {
+        if (padded > size - std::min(size, offset))
+        {
+            out_of_memory = true;
+            used = offset + padded;     // keep counting so the shortfall is known
+            return nullptr;
+        }
+        used = offset + padded;
+        return base + offset;
+    }
+
+    if (mode == Mode::HEAP)
+    {
+        // Header padded to a full ALIGNMENT so the payload keeps the block's alignment
+        void* raw = ::operator new(align_up(sizeof(HeapBlock)) + padded, std::align_val_t(ALIGNMENT));
+        HeapBlock* block = static_cast<HeapBlock*>(raw);
+        block->next = blocks;
+        block->offset = offset;
+        blocks = block;
+        used = offset + padded;
+        return static_cast<uint8_t*>(raw) + align_up(sizeof(HeapBlock));
+    }
+
+    out_of_memory = true;
+    return nullptr;
+}
+
+void TOVAL_Arena::rewind(size_t mark)
+{
+    while (blocks != nullptr && blocks->offset >= mark)
+    {
+        HeapBlock* next = blocks->next;
+        ::operator delete(blocks, std::align_val_t(ALIGNMENT));
+        blocks = next;
+    }
+    if (mark < used)
+    {
+        used = mark;
+    }
+    out_of_memory = (mode == Mode::FIXED) && (used > size);
+}
@@ -0,0 +1,146 @@
+#include "TOVALtrace.h"
+
+#ifdef TOVAL_ENABLE_TRACE
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+
+namespace {
+
+constexpr size_t RING_CAPACITY = 1 << 16;   // events per thread, power of two
+constexpr size_t MAX_THREADS = 64;
+
+// Single writer (the owning thread). head is published with release so a dump sees whole events.
+struct TraceRing {
+    std::array<TOVAL_TraceEvent, RING_CAPACITY> events;
+    std::atomic<uint64_t> head{0};
+    uint64_t block = 0;
+    uint32_t tid = 0;
+};
+
+std::array<std::atomic<TraceRing*>, MAX_THREADS> rings{};
+std::atomic<uint32_t> ring_count{0};
+
+TraceRing* register_ring()
+{
+    const uint32_t slot = ring_count.fetch_add(1, std::memory_order_relaxed);
+    if (slot >= MAX_THREADS)
+    {
+        return nullptr;     // past the limit the thread simply is not traced
+    }
+    TraceRing* ring = new TraceRing();  // lives until exit, a dump may run after the thread is gone
+    ring->tid = slot + 1;
+    rings[slot].store(ring, std::memory_order_release);
+    return ring;
+}
+
+TraceRing* this_thread_ring()
+{
+    thread_local TraceRing* ring = register_ring();
+    return ring;
+}
+
+} // namespace
+
+void TOVAL_trace_register_thread()
+{
+    this_thread_ring();
+}
+
+void TOVAL_trace_record(const TOVAL_TraceEvent& event)
+{
+    TraceRing* ring = this_thread_ring();
+    if (ring == nullptr)
+    {
+        return;
+    }
+    const uint64_t head = ring->head.load(std::memory_order_relaxed);
+    ring->events[head & (RING_CAPACITY - 1)] = event;
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void TOVAL_trace_next_block()
+{
+    TraceRing* ring = this_thread_ring();
+    if (ring != nullptr)
+    {
+        ring->block++;
+    }
+}
+
+uint64_t TOVAL_trace_block()
+{
+    TraceRing* ring = this_thread_ring();
+    return (ring != nullptr) ? ring->block : 0;
+}
+
+void TOVAL_trace_clear()
+{
+    const uint32_t count = std::min<uint32_t>(ring_count.load(std::memory_order_acquire), MAX_THREADS);
+    for (uint32_t slot = 0; slot < count; slot++)
+    {
+        TraceRing* ring = rings[slot].load(std::memory_order_acquire);
+        if (ring != nullptr)
+        {
+            ring->head.store(0, std::memory_order_release);
+        }
+    }
+}
+
+bool TOVAL_trace_write_chrome_json(const char* path)
+{
+    FILE* file = std::fopen(path, "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    // Timestamps relative to the earliest event so the viewer opens at zero
+    uint64_t origin = UINT64_MAX;
+    const uint32_t count = std::min<uint32_t>(ring_count.load(std::memory_order_acquire), MAX_THREADS);
+    for (uint32_t slot = 0; slot < count; slot++)
+    {
+        const TraceRing* ring = rings[slot].load(std::memory_order_acquire);
+        if (ring == nullptr)
+        {
+            continue;
+        }
+        const uint64_t head = ring->head.load(std::memory_order_acquire);
+        const uint64_t first = (head > RING_CAPACITY) ? head - RING_CAPACITY : 0;
+        for (uint64_t i = first; i < head; i++)
+        {
+            origin = std::min(origin, ring->events[i & (RING_CAPACITY - 1)].begin_ns);
+        }
+    }
+
+    std::fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    bool first_event = true;
+    for (uint32_t slot = 0; slot < count; slot++)
+    {
+        const TraceRing* ring = rings[slot].load(std::memory_order_acquire);
+        if (ring == nullptr)
+        {
+            continue;
+        }
+        const uint64_t head = ring->head.load(std::memory_order_acquire);
+        const uint64_t first = (head > RING_CAPACITY) ? head - RING_CAPACITY : 0;
+        for (uint64_t i = first; i < head; i++)
+        {
+            const TOVAL_TraceEvent& e = ring->events[i & (RING_CAPACITY - 1)];
+            std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%" PRIu32 ",\"ts\":%.3f,\"dur\":%.3f,"
+                               "\"args\":{\"block\":%" PRIu64 ",\"arg0\":%" PRIu32 ",\"arg1\":%" PRIu32 "}}",
+                         first_event ? "" : ",\n", e.name, ring->tid,
+                         static_cast<double>(e.begin_ns - origin) / 1000.0, static_cast<double>(e.end_ns - e.begin_ns) / 1000.0,
+                         e.block, e.arg0, e.arg1);
+            first_event = false;
+        }
+    }
+    std::fprintf(file, "\n]}\n");
+
+    return std::fclose(file) == 0;
+}
+
+#endif // TOVAL_ENABLE_TRACE
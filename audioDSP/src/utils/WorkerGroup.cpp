@@ -0,0 +1,138 @@
+#include "WorkerGroup.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Tells the core this is a spin loop: cheaper for the sibling hyperthread and no memory order stall on exit
+inline void cpu_relax()
+{
+#if defined(__SSE2__) || defined(_M_X64)
+    _mm_pause();
+#elif defined(__aarch64__)
+    __asm__ volatile("yield");
+#endif
+}
+
+// Spins until value moves off seen, then parks. Returns the new value.
+template <typename T>
+T wait_for_change(const std::atomic<T>& value, T seen, uint32_t spin)
+{
+    for (uint32_t i = 0; i < spin; i++)
+    {
+        const T now = value.load(std::memory_order_acquire);
+        if (now != seen)
+        {
+            return now;
+        }
+        cpu_relax();
+    }
+
+    T now = value.load(std::memory_order_acquire);
+    while (now == seen)
+    {
+        value.wait(seen, std::memory_order_acquire);
+        now = value.load(std::memory_order_acquire);
+    }
+    return now;
+}
+
+} // namespace
+
+TOVAL_ERROR WorkerGroup::workers_start(size_t num_workers, uint32_t spin)
+{
+    if (running())
+    {
+        return TOVAL_ERROR::CONFIG_ERROR;
+    }
+    if (num_workers == 0 || num_workers >= TOVAL_MAX_CHANNELS)
+    {
+        return TOVAL_ERROR::PARAMETER_ERROR;
+    }
+
+    this->spin = spin;
+    stopping.store(false);
+    checked_in.store(0);
+
+    // Taken here, not in the thread: a worker scheduled after the first run must still see it as new
+    const uint32_t seen = generation.load();
+    threads.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; i++)
+    {
+        threads.emplace_back([this, seen]() { worker_loop(seen); });
+    }
+    return TOVAL_ERROR::NO_ERROR;
+}
+
+void WorkerGroup::workers_stop()
+{
+    if (!running())
+    {
+        return;
+    }
+
+    stopping.store(true);
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    threads.clear();
+}
+
+void WorkerGroup::run(size_t count, Task task, void* context)
+{
+    if (!running() || count < 2)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            task(context, i);
+        }
+        return;
+    }
+
+    this->task = task;
+    this->context = context;
+    this->count = count;
+    next.store(0, std::memory_order_relaxed);
+    checked_in.store(0, std::memory_order_relaxed);
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+
+    for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count; i = next.fetch_add(1, std::memory_order_relaxed))
+    {
+        task(context, i);
+    }
+
+    // Barrier: every worker has to check in, even one that found nothing left to claim, before the
+    // job fields can be reused by the next run
+    const uint32_t workers = static_cast<uint32_t>(threads.size());
+    uint32_t done = checked_in.load(std::memory_order_acquire);
+    while (done != workers)
+    {
+        done = wait_for_change(checked_in, done, spin);
+    }
+}
+
+void WorkerGroup::worker_loop(uint32_t seen)
+{
+    for (;;)
+    {
+        seen = wait_for_change(generation, seen, spin);
+        if (stopping.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count; i = next.fetch_add(1, std::memory_order_relaxed))
+        {
+            task(context, i);
+        }
+
+        checked_in.fetch_add(1, std::memory_order_acq_rel);
+        checked_in.notify_one();
+    }
+}
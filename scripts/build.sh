@@ -19,14 +19,18 @@ echo "Building Tonal Valley Audio software version $MAJOR_VERSION.$MINOR_VERSION
 
 # Parse command line options
 DELIVERY_FLAG="OFF"
+TRACE_FLAG="OFF"
 TOOLCHAIN_FILE=""
 TOOLCHAIN_NAME="default"  # Default name for the toolchain
 
-while getopts "dt:" opt; do
+while getopts "drt:" opt; do
   case ${opt} in
     d )
       DELIVERY_FLAG="ON"
       ;;
+    r )
+      TRACE_FLAG="ON"
+      ;;
     t )
       TOOLCHAIN_NAME=$OPTARG
       ;;
@@ -59,10 +63,10 @@ BUILD_DIR="../build"
 # Check if build directory exists
 if [ ! -d "$BUILD_DIR" ]; then
     echo "Build directory does not exist. Running CMake configuration..."
-    cmake -S .. -B "$BUILD_DIR" -DDELIVERY=$DELIVERY_FLAG -DCMAKE_TOOLCHAIN_FILE="$TOOLCHAIN_FILE"
+    cmake -S .. -B "$BUILD_DIR" -DDELIVERY=$DELIVERY_FLAG -DTOVAL_ENABLE_TRACE=$TRACE_FLAG -DCMAKE_TOOLCHAIN_FILE="$TOOLCHAIN_FILE"
 else
     echo "Build directory already exists. Running CMake with the specified delivery option."
-    cmake -S .. -B "$BUILD_DIR" -DDELIVERY=$DELIVERY_FLAG -DCMAKE_TOOLCHAIN_FILE="$TOOLCHAIN_FILE"
+    cmake -S .. -B "$BUILD_DIR" -DDELIVERY=$DELIVERY_FLAG -DTOVAL_ENABLE_TRACE=$TRACE_FLAG -DCMAKE_TOOLCHAIN_FILE="$TOOLCHAIN_FILE"
 fi
 
 # Always run the build command
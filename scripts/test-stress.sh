@@ -0,0 +1,20 @@
+#!/bin/bash
+
+# Tail latency stress run: random block sizes with a concurrent parameter storm.
+# Usage: ./test-stress.sh [seconds] [seed] [internal_sample_rate]
+
+source ../build/config.txt
+TEST_EXE_DIR="../build/bin"
+STRESS_EXE="$TEST_EXE_DIR/$TOVAL_STRESS"
+QA_DIR="../QA"
+
+if [ ! -f "$STRESS_EXE" ]; then
+    echo "ERROR: Stress executable not found at $STRESS_EXE"
+    exit 1
+fi
+
+mkdir -p "$QA_DIR"
+
+echo "..Running TOVAL Audio stress test..."
+"$STRESS_EXE" "$@" 2>&1 | tee "$QA_DIR/stress.log"
+exit ${PIPESTATUS[0]}
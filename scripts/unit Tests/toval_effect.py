@@ -0,0 +1,214 @@
+"""
+ctypes wrapper over the TOVAL_Effect_c shared library (audioDSP/inc/TOVALEffect/TOVAL_Effect_c.h).
+
+Runs the real C++ chain from the prototype and plotting scripts, so they check the product rather than
+a numpy copy of it. Audio is float32 planar, shape (channels, frames). process hands the library
+pointers into the arrays themselves, nothing is copied as long as each channel row is contiguous
+float32 (anything else is converted once, up front).
+
+    from toval_effect import Effect
+    fx = Effect(sample_rate=48000)
+    fx.set("GLOBAL", "GLOBAL_ENABLE_FLAG", 1)
+    fx.set("HEADROOM", "ENABLE", 1)
+    fx.set("HEADROOM", "GAIN", -6.0)
+    y = fx.process(x)
+
+Module and parameter names are the ones the JSON test cases use. The library is looked up in
+TOVAL_LIB_PATH (file or folder) first, then in build/lib where scripts/build.sh puts it.
+"""
+
+import ctypes
+import os
+import sys
+
+import numpy as np
+
+ERRORS = ["NO_ERROR", "SIZE_ERROR", "CONFIG_ERROR", "MODULEID_ERROR", "PARAMID_ERROR", "PARAMETER_ERROR",
+          "NULL_POINTER_ERROR", "INPUT_WAV_ERROR", "OUTPUT_WAV_ERROR", "MEMORY_ERROR"]
+
+TYPE_U32, TYPE_F32, TYPE_BLOB = 0, 1, 2
+
+
+class TovalError(RuntimeError):
+    def __init__(self, code, call):
+        name = ERRORS[code] if code < len(ERRORS) else str(code)
+        super().__init__(f"{call} failed: {name}")
+        self.code = code
+
+
+class _Config(ctypes.Structure):
+    _fields_ = [("sample_rate", ctypes.c_float),
+                ("internal_sample_rate", ctypes.c_float),
+                ("src_quality", ctypes.c_uint32)]
+
+
+class _ParamInfo(ctypes.Structure):
+    _fields_ = [("module_id", ctypes.c_uint16),
+                ("param_id", ctypes.c_uint16),
+                ("module_name", ctypes.c_char_p),
+                ("param_name", ctypes.c_char_p),
+                ("type", ctypes.c_uint32),
+                ("read_only", ctypes.c_uint32),
+                ("size", ctypes.c_uint32),
+                ("min", ctypes.c_float),
+                ("max", ctypes.c_float),
+                ("default", ctypes.c_float)]
+
+
+def _library_candidates():
+    names = {"win32": ["TOVAL_Effect_c.dll"], "darwin": ["libTOVAL_Effect_c.dylib"]}.get(sys.platform, ["libTOVAL_Effect_c.so"])
+    override = os.environ.get("TOVAL_LIB_PATH")
+    if override:
+        yield from ([override] if os.path.isfile(override) else [os.path.join(override, n) for n in names])
+    root = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+    for folder in ("build/lib", "build"):
+        for n in names:
+            yield os.path.join(root, folder, n)
+
+
+def _load():
+    for path in _library_candidates():
+        if os.path.isfile(path):
+            lib = ctypes.CDLL(path)
+            break
+    else:
+        raise OSError("TOVAL_Effect_c shared library not found, build it (scripts/build.sh) or set TOVAL_LIB_PATH")
+
+    handle, u32, u16, vp = ctypes.c_void_p, ctypes.c_uint32, ctypes.c_uint16, ctypes.c_void_p
+    lib.TOVAL_effect_version.restype = u32
+    lib.TOVAL_effect_create.restype = handle
+    lib.TOVAL_effect_destroy.argtypes = [handle]
+    lib.TOVAL_effect_destroy.restype = None
+    lib.TOVAL_effect_set_config.argtypes = [handle, ctypes.POINTER(_Config)]
+    lib.TOVAL_effect_init.argtypes = [handle]
+    lib.TOVAL_effect_num_channels.argtypes = [handle, ctypes.POINTER(u32), ctypes.POINTER(u32)]
+    lib.TOVAL_effect_set.argtypes = [handle, u16, u16, vp, u32]
+    lib.TOVAL_effect_get.argtypes = [handle, u16, u16, vp, u32]
+    lib.TOVAL_effect_process.argtypes = [handle, vp, vp, ctypes.c_size_t]
+    lib.TOVAL_effect_analyze.argtypes = [handle]
+    lib.TOVAL_effect_param_count.restype = u32
+    lib.TOVAL_effect_param_info.argtypes = [u32, ctypes.POINTER(_ParamInfo)]
+    for name in ("set_config", "init", "num_channels", "set", "get", "process", "analyze", "param_info"):
+        getattr(lib, "TOVAL_effect_" + name).restype = u32
+    return lib
+
+
+_lib = None
+_params = None
+
+
+def library():
+    global _lib
+    if _lib is None:
+        _lib = _load()
+    return _lib
+
+
+def params():
+    """{(module name, param name): _ParamInfo} for every TOVAL_PARAM_TABLE row."""
+    global _params
+    if _params is None:
+        lib = library()
+        table = {}
+        for index in range(lib.TOVAL_effect_param_count()):
+            info = _ParamInfo()
+            _check(lib.TOVAL_effect_param_info(index, ctypes.byref(info)), "param_info")
+            table[(info.module_name.decode(), info.param_name.decode())] = info
+        _params = table
+    return _params
+
+
+def _check(code, call):
+    if code != 0:
+        raise TovalError(code, call)
+
+
+class Effect:
+    """One TOVAL_Effect instance. Configured and initialised on construction, released on close()."""
+
+    def __init__(self, sample_rate=48000.0, internal_sample_rate=0.0, src_quality=1):
+        self._handle = None
+        self._lib = library()
+        self._handle = self._lib.TOVAL_effect_create()
+        if not self._handle:
+            raise MemoryError("TOVAL_effect_create")
+        try:
+            config = _Config(sample_rate, internal_sample_rate, src_quality)
+            _check(self._lib.TOVAL_effect_set_config(self._handle, ctypes.byref(config)), "set_config")
+            self.init()
+        except Exception:
+            self.close()
+            raise
+
+    def init(self):
+        """Back to the state of a fresh instance, every parameter at its default."""
+        _check(self._lib.TOVAL_effect_init(self._handle), "init")
+        n_in, n_out = ctypes.c_uint32(), ctypes.c_uint32()
+        _check(self._lib.TOVAL_effect_num_channels(self._handle, ctypes.byref(n_in), ctypes.byref(n_out)), "num_channels")
+        self.in_channels, self.out_channels = n_in.value, n_out.value
+
+    def close(self):
+        if self._handle:
+            self._lib.TOVAL_effect_destroy(self._handle)
+            self._handle = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def __del__(self):
+        self.close()
+
+    def set(self, module, param, value):
+        info = params()[(module, param)]
+        data = ctypes.c_float(value) if info.type == TYPE_F32 else ctypes.c_uint32(int(value))
+        _check(self._lib.TOVAL_effect_set(self._handle, info.module_id, info.param_id, ctypes.addressof(data), 4), f"set {module}.{param}")
+
+    def get(self, module, param):
+        """Scalars come back as float / int, blobs (meters, spectra) as raw bytes."""
+        info = params()[(module, param)]
+        data = ctypes.create_string_buffer(info.size)
+        _check(self._lib.TOVAL_effect_get(self._handle, info.module_id, info.param_id, ctypes.addressof(data), info.size), f"get {module}.{param}")
+        if info.type == TYPE_F32:
+            return ctypes.c_float.from_buffer(data).value
+        if info.type == TYPE_U32:
+            return ctypes.c_uint32.from_buffer(data).value
+        return data.raw
+
+    def analyze(self):
+        _check(self._lib.TOVAL_effect_analyze(self._handle), "analyze")
+
+    def process(self, x, out=None, block_size=1024):
+        """
+        Runs x, shape (in_channels, frames), through the chain in block_size frame calls (None for one
+        call) and returns out, shape (out_channels, frames). out may be x to process in place.
+        """
+        x = _planar(x, self.in_channels, "x")
+        frames = x.shape[1]
+        if out is None:
+            out = np.empty((self.out_channels, frames), dtype=np.float32)
+        elif _planar(out, self.out_channels, "out") is not out or out.shape[1] < frames:
+            raise ValueError("out must be contiguous float32 rows of at least x's frames")
+
+        step = frames if not block_size else block_size
+        for start in range(0, frames, max(step, 1)):
+            n = min(step, frames - start)
+            _check(self._lib.TOVAL_effect_process(self._handle, _pointers(x, start), _pointers(out, start), n), "process")
+        return out
+
+
+def _planar(a, channels, name):
+    a = np.asarray(a)
+    if a.ndim != 2 or a.shape[0] < channels:
+        raise ValueError(f"{name} must be (channels >= {channels}, frames), got {a.shape}")
+    if a.dtype != np.float32 or a.strides[1] != 4:
+        a = np.ascontiguousarray(a, dtype=np.float32)     # the one copy, only for other layouts
+    return a
+
+
+def _pointers(a, start):
+    """Channel pointer array into a's own memory, from frame start on."""
+    base = a.ctypes.data + start * 4
+    return (ctypes.c_void_p * a.shape[0])(*[base + ch * a.strides[0] for ch in range(a.shape[0])])
@@ -0,0 +1,67 @@
+#ifndef INPUTCACHE_H
+#define INPUTCACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "AudioBuffer.h"
+#include "TOVALaudio.h"
+
+/*
+    Decoded test inputs, kept as planar float32 files so repeated runs of a corpus skip libsndfile.
+
+    Each entry is <cache dir>/<content hash>.f32: a header page, then every channel padded to
+    AudioBuffer::padded_stride, so the channels land 64 byte aligned once the file is mapped. open maps
+    it copy on write and view() points straight into the mapping, no decode and no copy. Entries are keyed
+    on the wav file's bytes, so test cases sharing an input.wav share one entry and an edited wav never
+    hits a stale one.
+
+    Hashing the bytes means reading the whole wav, so source_hash remembers it per source path in a
+    small <cache dir>/<path hash>.src stamp with the file's size and modification time. A run whose wav
+    still has the stamped size and time costs a stat and a stamp read. Only a new, touched or edited wav
+    is read in full again.
+
+    POSIX only (mmap). Elsewhere source_hash is 0, so nothing is hashed, mapped or stored and runs decode as before.
+*/
+
+class InputCache
+{
+public:
+
+    InputCache() = default;
+    ~InputCache();
+    InputCache(const InputCache&) = delete;
+    InputCache& operator=(const InputCache&) = delete;
+
+    // 64 bit FNV-1a over the file's bytes, 0 when it can't be read
+    static uint64_t content_hash(const std::string& path);
+
+    // content_hash of path, taken from its stamp in dir while the file's size and time still match it
+    static uint64_t source_hash(const std::string& dir, const std::string& path);
+
+    // Maps the entry for hash from dir. False on a miss, or an entry from another layout version.
+    bool open(const std::string& dir, uint64_t hash);
+
+    // Writes channels as the entry for hash. Written to a temporary name and renamed, so a run in
+    // parallel never maps half a file.
+    static bool store(const std::string& dir, uint64_t hash, uint32_t sample_rate, const AudioBlockView& channels);
+
+    // Valid until the cache is closed or destroyed
+    AudioBlockView view() const;
+    uint32_t sample_rate() const { return rate; }
+
+    void close();
+
+private:
+
+    static std::string entry_path(const std::string& dir, uint64_t hash);
+    static std::string stamp_path(const std::string& dir, const std::string& source);
+
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+    std::vector<float*> pointers;
+    size_t frames = 0;
+    uint32_t rate = 0;
+};
+
+#endif // INPUTCACHE_H
@@ -2,41 +2,22 @@
 #define JSON_PARAMS_H
 
 #include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
 #include "TOVALaudio.h"
+#include "TOVALparams.h"
 #include "TOVAL_Effect.h"
-#include <map>
-#include <vector>
 
-// Forward declare the effect class and necessary enums
+// Forward declare the effect class
 class TOVAL_Effect;
-namespace Modules {
-    enum ModuleID {
-        GLOBAL = 0,
-        HEADROOM,
-        // Add other modules here
-    };
-    // Enum for Param IDs within the HEADROOM module
-    namespace HeadroomParams {
-        enum HeadroomParamID {
-            ENABLE = 0,
-            GAIN,
-            // Add more ParamIDs for Headroom module
-        };
-    }
 
-    namespace GlobalParams {
-        enum GlobalParamID {
-            ENABLE = 0,
-            // Add more ParamIDs for Headroom module
-        };
-    }
-}
+// Looks up a JSON (module, param) name pair in TOVAL_PARAM_TABLE, nullptr when unknown
+const TOVAL_ParamDescriptor* find_param_descriptor(const std::string& moduleName, const std::string& paramName);
 
-// Define the mappings as external to be used across files
-extern std::map<std::string, uint16_t> moduleNameToID;
-extern std::map<std::string, uint16_t> paramNameToID;
+// Converts the static module / param sections of a test case into set_batch entries
+TOVAL_ERROR collect_json_params(const nlohmann::json& jsonObj, std::vector<TOVAL_ParamSet>& batch);
 
-// Function to load and set configuration from JSON
-TOVAL_ERROR load_and_set_json_params(const nlohmann::json& jsonObj, TOVAL_Effect& effect);
+// Function to load and set configuration from JSON. applied, when given, receives the batch that was set.
+TOVAL_ERROR load_and_set_json_params(const nlohmann::json& jsonObj, TOVAL_Effect& effect, std::vector<TOVAL_ParamSet>* applied = nullptr);
 
 #endif // JSON_PARAMS_H
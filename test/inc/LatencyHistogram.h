@@ -0,0 +1,47 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <array>
+#include <cstdint>
+
+/*
+    HDR style latency histogram, nanoseconds.
+
+    Log linear buckets: values below 128 get a bucket each, above that every power of two is split into
+    128 equal buckets, so any recorded value is reported within 1 / 128 (< 0.8 %) of itself from 1 ns up
+    to the full uint64_t range. Storage is a fixed array, record is a couple of shifts and an increment,
+    nothing allocates after construction.
+*/
+
+class LatencyHistogram
+{
+public:
+
+    void record(uint64_t value);
+    void reset();
+
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total ? lowest : 0; }
+    uint64_t max() const { return highest; }
+    double mean() const { return total ? static_cast<double>(sum) / static_cast<double>(total) : 0.0; }
+
+    // Smallest value at or below which percent of the recorded values fall, as the top of its bucket
+    uint64_t percentile(double percent) const;
+
+private:
+
+    static constexpr unsigned SUB_BITS = 7;
+    static constexpr uint64_t SUB_COUNT = uint64_t{1} << SUB_BITS;
+    static constexpr size_t BUCKETS = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+    static size_t bucket_of(uint64_t value);
+    static uint64_t bucket_top(size_t bucket);
+
+    std::array<uint64_t, BUCKETS> counts{};
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t lowest = UINT64_MAX;
+    uint64_t highest = 0;
+};
+
+#endif // LATENCYHISTOGRAM_H
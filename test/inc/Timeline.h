@@ -0,0 +1,63 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+#include "TOVALaudio.h"
+#include "TOVAL_Effect.h"
+
+/*
+    Parameter automation for a test case.
+
+    params.json may carry a "TIMELINE" array of points, each a sample position followed by the same
+    module / param layout as the static section:
+
+        "TIMELINE": [
+            { "sample": 0,     "HEADROOM": { "GAIN": -6.0 } },
+            { "ms": 500.0,     "HEADROOM": { "GAIN": -20.0 }, "DELAY": { "MIX": 0.5 } }
+        ]
+
+    Params inside a point are applied in the order they are written, so a ramp time goes ahead of the
+    value it should ramp.
+
+    It is compiled once into a flat, sorted array of TOVAL_ParamEvent with absolute sample positions and
+    cached as timeline.bin in the output folder, keyed on a hash of params.json. Replay only walks that
+    array with a cursor, rebasing offsets into a scratch buffer sized up front, so a render does no
+    parsing and no allocation however dense the automation is.
+*/
+
+class Timeline
+{
+public:
+
+    // Compiles the TIMELINE section, or loads cachePath when it was built from the same params.json text.
+    // An empty cachePath skips the cache. No TIMELINE section leaves the timeline empty.
+    TOVAL_ERROR load(const nlohmann::json& jsonObj, const std::string& jsonText, float sample_rate, const std::string& cachePath);
+
+    bool empty() const { return events.empty(); }
+    size_t size() const { return events.size(); }
+
+    // Back to the first event at or after position
+    void rewind(uint64_t position = 0);
+
+    // Last value of every param automated before position, for an instance that starts rendering there
+    void state_at(uint64_t position, std::vector<TOVAL_ParamSet>& state) const;
+
+    const TOVAL_ParamEvent* data() const { return events.data(); }
+
+    // Events falling in [position, position + nspc), offsets made block relative. Valid until the next call.
+    const TOVAL_ParamEvent* next_block(uint64_t position, size_t nspc, size_t& num_events);
+
+private:
+
+    TOVAL_ERROR compile(const nlohmann::ordered_json& timeline, float sample_rate);
+    bool read_cache(const std::string& path, uint64_t hash);
+    void write_cache(const std::string& path, uint64_t hash) const;
+
+    std::vector<TOVAL_ParamEvent> events;   // absolute sample_offset, sorted
+    std::vector<TOVAL_ParamEvent> scratch;  // block relative copy handed to process_events
+    size_t cursor = 0;
+};
+
+#endif // TIMELINE_H
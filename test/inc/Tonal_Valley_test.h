@@ -3,7 +3,11 @@
 #include <filesystem>
 #include <sndfile.h>  // libsndfile for WAV handling
 #include "TOVALaudio.h"  // Your module's header file
+#include "AudioBuffer.h"
+#include "PcmConverter.h"
 #include "TOVAL_Effect.h"
+#include "Timeline.h"
+#include "InputCache.h"
 
 #define INPUT_FOLDER "./test_wavs"  // Folder containing WAV files
 #define OUTPUT_FILE "output.wav"    // Output file
@@ -15,17 +19,14 @@ class Tonal_Valley_test
 private:
 
     std::vector<float> inputBuffer;
-    std::vector<float> outputBuffer;
-
-    std::vector<std::vector<float>> deinterleavedInput;
-    std::vector<std::vector<float>> deinterleavedOutput;
-    std::vector<std::vector<float>> deinterleavedRef;
-
-
-    std::vector<float*> ppIn;
-    std::vector<float*> ppOut;
-    std::vector<float*> ppRef;
+    std::vector<int16_t> outputBuffer;     // interleaved 16 bit, what saveWav writes
 
+    // Planar, 64 byte aligned copies the effect processes straight out of and into
+    AudioBuffer input;              // decoded this run, empty when the input came from the cache
+    InputCache inputCache;          // mapped decode from an earlier run
+    AudioBlockView inputView;       // whichever of the two holds the input
+    AudioBuffer output;
+    AudioBuffer reference;
 
 
     size_t nspc = 1024;
@@ -35,12 +36,7 @@ private:
 
     int numFrames;
 
-    struct Test_config
-    {
-        float sample_rate;
-        uint16_t In_num_channels;
-        uint16_t Out_num_channels;
-    }test_config;
+    TOVAL_Config test_config;
 
     struct WavHeader
         {
@@ -65,16 +61,38 @@ public:
     WavHeader outputWavHeader; // Stores output WAV file header info
 
     TOVAL_Effect tonal_valley_test;
+
+    // Optional "CONFIG" section of params.json, applied in prepareAudio
+    float internal_sample_rate = 0.0f;
+    uint16_t src_quality = SRC_QUALITY_MEDIUM;
+    TOVAL_Dither outputDither = DITHER_NONE;     // requantisation of the 16 bit output file, "OUTPUT_DITHER"
+    size_t channelWorkers = 0;                   // TOVAL_Effect_parallel_start workers, "CHANNEL_WORKERS", 0 = off
+
+    // Optional "TIMELINE" section of params.json, replayed by processAudio
+    Timeline timeline;
+
+    // Static params.json values, re-applied to every segment instance of a parallel render
+    std::vector<TOVAL_ParamSet> staticParams;
+
+    // Segments rendered in parallel by processAudio, "RENDER_THREADS" in CONFIG or the third argument. 0 = every core.
+    size_t renderThreads = 1;
+
+    // Folder of decoded inputs shared by every test case (see InputCache.h), empty to always decode
+    std::string inputCacheDir;
     
     Tonal_Valley_test();
     ~Tonal_Valley_test();
 
     TOVAL_ERROR loadWav(const std::string &filename);
+    void setInputHeader(uint32_t sampleRate, uint16_t numChannels, size_t frames);
     void printWavHeader(const WavHeader& header);
     TOVAL_ERROR prepareAudio();
     TOVAL_ERROR processAudio();
+    TOVAL_ERROR processAudioParallel(size_t threads);
+    TOVAL_ERROR renderRange(TOVAL_Effect& effect, Timeline& automation, size_t from, size_t to, size_t keepFrom);
+    TOVAL_ERROR createSegmentEffect(TOVAL_Effect& effect, const std::vector<TOVAL_ParamSet>& state);
     TOVAL_ERROR saveWav(const std::string &filename);
 
-    TOVAL_ERROR deinterleave(const std::vector<float>& interleaved, std::vector<std::vector<float>>& channels, int numChannels);
+    TOVAL_ERROR deinterleave(const std::vector<float>& interleaved, AudioBuffer& channels, int numChannels);
 
 };
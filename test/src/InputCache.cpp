@@ -0,0 +1,284 @@
+#include "InputCache.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// <hash>.f32 layout: header, zero padded to DATA_OFFSET, then num_channels x channel_stride floats
+struct InputCacheHeader
+{
+    char magic[4];              // "TVIC"
+    uint32_t version;
+    uint64_t source_hash;       // content_hash of the wav it was decoded from
+    uint32_t sample_rate;
+    uint32_t num_channels;
+    uint64_t num_frames;
+    uint64_t channel_stride;    // floats, AudioBuffer::padded_stride(num_frames)
+    uint64_t data_offset;
+};
+
+// <path hash>.src: what content_hash gave for a source file while it had this size and time
+struct InputCacheStamp
+{
+    char magic[4];              // "TVIS"
+    uint32_t version;
+    uint64_t size;
+    int64_t write_time;         // file_time_type ticks
+    uint64_t content_hash;
+};
+
+constexpr uint32_t INPUT_CACHE_VERSION = 1;
+constexpr size_t DATA_OFFSET = 4096;    // a page, so mapped channels keep AudioBuffer's alignment
+
+} // namespace
+
+InputCache::~InputCache()
+{
+    close();
+}
+
+uint64_t InputCache::content_hash(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        return 0;
+    }
+
+    uint64_t hash = 0xcbf29ce484222325ull;
+    std::vector<char> chunk(1 << 16);
+    while (file)
+    {
+        file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        const std::streamsize got = file.gcount();
+        for (std::streamsize i = 0; i < got; i++)
+        {
+            hash ^= static_cast<unsigned char>(chunk[i]);
+            hash *= 0x100000001b3ull;
+        }
+    }
+    return hash;
+}
+
+uint64_t InputCache::source_hash(const std::string& dir, const std::string& path)
+{
+#ifdef _WIN32
+    (void)dir;
+    (void)path;
+    return 0;       // open never hits here, don't read the file for nothing
+#else
+    std::error_code error;
+    const uint64_t size = std::filesystem::file_size(path, error);
+    if (error)
+    {
+        return 0;
+    }
+    const int64_t write_time = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+    if (error)
+    {
+        return 0;
+    }
+
+    const std::string stamp = stamp_path(dir, path);
+    InputCacheStamp recorded{};
+    {
+        std::ifstream file(stamp, std::ios::binary);
+        file.read(reinterpret_cast<char*>(&recorded), sizeof(recorded));
+        if (file.gcount() == sizeof(recorded) && std::memcmp(recorded.magic, "TVIS", 4) == 0
+            && recorded.version == INPUT_CACHE_VERSION && recorded.size == size && recorded.write_time == write_time
+            && recorded.content_hash != 0)
+        {
+            return recorded.content_hash;
+        }
+    }
+
+    // New or changed since the stamp, hash the bytes and stamp them for the next run
+    const uint64_t hash = content_hash(path);
+    if (hash != 0)
+    {
+        std::filesystem::create_directories(dir, error);
+        const std::string partial = stamp + "." + std::to_string(getpid()) + ".partial";
+        const InputCacheStamp current = { { 'T', 'V', 'I', 'S' }, INPUT_CACHE_VERSION, size, write_time, hash };
+        bool written = false;
+        {
+            std::ofstream file(partial, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&current), sizeof(current));
+            written = static_cast<bool>(file);
+        }
+        if (written)
+        {
+            std::filesystem::rename(partial, stamp, error);
+        }
+        if (!written || error)
+        {
+            std::filesystem::remove(partial, error);
+        }
+    }
+    return hash;
+#endif
+}
+
+std::string InputCache::stamp_path(const std::string& dir, const std::string& source)
+{
+    std::error_code error;
+    std::string key = std::filesystem::absolute(source, error).lexically_normal().string();
+    if (error)
+    {
+        key = source;
+    }
+
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : key)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ull;
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.src", static_cast<unsigned long long>(hash));
+    return (std::filesystem::path(dir) / name).string();
+}
+
+std::string InputCache::entry_path(const std::string& dir, uint64_t hash)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.f32", static_cast<unsigned long long>(hash));
+    return (std::filesystem::path(dir) / name).string();
+}
+
+bool InputCache::open(const std::string& dir, uint64_t hash)
+{
+    close();
+#ifdef _WIN32
+    (void)dir;
+    (void)hash;
+    return false;
+#else
+    const std::string path = entry_path(dir, hash);
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info{};
+    InputCacheHeader header{};
+    bool ok = fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= DATA_OFFSET
+              && pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+
+    ok = ok && std::memcmp(header.magic, "TVIC", 4) == 0 && header.version == INPUT_CACHE_VERSION
+         && header.source_hash == hash && header.data_offset == DATA_OFFSET && header.num_channels > 0
+         && header.num_channels <= UINT16_MAX && header.channel_stride == AudioBuffer::padded_stride(header.num_frames)
+         && static_cast<uint64_t>(info.st_size) >= DATA_OFFSET + header.num_channels * header.channel_stride * sizeof(float);
+
+    if (ok)
+    {
+        // Private and writable: the effect only reads its input, but a stray write must never reach the file
+        mapping_size = static_cast<size_t>(info.st_size);
+        mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            mapping = nullptr;
+            ok = false;
+        }
+    }
+    ::close(fd);
+    if (!ok)
+    {
+        return false;
+    }
+
+    float* data = reinterpret_cast<float*>(static_cast<char*>(mapping) + DATA_OFFSET);
+    pointers.resize(header.num_channels);
+    for (size_t ch = 0; ch < pointers.size(); ch++)
+    {
+        pointers[ch] = data + ch * header.channel_stride;
+    }
+    frames = header.num_frames;
+    rate = header.sample_rate;
+    return true;
+#endif
+}
+
+bool InputCache::store(const std::string& dir, uint64_t hash, uint32_t sample_rate, const AudioBlockView& channels)
+{
+#ifdef _WIN32
+    (void)dir;
+    (void)hash;
+    (void)sample_rate;
+    (void)channels;
+    return false;
+#else
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+
+    const std::string path = entry_path(dir, hash);
+    const std::string partial = path + "." + std::to_string(getpid()) + ".partial";
+    {
+        std::ofstream file(partial, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::cerr << "Could not write input cache: " << partial << std::endl;
+            return false;
+        }
+
+        const size_t stride = AudioBuffer::padded_stride(channels.num_frames());
+        InputCacheHeader header = { { 'T', 'V', 'I', 'C' }, INPUT_CACHE_VERSION, hash, sample_rate, channels.num_channels(),
+                                    channels.num_frames(), stride, DATA_OFFSET };
+        std::vector<char> page(DATA_OFFSET, 0);
+        std::memcpy(page.data(), &header, sizeof(header));
+        file.write(page.data(), static_cast<std::streamsize>(page.size()));
+
+        const std::vector<float> padding(stride - channels.num_frames(), 0.0f);
+        for (uint16_t ch = 0; ch < channels.num_channels(); ch++)
+        {
+            file.write(reinterpret_cast<const char*>(channels.channel(ch)), static_cast<std::streamsize>(channels.num_frames() * sizeof(float)));
+            file.write(reinterpret_cast<const char*>(padding.data()), static_cast<std::streamsize>(padding.size() * sizeof(float)));
+        }
+        if (!file)
+        {
+            std::cerr << "Could not write input cache: " << partial << std::endl;
+            file.close();
+            std::filesystem::remove(partial, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(partial, path, error);
+    if (error)
+    {
+        std::filesystem::remove(partial, error);
+        return false;
+    }
+    return true;
+#endif
+}
+
+AudioBlockView InputCache::view() const
+{
+    return AudioBlockView(pointers.data(), static_cast<uint16_t>(pointers.size()), frames, 0, mapping != nullptr);
+}
+
+void InputCache::close()
+{
+#ifndef _WIN32
+    if (mapping != nullptr)
+    {
+        munmap(mapping, mapping_size);
+    }
+#endif
+    mapping = nullptr;
+    mapping_size = 0;
+    pointers.clear();
+    frames = 0;
+    rate = 0;
+}
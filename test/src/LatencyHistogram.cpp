@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include "LatencyHistogram.h"
+
+// Below SUB_COUNT the bucket is the value. Above it, shift keeps the top SUB_BITS + 1 bits, which land in
+// [SUB_COUNT, 2 * SUB_COUNT), and each extra shift moves up one row of SUB_COUNT buckets.
+size_t LatencyHistogram::bucket_of(uint64_t value)
+{
+    if (value < SUB_COUNT)
+    {
+        return static_cast<size_t>(value);
+    }
+    const unsigned shift = static_cast<unsigned>(std::bit_width(value)) - 1 - SUB_BITS;
+    return static_cast<size_t>(shift * SUB_COUNT + (value >> shift));
+}
+
+uint64_t LatencyHistogram::bucket_top(size_t bucket)
+{
+    if (bucket < 2 * SUB_COUNT)
+    {
+        return bucket;
+    }
+    const unsigned shift = static_cast<unsigned>(bucket / SUB_COUNT) - 1;
+    const uint64_t mantissa = bucket - shift * SUB_COUNT;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value)
+{
+    counts[bucket_of(value)]++;
+    total++;
+    sum += value;
+    lowest = std::min(lowest, value);
+    highest = std::max(highest, value);
+}
+
+void LatencyHistogram::reset()
+{
+    counts.fill(0);
+    total = 0;
+    sum = 0;
+    lowest = UINT64_MAX;
+    highest = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const
+{
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percent / 100.0 * static_cast<double>(total))));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; bucket++)
+    {
+        seen += counts[bucket];
+        if (seen >= target)
+        {
+            return std::min(bucket_top(bucket), highest);
+        }
+    }
+    return highest;
+}
@@ -0,0 +1,450 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AudioBuffer.h"
+#include "LatencyHistogram.h"
+#include "TOVAL_Effect.h"
+#include "TOVALaudio.h"
+#include "TOVALparams.h"
+
+/*
+    Tail latency stress test.
+
+    Drives TOVAL_Effect_process with random block sizes from 1 to TOVAL_MAX_BLOCK_SIZE (odd sizes, sizes
+    around powers of two and tiny blocks to hit remainder paths, at random unaligned offsets) while a
+    second thread sets and gets random parameters from TOVAL_PARAM_TABLE as fast as it can and pulls
+    analyzer spectra. Every process call is timed into an HDR style histogram. Global operator new is
+    replaced so allocations can be counted, both overall and inside process calls.
+
+        TOVAL_Effect_stress [seconds] [seed] [internal_sample_rate]
+
+    Then races TOVAL_Effect_set_batch against TOVAL_Effect_set on a fresh instance and checks that no
+    block ever runs with half a batch applied.
+
+    Exits non zero when a process call fails or allocates, a set gets a different verdict than its table
+    row gives, or a block sees part of a batch.
+*/
+
+namespace {
+
+std::atomic<uint64_t> allocations{0};
+std::atomic<uint64_t> process_allocations{0};
+thread_local bool in_process = false;
+
+void count_allocation()
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (in_process)
+    {
+        process_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace
+
+// The replacements below pair malloc / aligned_alloc with free on purpose, GCC cannot see that once inlined
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size)
+{
+    count_allocation();
+    if (void* p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t align)
+{
+    count_allocation();
+    const std::size_t alignment = static_cast<std::size_t>(align);
+    if (void* p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return ::operator new(size); }
+void* operator new[](std::size_t size, std::align_val_t align) { return ::operator new(size, align); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace {
+
+constexpr size_t MAX_OFFSET = 16;      // frames, shifts blocks off the 64 byte boundary
+
+struct Storm_stats
+{
+    uint64_t sets = 0;
+    uint64_t rejected = 0;      // off the row's power of two grid (e.g. FFT_SIZE 300), refused at the call
+    uint64_t misjudged = 0;     // accepted when the row says no or the other way round
+    uint64_t gets = 0;
+    uint64_t failed_gets = 0;
+    uint64_t analyzes = 0;
+};
+
+// Mostly uniform, with a share of tiny blocks and sizes next to powers of two where vector loops split
+size_t random_block_size(std::mt19937_64& rng)
+{
+    std::uniform_int_distribution<size_t> any(1, TOVAL_MAX_BLOCK_SIZE);
+    std::uniform_int_distribution<size_t> tiny(1, 64);
+    std::uniform_int_distribution<int> power(0, 13);
+    std::uniform_int_distribution<int> nudge(-1, 1);
+
+    switch (rng() % 4)
+    {
+        case 0:
+            return tiny(rng);
+        case 1:
+        {
+            const size_t size = (size_t{1} << power(rng)) + nudge(rng);
+            return std::clamp<size_t>(size, 1, TOVAL_MAX_BLOCK_SIZE);
+        }
+        default:
+            return any(rng);
+    }
+}
+
+/*
+    Any row, random values across its range. GLOBAL_ENABLE is left on so the chain keeps running.
+
+    The range is the table's, so the only values a set can refuse are the POW2 rows' non powers of two.
+    Module setters run later on the audio thread and never report back to the caller, so every other set
+    must come back NO_ERROR.
+*/
+void parameter_storm(TOVAL_Effect& effect, const std::atomic<bool>& stop, uint64_t seed, Storm_stats& stats)
+{
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<uint8_t> blob(65536);
+
+    while (!stop.load(std::memory_order_relaxed))
+    {
+        const TOVAL_ParamDescriptor& desc = TOVAL_PARAM_TABLE[rng() % TOVAL_PARAM_COUNT];
+        const bool settable = desc.access == TOVAL_ParamAccess::READ_WRITE
+                              && !(desc.moduleID == GLOBAL && desc.paramID == GLOBAL_ENABLE);
+
+        if (settable && (rng() & 1))
+        {
+            TOVAL_ParamSet value{};
+            const float x = desc.min + unit(rng) * (desc.max - desc.min);
+            if (desc.type == TOVAL_ParamType::F32)
+            {
+                value.value.f32 = x;
+            }
+            else
+            {
+                value.value.u32 = static_cast<uint32_t>(std::lround(x));
+            }
+            const bool off_grid = (desc.flags & TOVAL_PARAM_POW2) && !std::has_single_bit(value.value.u32);
+            const bool refused = effect.TOVAL_Effect_set(desc.moduleID, desc.paramID, sizeof(value.value), &value.value) != TOVAL_ERROR::NO_ERROR;
+            stats.sets++;
+            stats.rejected += refused;
+            stats.misjudged += (refused != off_grid);
+        }
+        else
+        {
+            stats.gets++;
+            if (effect.TOVAL_Effect_get(desc.moduleID, desc.paramID, desc.size, blob.data()) != TOVAL_ERROR::NO_ERROR)
+            {
+                stats.failed_gets++;
+            }
+        }
+
+        if ((stats.sets + stats.gets) % 256 == 0)
+        {
+            effect.TOVAL_Effect_analyze();
+            stats.analyzes++;
+        }
+    }
+}
+
+/*
+    TOVAL_Effect_set_batch against TOVAL_Effect_set. Each batch flips GLOBAL_ENABLE and HR_ENABLE in
+    opposite directions with a run of delay rows in between, so a whole batch always leaves the chain a
+    plain copy (global bypass, or every module off) while half of one turns the headroom on at -20 dB.
+    A second thread sets single rows as fast as it can, so the audio thread keeps seeing new generations
+    while a batch is going in. Returns the blocks whose output was not their input. enabled counts the
+    blocks the chain ran (the headroom meters them), so a run where no batch ever landed shows up too.
+*/
+uint64_t batch_race(const TOVAL_Config& config, double seconds, uint64_t seed, uint64_t& blocks, uint64_t& enabled)
+{
+    TOVAL_Effect effect;
+    TOVAL_ERROR ret = effect.set_config(sizeof(config), &config);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        ret = effect.TOVAL_Effect_init();
+    }
+    const TOVAL_ParamSet start[] = {
+        { GLOBAL, GLOBAL_ENABLE, { .u32 = 0 } },
+        { HEADROOM, HR_ENABLE, { .u32 = 1 } },
+        { HEADROOM, HR_GAIN, { .f32 = -20.0f } },
+    };
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        ret = effect.TOVAL_Effect_set_batch(start, std::size(start));
+    }
+    if (ret != TOVAL_ERROR::NO_ERROR)
+    {
+        return 1;
+    }
+
+    std::atomic<bool> stop{false};
+    auto batches = [&]()
+    {
+        std::mt19937_64 rng(seed);
+        std::array<TOVAL_ParamSet, 34> batch;
+        uint32_t global = 1;
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            batch.front() = { GLOBAL, GLOBAL_ENABLE, { .u32 = global } };
+            for (size_t i = 1; i + 1 < batch.size(); i++)
+            {
+                batch[i] = { DELAY, DL_TIME, { .f32 = static_cast<float>(rng() % 2000) } };
+            }
+            batch.back() = { HEADROOM, HR_ENABLE, { .u32 = 1 - global } };
+            effect.TOVAL_Effect_set_batch(batch.data(), batch.size());
+            global = 1 - global;
+        }
+    };
+    auto singles = [&]()
+    {
+        std::mt19937_64 rng(seed + 1);
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            float mix = static_cast<float>(rng() % 100) / 100.0f;
+            effect.TOVAL_Effect_set(DELAY, DL_MIX, sizeof(mix), &mix);
+        }
+    };
+    std::thread batch_thread(batches);
+    std::thread single_thread(singles);
+
+    constexpr size_t BLOCK = 64;
+    AudioBuffer input;
+    AudioBuffer output;
+    input.audiobuffer_init(config.In_num_channels, BLOCK);
+    output.audiobuffer_init(config.Out_num_channels, BLOCK);
+    for (uint16_t ch = 0; ch < input.num_channels(); ch++)
+    {
+        for (size_t i = 0; i < BLOCK; i++)
+        {
+            input[ch][i] = 0.25f;
+        }
+    }
+
+    uint64_t torn = 0;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        effect.TOVAL_Effect_process(input.view(), output.view());
+        bool copy = true;
+        for (uint16_t ch = 0; ch < output.num_channels(); ch++)
+        {
+            copy = copy && std::equal(input[ch], input[ch] + BLOCK, output[ch]);
+        }
+        torn += !copy;
+        blocks++;
+    }
+
+    stop.store(true);
+    batch_thread.join();
+    single_thread.join();
+
+    TOVAL_Meter meter{};
+    effect.TOVAL_Effect_get(HEADROOM, HR_METER, sizeof(meter), &meter);
+    enabled = meter.sequence;
+    return torn;
+}
+
+void print_latency(const char* label, const LatencyHistogram& histogram)
+{
+    std::printf("%-22s p50 %9.2f  p99 %9.2f  p99.9 %9.2f  max %9.2f  mean %9.2f  (us, %llu calls)\n", label,
+                histogram.percentile(50.0) / 1000.0, histogram.percentile(99.0) / 1000.0,
+                histogram.percentile(99.9) / 1000.0, histogram.max() / 1000.0, histogram.mean() / 1000.0,
+                static_cast<unsigned long long>(histogram.count()));
+}
+
+// True when the whole of text is a number, value is left alone otherwise
+template <typename T>
+bool parse_arg(const char* text, T& value)
+{
+    const char* end = text + std::char_traits<char>::length(text);
+    T parsed{};
+    const auto [ptr, ec] = std::from_chars(text, end, parsed);
+    if (ec != std::errc() || ptr != end || ptr == text)
+    {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    double seconds = 10.0;
+    uint64_t seed = 1;
+    float internal_sample_rate = 0.0f;
+    const float sample_rate = 48000.0f;
+
+    if (argc > 4
+        || (argc > 1 && (!parse_arg(argv[1], seconds) || !std::isfinite(seconds) || seconds <= 0.0))
+        || (argc > 2 && !parse_arg(argv[2], seed))
+        || (argc > 3 && (!parse_arg(argv[3], internal_sample_rate) || !std::isfinite(internal_sample_rate) || internal_sample_rate < 0.0f)))
+    {
+        std::cerr << "Usage: " << argv[0] << " [seconds > 0] [seed] [internal_sample_rate, 0 for the host rate]" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Stress test: " << seconds << " s, seed " << seed << ", " << sample_rate << " Hz host, internal "
+              << (internal_sample_rate > 0.0f ? std::to_string(internal_sample_rate) + " Hz" : std::string("host rate")) << std::endl;
+    if (std::thread::hardware_concurrency() < 2)
+    {
+        std::cout << "Warning: one core, the storm thread preempts process calls and scheduler slices show up in the tail" << std::endl;
+    }
+
+    TOVAL_Effect effect;
+    TOVAL_Config config = { sample_rate, 2, 2, internal_sample_rate, SRC_QUALITY_MEDIUM };
+    TOVAL_ERROR ret = effect.set_config(sizeof(config), &config);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        ret = effect.TOVAL_Effect_init();
+    }
+    if (ret != TOVAL_ERROR::NO_ERROR)
+    {
+        std::cerr << "Error initialising the effect (code " << static_cast<int>(ret) << ")" << std::endl;
+        return 1;
+    }
+
+    // Start from everything on, the storm toggles it from there
+    const TOVAL_ParamSet enables[] = {
+        { GLOBAL, GLOBAL_ENABLE, { .u32 = 1 } },
+        { HEADROOM, HR_ENABLE, { .u32 = 1 } },
+        { COMPRESSOR, CP_ENABLE, { .u32 = 1 } },
+        { CROSSOVER, XO_ENABLE, { .u32 = 1 } },
+        { DELAY, DL_ENABLE, { .u32 = 1 } },
+        { REVERB, RV_ENABLE, { .u32 = 1 } },
+        { FIR, FR_ENABLE, { .u32 = 1 } },
+        { ANALYZER, AN_ENABLE, { .u32 = 1 } },
+    };
+    effect.TOVAL_Effect_set_batch(enables, std::size(enables));
+
+    AudioBuffer input;
+    AudioBuffer output;
+    input.audiobuffer_init(config.In_num_channels, TOVAL_MAX_BLOCK_SIZE + MAX_OFFSET);
+    output.audiobuffer_init(config.Out_num_channels, TOVAL_MAX_BLOCK_SIZE + MAX_OFFSET);
+
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    for (uint16_t ch = 0; ch < input.num_channels(); ch++)
+    {
+        for (size_t i = 0; i < input.num_frames(); i++)
+        {
+            input[ch][i] = noise(rng);
+        }
+    }
+
+    // Warm up caches and first touch before anything is timed or counted
+    for (int i = 0; i < 64; i++)
+    {
+        effect.TOVAL_Effect_process(input.view().first(TOVAL_MAX_BLOCK_SIZE), output.view().first(TOVAL_MAX_BLOCK_SIZE));
+    }
+
+    LatencyHistogram latency;
+    std::array<LatencyHistogram, 3> latency_by_size;   // <= 64, <= 1024, larger
+    double worst_load = 0.0;    // call time over the real time the block represents
+    size_t worst_load_frames = 0;
+    uint64_t frames = 0;
+    uint64_t errors = 0;
+
+    const uint64_t allocations_before = allocations.load();
+    std::atomic<bool> stop{false};
+    Storm_stats storm;
+    std::thread storm_thread(parameter_storm, std::ref(effect), std::cref(stop), seed + 1, std::ref(storm));
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    std::uniform_int_distribution<size_t> offset(0, MAX_OFFSET);
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        const size_t n = random_block_size(rng);
+        const size_t start = offset(rng);
+        const AudioBlockView in = input.view().slice(start, n);
+        const AudioBlockView out = output.view().slice(start, n);
+
+        const auto t0 = std::chrono::steady_clock::now();
+        in_process = true;
+        const TOVAL_ERROR status = effect.TOVAL_Effect_process(in, out);
+        in_process = false;
+        const auto t1 = std::chrono::steady_clock::now();
+
+        const uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+        latency.record(ns);
+        latency_by_size[n <= 64 ? 0 : (n <= 1024 ? 1 : 2)].record(ns);
+
+        const double load = static_cast<double>(ns) * 1.0e-9 * sample_rate / static_cast<double>(n);
+        if (load > worst_load)
+        {
+            worst_load = load;
+            worst_load_frames = n;
+        }
+        frames += n;
+        errors += (status != TOVAL_ERROR::NO_ERROR);
+    }
+
+    stop.store(true);
+    storm_thread.join();
+    const uint64_t allocations_total = allocations.load() - allocations_before;
+
+    std::printf("\n");
+    print_latency("process, all sizes", latency);
+    print_latency("process, 1..64", latency_by_size[0]);
+    print_latency("process, 65..1024", latency_by_size[1]);
+    print_latency("process, 1025..8192", latency_by_size[2]);
+    std::printf("%-22s %.1f %% of real time, on a %zu frame block\n", "worst block load", worst_load * 100.0, worst_load_frames);
+    std::printf("%-22s %llu frames, %.1fx real time overall\n", "processed",
+                static_cast<unsigned long long>(frames), frames / static_cast<double>(sample_rate) / seconds);
+    std::printf("%-22s %llu sets (%llu rejected, %llu misjudged), %llu gets (%llu failed), %llu analyzes\n", "parameter storm",
+                static_cast<unsigned long long>(storm.sets), static_cast<unsigned long long>(storm.rejected),
+                static_cast<unsigned long long>(storm.misjudged),
+                static_cast<unsigned long long>(storm.gets), static_cast<unsigned long long>(storm.failed_gets),
+                static_cast<unsigned long long>(storm.analyzes));
+    std::printf("%-22s %llu inside process, %llu overall while running\n", "allocations",
+                static_cast<unsigned long long>(process_allocations.load()), static_cast<unsigned long long>(allocations_total));
+    std::printf("%-22s %llu\n", "process errors", static_cast<unsigned long long>(errors));
+
+    // At the host rate, so a block that runs with everything bypassed is a bit exact copy of its input
+    TOVAL_Config race_config = config;
+    race_config.internal_sample_rate = 0.0f;
+    uint64_t race_blocks = 0;
+    uint64_t race_enabled = 0;
+    const uint64_t torn = batch_race(race_config, std::min(seconds, 2.0), seed, race_blocks, race_enabled);
+    std::printf("%-22s %llu of %llu blocks saw part of a batch, %llu ran enabled\n", "set_batch against set",
+                static_cast<unsigned long long>(torn), static_cast<unsigned long long>(race_blocks),
+                static_cast<unsigned long long>(race_enabled));
+
+    return (errors == 0 && process_allocations.load() == 0 && storm.misjudged == 0 && torn == 0 && race_enabled > 0) ? 0 : 1;
+}
@@ -0,0 +1,221 @@
+#include "Timeline.h"
+#include "JsonParams.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+// timeline.bin layout: header then num_events raw TOVAL_ParamEvent
+struct TimelineFileHeader
+{
+    char magic[4];          // "TVTL"
+    uint32_t version;
+    uint64_t source_hash;   // FNV-1a of the params.json text it was compiled from
+    uint32_t num_events;
+    uint32_t event_size;    // sizeof(TOVAL_ParamEvent), guards against a stale layout
+};
+
+constexpr uint32_t TIMELINE_VERSION = 2;     // 2: params inside a point in written order
+
+uint64_t fnv1a(const std::string& text)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : text)
+    {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+TOVAL_ERROR Timeline::load(const nlohmann::json& jsonObj, const std::string& jsonText, float sample_rate, const std::string& cachePath)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    events.clear();
+    cursor = 0;
+
+    if (!jsonObj.contains("TIMELINE"))
+    {
+        return ret;
+    }
+
+    const uint64_t hash = fnv1a(jsonText) ^ static_cast<uint64_t>(std::lround(sample_rate));   // "ms" points depend on the rate
+
+    if (!cachePath.empty() && read_cache(cachePath, hash))
+    {
+        std::cout << "Timeline loaded from " << cachePath << " (" << events.size() << " events)" << std::endl;
+    }
+    else
+    {
+        // Parsed again keeping key order, nlohmann::json sorts keys and a point's params apply in turn
+        ret = compile(nlohmann::ordered_json::parse(jsonText)["TIMELINE"], sample_rate);
+        if (ret == TOVAL_ERROR::NO_ERROR)
+        {
+            std::cout << "Timeline compiled (" << events.size() << " events)" << std::endl;
+            if (!cachePath.empty())
+            {
+                write_cache(cachePath, hash);
+            }
+        }
+    }
+
+    // A block can hold at most every event, so replay never grows this
+    scratch.resize(events.size());
+    return ret;
+}
+
+TOVAL_ERROR Timeline::compile(const nlohmann::ordered_json& timeline, float sample_rate)
+{
+    if (!timeline.is_array())
+    {
+        std::cerr << "TIMELINE must be an array of points" << std::endl;
+        return TOVAL_ERROR::PARAMETER_ERROR;
+    }
+
+    for (const nlohmann::ordered_json& point : timeline)
+    {
+        uint64_t position = 0;
+        if (point.contains("sample"))
+        {
+            position = point["sample"].get<uint64_t>();
+        }
+        else if (point.contains("ms"))
+        {
+            position = static_cast<uint64_t>(std::llround(point["ms"].get<double>() * sample_rate / 1000.0));
+        }
+        else
+        {
+            std::cerr << "TIMELINE point without \"sample\" or \"ms\": " << point.dump() << std::endl;
+            return TOVAL_ERROR::PARAMETER_ERROR;
+        }
+
+        if (position > UINT32_MAX)
+        {
+            std::cerr << "TIMELINE point beyond 2^32 samples: " << point.dump() << std::endl;
+            return TOVAL_ERROR::PARAMETER_ERROR;
+        }
+
+        for (auto& [moduleName, params] : point.items())
+        {
+            if (moduleName == "sample" || moduleName == "ms")
+            {
+                continue;
+            }
+
+            for (auto& [paramName, paramData] : params.items())
+            {
+                const TOVAL_ParamDescriptor* desc = find_param_descriptor(moduleName, paramName);
+                if (desc == nullptr || !paramData.is_number())
+                {
+                    std::cerr << "Unknown timeline param: " << moduleName << "." << paramName << std::endl;
+                    return TOVAL_ERROR::PARAMID_ERROR;
+                }
+
+                TOVAL_ParamEvent event{};
+                event.sample_offset = static_cast<uint32_t>(position);
+                event.moduleID = desc->moduleID;
+                event.paramID = desc->paramID;
+                if (desc->type == TOVAL_ParamType::F32)
+                {
+                    event.value.f32 = paramData.get<float>();
+                }
+                else
+                {
+                    event.value.u32 = paramData.get<uint32_t>();
+                }
+                events.push_back(event);
+            }
+        }
+    }
+
+    // Points may be written in any order. Equal positions keep the order they are written in, points
+    // first and then params within a point, so RAMP_TIME ahead of GAIN ramps the gain over the new time.
+    std::stable_sort(events.begin(), events.end(), [](const TOVAL_ParamEvent& a, const TOVAL_ParamEvent& b) {
+        return a.sample_offset < b.sample_offset;
+    });
+
+    return TOVAL_ERROR::NO_ERROR;
+}
+
+bool Timeline::read_cache(const std::string& path, uint64_t hash)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    TimelineFileHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || std::string(header.magic, 4) != "TVTL" || header.version != TIMELINE_VERSION
+        || header.source_hash != hash || header.event_size != sizeof(TOVAL_ParamEvent))
+    {
+        return false;
+    }
+
+    events.resize(header.num_events);
+    file.read(reinterpret_cast<char*>(events.data()), static_cast<std::streamsize>(events.size() * sizeof(TOVAL_ParamEvent)));
+    if (!file)
+    {
+        events.clear();
+        return false;
+    }
+    return true;
+}
+
+void Timeline::write_cache(const std::string& path, uint64_t hash) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Could not write timeline cache: " << path << std::endl;
+        return;
+    }
+
+    TimelineFileHeader header = { { 'T', 'V', 'T', 'L' }, TIMELINE_VERSION, hash, static_cast<uint32_t>(events.size()), sizeof(TOVAL_ParamEvent) };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(events.data()), static_cast<std::streamsize>(events.size() * sizeof(TOVAL_ParamEvent)));
+}
+
+void Timeline::rewind(uint64_t position)
+{
+    cursor = 0;
+    while (cursor < events.size() && events[cursor].sample_offset < position)
+    {
+        cursor++;
+    }
+}
+
+void Timeline::state_at(uint64_t position, std::vector<TOVAL_ParamSet>& state) const
+{
+    state.clear();
+    for (size_t e = 0; e < events.size() && events[e].sample_offset < position; e++)
+    {
+        const TOVAL_ParamEvent& event = events[e];
+        auto same = [&event](const TOVAL_ParamSet& s) { return s.moduleID == event.moduleID && s.paramID == event.paramID; };
+        auto it = std::find_if(state.begin(), state.end(), same);
+        if (it == state.end())
+        {
+            it = state.insert(state.end(), TOVAL_ParamSet{ event.moduleID, event.paramID, {} });
+        }
+        it->value.u32 = event.value.u32;
+    }
+}
+
+const TOVAL_ParamEvent* Timeline::next_block(uint64_t position, size_t nspc, size_t& num_events)
+{
+    num_events = 0;
+    const uint64_t end = position + nspc;
+    while (cursor < events.size() && events[cursor].sample_offset < end)
+    {
+        TOVAL_ParamEvent event = events[cursor++];
+        event.sample_offset = (event.sample_offset > position) ? static_cast<uint32_t>(event.sample_offset - position) : 0;   // late events land at the block start
+        scratch[num_events++] = event;
+    }
+    return scratch.data();
+}
@@ -1,8 +1,12 @@
 #include "Tonal_Valley_test.h"
 #include "JsonParams.h"               // Include the header for JSON parameter functions
+#include "TOVALtrace.h"
 #include <nlohmann/json.hpp>
+#include <cstdlib>
 #include <fstream>
 #include <filesystem>
+#include <numeric>
+#include <thread>
 
 // Constructor
 Tonal_Valley_test::Tonal_Valley_test() {}
@@ -10,10 +14,42 @@ Tonal_Valley_test::Tonal_Valley_test() {}
 // Destructor
 Tonal_Valley_test::~Tonal_Valley_test() {}
 
-// Load WAV File and Store Header
+// Header for the input, whether decoded or mapped from the cache
+void Tonal_Valley_test::setInputHeader(uint32_t sampleRate, uint16_t numChannels, size_t frames)
+{
+    memcpy(inputWavHeader.RIFF, "RIFF", 4);
+    memcpy(inputWavHeader.WAVE, "WAVE", 4);
+    memcpy(inputWavHeader.fmt, "fmt ", 4);
+    memcpy(inputWavHeader.SubChunk2ID, "data", 4);
+
+    inputWavHeader.ChunkSize = frames * numChannels * sizeof(float) + 36;
+    inputWavHeader.SubChunk1Size = 16;  // PCM
+    inputWavHeader.AudioFormat = 1;  // PCM format
+    inputWavHeader.NumChannels = numChannels;
+    inputWavHeader.SampleRate = sampleRate;
+    inputWavHeader.BitsPerSample = 16;  // Assuming 16-bit WAV
+    inputWavHeader.ByteRate = sampleRate * numChannels * inputWavHeader.BitsPerSample / 8;
+    inputWavHeader.BlockAlign = numChannels * inputWavHeader.BitsPerSample / 8;
+    inputWavHeader.SubChunk2Size = frames * numChannels * sizeof(float);
+
+    numFrames = static_cast<int>(frames);
+}
+
+// Load WAV File and Store Header. The planar decode comes from inputCacheDir when an earlier run left one
+// for the same file contents, otherwise it is decoded here and left there for the next run.
 TOVAL_ERROR Tonal_Valley_test::loadWav(const std::string &filename)
 {
     TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    const uint64_t hash = inputCacheDir.empty() ? 0 : InputCache::source_hash(inputCacheDir, filename);
+    if (hash != 0 && inputCache.open(inputCacheDir, hash))
+    {
+        inputView = inputCache.view();
+        setInputHeader(inputCache.sample_rate(), inputView.num_channels(), inputView.num_frames());
+        std::cout << "Input " << filename << " mapped from " << inputCacheDir << "\n" << std::endl;
+        return ret;
+    }
+
     SF_INFO sfinfo;
     std::cout << "Loading " << filename.c_str() << "...\n" << std::endl;
     SNDFILE *infile = sf_open(filename.c_str(), SFM_READ, &sfinfo);
@@ -27,22 +63,7 @@ TOVAL_ERROR Tonal_Valley_test::loadWav(const std::string &filename)
     if(ret == TOVAL_ERROR::NO_ERROR)
     {
         // Store header information for the input WAV file
-        memcpy(inputWavHeader.RIFF, "RIFF", 4);
-        memcpy(inputWavHeader.WAVE, "WAVE", 4);
-        memcpy(inputWavHeader.fmt, "fmt ", 4);
-        memcpy(inputWavHeader.SubChunk2ID, "data", 4);
-        
-        inputWavHeader.ChunkSize = sfinfo.frames * sfinfo.channels * sizeof(float) + 36;
-        inputWavHeader.SubChunk1Size = 16;  // PCM
-        inputWavHeader.AudioFormat = 1;  // PCM format
-        inputWavHeader.NumChannels = sfinfo.channels;
-        inputWavHeader.SampleRate = sfinfo.samplerate;
-        inputWavHeader.BitsPerSample = 16;  // Assuming 16-bit WAV
-        inputWavHeader.ByteRate = sfinfo.samplerate * sfinfo.channels * inputWavHeader.BitsPerSample / 8;
-        inputWavHeader.BlockAlign = sfinfo.channels * inputWavHeader.BitsPerSample / 8;
-        inputWavHeader.SubChunk2Size = sfinfo.frames * sfinfo.channels * sizeof(float);
-
-        numFrames = sfinfo.frames;
+        setInputHeader(sfinfo.samplerate, sfinfo.channels, sfinfo.frames);
         int numChannels = sfinfo.channels;
 
         std::cout << "Allocating buffer for input data: " << numFrames * numChannels << " floats" << std::endl;
@@ -53,9 +74,20 @@ TOVAL_ERROR Tonal_Valley_test::loadWav(const std::string &filename)
         std::cout << "Finished reading WAV file data." << std::endl;
         sf_close(infile);
 
-        //std::cout << "Allocating buffer for output data: " << numFrames << " frames" << std::endl;
-        //outputBuffer.resize(numFrames); // Allocate space for processed data
-        // need to accomodate for additional channels after processing
+        // Deinterleave input into aligned planar storage, the interleaved copy isn't needed after this
+        ret = deinterleave(inputBuffer, input, numChannels);
+        std::vector<float>().swap(inputBuffer);
+        if (ret != TOVAL_ERROR::NO_ERROR)
+        {
+            std::cout<< "Error in deinterleaving Input: Error code == " << static_cast<int>(ret) << std::endl;
+            return ret;
+        }
+        inputView = input.view();
+
+        if (hash != 0 && InputCache::store(inputCacheDir, hash, sfinfo.samplerate, inputView))
+        {
+            std::cout << "Decoded input cached in " << inputCacheDir << std::endl;
+        }
     }
 
     return ret;
@@ -84,11 +116,29 @@ TOVAL_ERROR Tonal_Valley_test::saveWav(const std::string &filename)
 {
     TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
 
-    Out_num_channels = ppOut.size();
+    Out_num_channels = output.num_channels();
 
     std::cout << "Allocating buffer for output data: " << numFrames * Out_num_channels << " frames" << std::endl;
     outputBuffer.resize(numFrames * Out_num_channels); // Allocate space for processed data
 
+    // Interleave and requantise to 16 bit with the library converter, dithered per OUTPUT_DITHER
+    TOVAL_Arena pcmArena;
+    pcmArena.arena_init_heap();
+    PcmConverter converter;
+    ret = converter.pcm_init(Out_num_channels, pcmArena);
+    if (ret != TOVAL_ERROR::NO_ERROR)
+    {
+        return ret;
+    }
+    converter.set_dither(outputDither);
+
+    void* const pcmOut[] = { outputBuffer.data() };
+    ret = converter.from_float(output.view().first(numFrames), PCM_INT16, PCM_INTERLEAVED, pcmOut, 0);
+    if (ret != TOVAL_ERROR::NO_ERROR)
+    {
+        return ret;
+    }
+
     SF_INFO sfinfo = {};
     sfinfo.samplerate = inputWavHeader.SampleRate;  // Use the input sample rate
     sfinfo.channels = Out_num_channels;
@@ -103,7 +153,7 @@ TOVAL_ERROR Tonal_Valley_test::saveWav(const std::string &filename)
 
     if(ret == TOVAL_ERROR::NO_ERROR)
     {
-        sf_write_float(outfile, outputBuffer.data(), outputBuffer.size());
+        sf_write_short(outfile, outputBuffer.data(), outputBuffer.size());
         sf_close(outfile);
     }
 
@@ -140,62 +190,41 @@ TOVAL_ERROR Tonal_Valley_test::prepareAudio()
     }
 
     test_config.sample_rate = inputWavHeader.SampleRate;
+    test_config.internal_sample_rate = internal_sample_rate;
+    test_config.src_quality = src_quality;
 
     std::cout << "Config Sample Rate = " << test_config.sample_rate << std::endl;
-
-
-    // Calculate number of frames (same across input/output)
-    int numFrames = static_cast<int>(inputBuffer.size()) / test_config.In_num_channels;
-
-    std::cout << "Number frames = " << numFrames << std::endl;
-
-    // Resize and deinterleave input buffer
-    deinterleavedInput.resize(test_config.In_num_channels);
-    for (int ch = 0; ch < test_config.In_num_channels; ++ch)
+    if (internal_sample_rate > 0.0f)
     {
-        deinterleavedInput[ch].resize(numFrames);
+        std::cout << "Config Internal Sample Rate = " << test_config.internal_sample_rate << " (quality " << test_config.src_quality << ")" << std::endl;
     }
 
-    ret = deinterleave(inputBuffer, deinterleavedInput, test_config.In_num_channels);
-
+    ret = tonal_valley_test.set_config(sizeof(test_config), &test_config);  // Pass sample rates back to the effect
     if(ret != TOVAL_ERROR::NO_ERROR)
     {
-        std::cout<< "Error in deinterleaving Input: Error code == " << static_cast<int>(ret) << std::endl;
+        std::cout<< "Config Error: Error code == " << static_cast<int>(ret) << std::endl;
         return ret;
     }
 
-    // Resize and zero-init deinterleaved output buffers (allowing upmixing)
-    deinterleavedOutput.resize(test_config.Out_num_channels);
-    for (int ch = 0; ch < test_config.Out_num_channels; ++ch)
-    {
-        deinterleavedOutput[ch].resize(numFrames, 0.0f);
-    }
-
-    // Optional: resize reference buffer (not used here)
-    deinterleavedRef.resize(test_config.Out_num_channels);
-    for (int ch = 0; ch < test_config.Out_num_channels; ++ch)
-    {
-        deinterleavedRef[ch].resize(numFrames, 0.0f);  // Fill if needed
-    }
-
-
-    // Assign float** pointers for module processing
-    ppIn.resize(test_config.In_num_channels);
-    ppOut.resize(test_config.Out_num_channels);
-    ppRef.resize(test_config.Out_num_channels);
 
-    float **pIn = ppIn.data();
-    float **pOut = ppOut.data();
-    float **pRef = ppRef.data();
+    // Calculate number of frames (same across input/output)
+    int numFrames = static_cast<int>(inputView.num_frames());
 
-    for (int ch = 0; ch < test_config.In_num_channels; ++ch)
-        ppIn[ch] = deinterleavedInput[ch].data();
+    std::cout << "Number frames = " << numFrames << std::endl;
 
-    for (int ch = 0; ch < test_config.Out_num_channels; ++ch)
-        ppOut[ch] = deinterleavedOutput[ch].data();
+    // Zeroed output buffers (allowing upmixing)
+    ret = output.audiobuffer_init(test_config.Out_num_channels, numFrames);
 
-    for (int ch = 0; ch < test_config.Out_num_channels; ++ch)
-        ppRef[ch] = deinterleavedRef[ch].data();  // if used
+    // Optional: reference buffer (not used here)
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        ret = reference.audiobuffer_init(test_config.Out_num_channels, numFrames);
+    }
+    if(ret != TOVAL_ERROR::NO_ERROR)
+    {
+        std::cout<< "Error allocating output buffers: Error code == " << static_cast<int>(ret) << std::endl;
+        return ret;
+    }
 
     // Pin/pOut is now assigned
     
@@ -210,10 +239,20 @@ TOVAL_ERROR Tonal_Valley_test::prepareAudio()
         std::cout<< "Init error occured!" << std::endl;
         return ret;
     }
+
+    // No frames x channels threshold, so every block of the test case goes through the workers
+    if (channelWorkers > 0)
+    {
+        ret = tonal_valley_test.TOVAL_Effect_parallel_start(channelWorkers, 0);
+        if (ret != TOVAL_ERROR::NO_ERROR)
+        {
+            std::cout << "Channel workers failed to start: Error code == " << static_cast<int>(ret) << std::endl;
+        }
+    }
     return ret;
 }
 
-TOVAL_ERROR Tonal_Valley_test::deinterleave(const std::vector<float>& interleaved, std::vector<std::vector<float>>& channels, int numChannels)
+TOVAL_ERROR Tonal_Valley_test::deinterleave(const std::vector<float>& interleaved, AudioBuffer& channels, int numChannels)
 {
     TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
     if (numChannels <= 0)
@@ -224,11 +263,10 @@ TOVAL_ERROR Tonal_Valley_test::deinterleave(const std::vector<float>& interleave
     }
 
     int numFrames = static_cast<int>(interleaved.size()) / numChannels;
-    channels.resize(numChannels);
-
-    for (int ch = 0; ch < numChannels; ++ch)
+    ret = channels.audiobuffer_init(static_cast<uint16_t>(numChannels), numFrames);
+    if (ret != TOVAL_ERROR::NO_ERROR)
     {
-        channels[ch].resize(numFrames);
+        return ret;
     }
 
     for (int frame = 0; frame < numFrames; ++frame)
@@ -242,70 +280,209 @@ TOVAL_ERROR Tonal_Valley_test::deinterleave(const std::vector<float>& interleave
 }
 
 
-// Dummy Audio Processing Function (Replace with Real Processing)
-TOVAL_ERROR Tonal_Valley_test::processAudio()
+// Renders input frames [from, to) through effect in chunkSize blocks, keeping the output from keepFrom on.
+// Kept chunks are processed straight from the input buffer into the output buffer, chunks that are
+// (partly) warm up go through a scratch block so they never write over another segment's frames.
+TOVAL_ERROR Tonal_Valley_test::renderRange(TOVAL_Effect& effect, Timeline& automation, size_t from, size_t to, size_t keepFrom)
 {
     TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
 
-    std::cout << "Starting processAudio function..." << std::endl;
-
-    const size_t totalInputFrames = deinterleavedInput[0].size();     // e.g. 1000 frames
-    const size_t totalOutputFrames = deinterleavedOutput[0].size();   // e.g. 1000 frames, or more if upmixing
-    const size_t totalChunks = (totalInputFrames + chunkSize - 1) / chunkSize;
-    
-    std::cout << "Number of input frames = " << totalInputFrames << std::endl;
-    std::cout << "Number of output frames = " << totalInputFrames << std::endl;
-    std::cout << "Total number of Chunks = " << totalChunks << std::endl;
+    AudioBuffer scratch;
+    if (keepFrom > from)
+    {
+        ret = scratch.audiobuffer_init(test_config.Out_num_channels, chunkSize);
+        if (ret != TOVAL_ERROR::NO_ERROR)
+        {
+            return ret;
+        }
+    }
 
-    std::vector<std::vector<float>> inputChunks(test_config.In_num_channels, std::vector<float>(chunkSize));
-    std::vector<std::vector<float>> outputChunks(test_config.Out_num_channels, std::vector<float>(chunkSize));
+    automation.rewind(from);
 
-    for (size_t chunkIndex = 0; chunkIndex < totalChunks; ++chunkIndex)
+    for (size_t chunkStart = from; chunkStart < to; chunkStart += chunkSize)
     {
-        size_t chunkStart = chunkIndex * chunkSize;
-        size_t actualChunkSize = std::min(chunkSize, totalInputFrames - chunkStart);
+        size_t actualChunkSize = std::min(chunkSize, to - chunkStart);
 
-        // Prepare chunk pointers
-        for (int ch = 0; ch < test_config.In_num_channels; ++ch)
-        {
-            std::copy_n(deinterleavedInput[ch].begin() + chunkStart, actualChunkSize, inputChunks[ch].begin());
-            ppIn[ch] = inputChunks[ch].data();
-        }
+        const AudioBlockView in = inputView.slice(chunkStart, actualChunkSize);
+        const bool keepAll = chunkStart >= keepFrom;
+        const AudioBlockView out = keepAll ? output.view().slice(chunkStart, actualChunkSize) : scratch.view().first(actualChunkSize);
 
-        for (int ch = 0; ch < test_config.Out_num_channels; ++ch)
+        // Process
+        size_t numEvents = 0;
+        const TOVAL_ParamEvent* events = automation.next_block(chunkStart, actualChunkSize, numEvents);
+        if (numEvents > 0)
         {
-            std::fill(outputChunks[ch].begin(), outputChunks[ch].end(), 0.0f);  // Optional: zero before processing
-            ppOut[ch] = outputChunks[ch].data();
+            ret = effect.TOVAL_Effect_process_events(in, out, events, numEvents);
         }
-        // Process
-        if(chunkIndex == 0)
+        else
         {
-            std::cout << "Starting TOVAL Process call..." << std::endl;
+            ret = effect.TOVAL_Effect_process(in, out);
         }
-        ret = tonal_valley_test.TOVAL_Effect_process(ppIn.data(), ppOut.data(), static_cast<int>(actualChunkSize));
         if (ret != TOVAL_ERROR::NO_ERROR)
         {
-            std::cerr << "Processing failed on chunk " << chunkIndex << std::endl;
+            std::cerr << "Processing failed on chunk starting at frame " << chunkStart << std::endl;
             return ret;
         }
-        // Copy output
-        for (int ch = 0; ch < test_config.Out_num_channels; ++ch)
+
+        // Copy out the kept part of a warm up chunk
+        if (!keepAll)
         {
-            std::copy_n(outputChunks[ch].begin(), actualChunkSize, deinterleavedOutput[ch].begin() + chunkStart);
+            const size_t skip = std::min(keepFrom - chunkStart, actualChunkSize);
+            for (int ch = 0; ch < test_config.Out_num_channels; ++ch)
+            {
+                std::copy(out.channel(ch) + skip, out.channel(ch) + actualChunkSize, output.channel(ch) + chunkStart + skip);
+            }
         }
     }
-    
-    std::cout << "TOVAL process complete"<< std::endl;
 
-    // Interleave output
-    outputBuffer.resize(totalOutputFrames * test_config.Out_num_channels);
-    for (size_t frame = 0; frame < totalOutputFrames; ++frame)
+    return ret;
+}
+
+// Fresh instance with the test case's config, static params and the automation state it starts from
+TOVAL_ERROR Tonal_Valley_test::createSegmentEffect(TOVAL_Effect& effect, const std::vector<TOVAL_ParamSet>& state)
+{
+    TOVAL_ERROR ret = effect.set_config(sizeof(test_config), &test_config);
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        ret = effect.TOVAL_Effect_init();
+    }
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        ret = effect.TOVAL_Effect_set_batch(staticParams.data(), staticParams.size());
+    }
+    if (ret == TOVAL_ERROR::NO_ERROR)
+    {
+        ret = effect.TOVAL_Effect_set_batch(state.data(), state.size());
+    }
+    return ret;
+}
+
+/*
+    Splits the file into one segment per thread, each rendered by its own TOVAL_Effect. A segment starts
+    rendering GLOBAL_SETTLING_TIME frames early so its filter and delay state has converged by the time
+    its own frames come out, then only those frames are kept. The settling time is the worst case over
+    the static settings and every automation point.
+*/
+TOVAL_ERROR Tonal_Valley_test::processAudioParallel(size_t threads)
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+    const size_t totalFrames = inputView.num_frames();
+
+    // Settling is worked out from published values, so a probe instance never has to process anything
+    uint32_t warmup = 0;
     {
-        for (int ch = 0; ch < test_config.Out_num_channels; ++ch)
+        TOVAL_Effect probe;
+        ret = createSegmentEffect(probe, {});
+        for (size_t e = 0; e <= timeline.size() && ret == TOVAL_ERROR::NO_ERROR; e++)
         {
-            outputBuffer[frame * test_config.Out_num_channels + ch] = deinterleavedOutput[ch][frame];
+            if (e > 0)
+            {
+                TOVAL_ParamEvent event = timeline.data()[e - 1];
+                ret = probe.TOVAL_Effect_set(event.moduleID, event.paramID, sizeof(event.value), &event.value);
+            }
+            uint32_t settle = 0;
+            if (ret == TOVAL_ERROR::NO_ERROR)
+            {
+                ret = probe.TOVAL_Effect_get(GLOBAL, GLOBAL_SETTLING_TIME, sizeof(settle), &settle);
+            }
+            warmup = std::max(warmup, settle);
         }
     }
+    if (ret != TOVAL_ERROR::NO_ERROR)
+    {
+        return ret;
+    }
+
+    if (warmup == TOVAL_SETTLE_NEVER)
+    {
+        std::cout << "Effect state never settles for these settings, rendering serially" << std::endl;
+        return renderRange(tonal_valley_test, timeline, 0, totalFrames, 0);
+    }
+
+    // A converter only repeats its phase pattern every 'align' input frames, pre-roll starts on that grid
+    size_t align = 1;
+    if (test_config.internal_sample_rate > 0.0f && test_config.internal_sample_rate != test_config.sample_rate)
+    {
+        const size_t host = static_cast<size_t>(test_config.sample_rate);
+        align = host / std::gcd(host, static_cast<size_t>(test_config.internal_sample_rate));
+    }
+
+    const size_t segmentLength = (totalFrames + threads - 1) / threads;
+    std::cout << "Parallel render: " << threads << " segments of " << segmentLength << " frames, " << warmup << " frames warm up" << std::endl;
+
+    std::vector<std::thread> workers;
+    std::vector<TOVAL_ERROR> results(threads, TOVAL_ERROR::NO_ERROR);
+
+    for (size_t s = 0; s < threads; s++)
+    {
+        const size_t start = s * segmentLength;
+        const size_t end = std::min(totalFrames, start + segmentLength);
+        if (start >= end)
+        {
+            break;
+        }
+        const size_t warmStart = ((start > warmup) ? start - warmup : 0) / align * align;
+
+        workers.emplace_back([this, s, start, end, warmStart, &results]() {
+            std::vector<TOVAL_ParamSet> state;
+            timeline.state_at(warmStart, state);
+            Timeline automation = timeline;     // own replay cursor
+
+            TOVAL_Effect effect;
+            results[s] = createSegmentEffect(effect, state);
+            if (results[s] == TOVAL_ERROR::NO_ERROR)
+            {
+                results[s] = renderRange(effect, automation, warmStart, end, start);
+            }
+        });
+    }
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    for (TOVAL_ERROR result : results)
+    {
+        if (result != TOVAL_ERROR::NO_ERROR)
+        {
+            ret = result;
+        }
+    }
+    return ret;
+}
+
+TOVAL_ERROR Tonal_Valley_test::processAudio()
+{
+    TOVAL_ERROR ret = TOVAL_ERROR::NO_ERROR;
+
+    std::cout << "Starting processAudio function..." << std::endl;
+
+    const size_t totalInputFrames = inputView.num_frames();       // e.g. 1000 frames
+    const size_t totalOutputFrames = output.num_frames();     // e.g. 1000 frames, or more if upmixing
+    const size_t totalChunks = (totalInputFrames + chunkSize - 1) / chunkSize;
+    
+    std::cout << "Number of input frames = " << totalInputFrames << std::endl;
+    std::cout << "Number of output frames = " << totalOutputFrames << std::endl;
+    std::cout << "Total number of Chunks = " << totalChunks << std::endl;
+
+    const size_t threads = (renderThreads == 0) ? std::max(1u, std::thread::hardware_concurrency()) : renderThreads;
+
+    std::cout << "Starting TOVAL Process call..." << std::endl;
+    if (threads > 1)
+    {
+        ret = processAudioParallel(threads);
+    }
+    else
+    {
+        ret = renderRange(tonal_valley_test, timeline, 0, totalInputFrames, 0);
+    }
+    if (ret != TOVAL_ERROR::NO_ERROR)
+    {
+        return ret;
+    }
+    
+    std::cout << "TOVAL process complete"<< std::endl;
 
     return TOVAL_ERROR::NO_ERROR;
 
@@ -319,21 +496,34 @@ int main(int argc, char *argv[])
     // Instantiate the test unit
     Tonal_Valley_test unit_test;
 
-    if (argc < 2)
+    if (argc < 3)
     {
-        std::cerr << "Usage: " << argv[0] << " <test_case_directory>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <test_case_directory> <output_directory> [render_threads]" << std::endl;
         return 1;
     }
 
     // Get test case directory (example: "../test/test_cases/02_default")
     std::string testCaseDir = argv[1];
     std::string outputDir = argv[2];
+    const char* threadsArg = (argc > 3) ? argv[3] : nullptr;     // optional segment count, overrides params.json
 
 
     // Extract a friendly test case name from the directory path
     std::string testCaseName = std::filesystem::path(testCaseDir).filename().string();
     std::cout << "Initiating test case " << testCaseName << "...\n" << std::endl;
 
+    // Decoded inputs are shared by every case written next to this one, TOVAL_INPUT_CACHE moves them ("" turns them off)
+    const char* cacheEnv = std::getenv("TOVAL_INPUT_CACHE");
+    if (cacheEnv != nullptr)
+    {
+        unit_test.inputCacheDir = cacheEnv;
+    }
+    else
+    {
+        const fs::path outputParent = fs::path(outputDir).parent_path();
+        unit_test.inputCacheDir = ((outputParent.empty() ? fs::path(outputDir) : outputParent) / "input_cache").string();
+    }
+
     std::string inputWavPath;
 
     // Find the first WAV file in the test case directory
@@ -362,20 +552,12 @@ int main(int argc, char *argv[])
     // Print header information for verification
     unit_test.printWavHeader(unit_test.inputWavHeader);  // Print header before processing
 
-    // Prepare audio (which may verify configuration etc.)
-    ret = unit_test.prepareAudio();
-    if (ret != TOVAL_ERROR::NO_ERROR)
-    {
-        std::cout << "Error in Prepare audio function. Error code: " << static_cast<int>(ret) << std::endl;
-        return 1;
-    }
-    else{
-        std::cout << "PrepareAudio complete" << std::endl;
-    }
-
-    // *** NEW: Load the JSON parameters from the test case directory ***
+    // Parse the test case parameters up front, the CONFIG section is needed by prepareAudio
     std::string paramsFile = testCaseDir + "/params.json";
-    if (fs::exists(paramsFile))
+    nlohmann::json jsonParams;
+    std::string jsonText;
+    bool haveParams = fs::exists(paramsFile);
+    if (haveParams)
     {
         std::ifstream jsonFile(paramsFile);
         if (!jsonFile.is_open())
@@ -383,16 +565,46 @@ int main(int argc, char *argv[])
             std::cerr << "Error: Unable to open JSON file: " << paramsFile << std::endl;
             return 1;
         }
-        nlohmann::json jsonParams;
+        jsonText.assign(std::istreambuf_iterator<char>(jsonFile), std::istreambuf_iterator<char>());   // kept as the timeline cache key
         try {
-            jsonFile >> jsonParams;
+            jsonParams = nlohmann::json::parse(jsonText);
         } catch (const std::exception& e) {
             std::cerr << "Error parsing JSON: " << e.what() << std::endl;
             return 1;
         }
-        
+
+        if (jsonParams.contains("CONFIG"))
+        {
+            const nlohmann::json& config = jsonParams["CONFIG"];
+            unit_test.internal_sample_rate = config.value("INTERNAL_SAMPLE_RATE", 0.0f);
+            unit_test.src_quality = config.value("SRC_QUALITY", static_cast<uint16_t>(SRC_QUALITY_MEDIUM));
+            unit_test.renderThreads = config.value("RENDER_THREADS", static_cast<size_t>(1));
+            unit_test.outputDither = static_cast<TOVAL_Dither>(config.value("OUTPUT_DITHER", static_cast<uint32_t>(DITHER_NONE)));
+            unit_test.channelWorkers = config.value("CHANNEL_WORKERS", static_cast<size_t>(0));
+        }
+    }
+
+    if (threadsArg != nullptr)
+    {
+        unit_test.renderThreads = std::stoul(threadsArg);
+    }
+
+    // Prepare audio (which may verify configuration etc.)
+    ret = unit_test.prepareAudio();
+    if (ret != TOVAL_ERROR::NO_ERROR)
+    {
+        std::cout << "Error in Prepare audio function. Error code: " << static_cast<int>(ret) << std::endl;
+        return 1;
+    }
+    else{
+        std::cout << "PrepareAudio complete" << std::endl;
+    }
+
+    // *** NEW: Load the JSON parameters from the test case directory ***
+    if (haveParams)
+    {
         // Apply parameters to the effect instance using the provided generic JSON loader.
-        ret = load_and_set_json_params(jsonParams, unit_test.tonal_valley_test);
+        ret = load_and_set_json_params(jsonParams, unit_test.tonal_valley_test, &unit_test.staticParams);
         if (ret != TOVAL_ERROR::NO_ERROR)
         {
             std::cerr << "Error applying JSON parameters (code " << static_cast<int>(ret) << ")" << std::endl;
@@ -401,6 +613,14 @@ int main(int argc, char *argv[])
         else {
             std::cout << "JSON parameters loaded successfully." << std::endl;
         }
+
+        // Automation is compiled before the render so processAudio only replays events
+        ret = unit_test.timeline.load(jsonParams, jsonText, static_cast<float>(unit_test.inputWavHeader.SampleRate), outputDir + "/timeline.bin");
+        if (ret != TOVAL_ERROR::NO_ERROR)
+        {
+            std::cerr << "Error compiling TIMELINE (code " << static_cast<int>(ret) << ")" << std::endl;
+            return 1;
+        }
     }
     else
     {
@@ -428,5 +648,14 @@ int main(int argc, char *argv[])
     }
 
     std::cout << "Processing complete. Output saved to: " << outputWavPath << std::endl;
+
+#ifdef TOVAL_ENABLE_TRACE
+    std::string tracePath = outputDir + "/trace.json";
+    if (TOVAL_trace_write_chrome_json(tracePath.c_str()))
+    {
+        std::cout << "Trace saved to: " << tracePath << " (open in Perfetto or chrome://tracing)" << std::endl;
+    }
+#endif
+
     return 0;
 }
\ No newline at end of file